@@ -26,9 +26,11 @@ limitations under the License.
 #include "backends/bmv2/psa_switch/version.h"
 #include "control-plane/p4RuntimeSerializer.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compilationCache.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/frontend.h"
 #include "fstream"
+#include "ir/binary_writer.h"
 #include "ir/ir.h"
 #include "ir/json_loader.h"
 #include "lib/error.h"
@@ -60,7 +62,9 @@ int main(int argc, char *const argv[]) {
     const IR::P4Program *program = nullptr;
     const IR::ToplevelBlock *toplevel = nullptr;
 
+    CompilationCache cache(options, {options.outputFile});
     if (options.loadIRFromJson == false) {
+        if (cache.restore()) return ::P4::errorCount() > 0;
         program = P4::parseP4File(options);
 
         if (program == nullptr || ::P4::errorCount() > 0) return 1;
@@ -103,6 +107,8 @@ int main(int argc, char *const argv[]) {
             return 1;
         if (!options.dumpJsonFile.empty())
             JSONGenerator(*openFile(options.dumpJsonFile, true), true).emit(program);
+        if (!options.dumpBinaryFile.empty())
+            BinaryWriter(*openFile(options.dumpBinaryFile, true), true).emit(program);
     } catch (const std::exception &bug) {
         std::cerr << bug.what() << std::endl;
         return 1;
@@ -130,5 +136,6 @@ int main(int argc, char *const argv[]) {
         }
     }
 
+    cache.store();
     return ::P4::errorCount() > 0;
 }
@@ -26,8 +26,10 @@ limitations under the License.
 #include "backends/bmv2/simple_switch/version.h"
 #include "control-plane/p4RuntimeSerializer.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compilationCache.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/frontend.h"
+#include "ir/binary_writer.h"
 #include "ir/ir.h"
 #include "ir/json_generator.h"
 #include "ir/json_loader.h"
@@ -63,7 +65,9 @@ int main(int argc, char *const argv[]) {
     const IR::P4Program *program = nullptr;
     const IR::ToplevelBlock *toplevel = nullptr;
 
+    CompilationCache cache(options, {options.outputFile});
     if (options.loadIRFromJson == false) {
+        if (cache.restore()) return ::P4::errorCount() > 0;
         program = P4::parseP4File(options);
 
         if (program == nullptr || ::P4::errorCount() > 0) return 1;
@@ -106,6 +110,8 @@ int main(int argc, char *const argv[]) {
             return 1;
         if (!options.dumpJsonFile.empty() && !options.loadIRFromJson)
             JSONGenerator(*openFile(options.dumpJsonFile, true), true).emit(program);
+        if (!options.dumpBinaryFile.empty() && !options.loadIRFromJson)
+            BinaryWriter(*openFile(options.dumpBinaryFile, true), true).emit(program);
     } catch (const std::exception &bug) {
         std::cerr << bug.what() << std::endl;
         return 1;
@@ -133,5 +139,6 @@ int main(int argc, char *const argv[]) {
         }
     }
 
+    cache.store();
     return ::P4::errorCount() > 0;
 }
@@ -131,7 +131,9 @@ SimpleSwitchMidEnd::SimpleSwitchMidEnd(CompilerOptions &options, std::ostream *o
              // control plane API, we remove them as well for P4-14 programs.
              {isv1 ? new P4::RemoveUnusedActionParameters(&refMap) : nullptr},
              new P4::TypeChecking(&refMap, &typeMap),
-             {options.loopsUnrolling ? new P4::ParsersUnroll(true, &refMap, &typeMap) : nullptr},
+             {options.loopsUnrolling
+                  ? new P4::ParsersUnroll(true, &refMap, &typeMap, options.parserUnrollBudget)
+                  : nullptr},
              evaluator,
              [this, evaluator]() { toplevel = evaluator->getToplevelBlock(); },
              new P4::MidEndLast()});
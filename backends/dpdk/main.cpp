@@ -28,6 +28,7 @@ limitations under the License.
 #include "control-plane/bfruntime_ext.h"
 #include "control-plane/p4RuntimeSerializer.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compilationCache.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/common/parser_options.h"
 #include "frontends/p4/frontend.h"
@@ -80,7 +81,10 @@ int main(int argc, char *const argv[]) {
     const IR::P4Program *program = nullptr;
     const IR::ToplevelBlock *toplevel = nullptr;
 
+    CompilationCache cache(options, {options.outputFile, options.bfRtSchema, options.tdiFile,
+                                     options.ctxtFile, options.tdiBuilderConf});
     if (options.loadIRFromJson == false) {
+        if (cache.restore()) return ::P4::errorCount() > 0;
         program = P4::parseP4File(options);
 
         if (program == nullptr || ::P4::errorCount() > 0) return 1;
@@ -155,5 +159,6 @@ int main(int argc, char *const argv[]) {
         }
     }
 
+    cache.store();
     return ::P4::errorCount() > 0;
 }
@@ -108,7 +108,7 @@ const IR::ToplevelBlock *MidEnd::run(EbpfOptions &options, const IR::P4Program *
              new P4::TableHit(&typeMap),
              new P4::RemoveLeftSlices(&typeMap),
              new EBPF::Lower(&refMap, &typeMap),
-             new P4::ParsersUnroll(true, &refMap, &typeMap),
+             new P4::ParsersUnroll(true, &refMap, &typeMap, options.parserUnrollBudget),
              evaluator,
              new P4::MidEndLast()});
 
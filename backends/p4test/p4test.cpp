@@ -26,6 +26,8 @@ limitations under the License.
 #include "frontends/p4/evaluator/evaluator.h"
 #include "frontends/p4/frontend.h"
 #include "frontends/p4/toP4/toP4.h"
+#include "ir/binary_reader.h"
+#include "ir/binary_writer.h"
 #include "ir/ir.h"
 #include "ir/json_loader.h"
 #include "ir/pass_utils.h"
@@ -70,6 +72,14 @@ P4TestOptions::P4TestOptions() {
             return true;
         },
         "read previously dumped json instead of P4 source code");
+    registerOption(
+        "--fromBinary", "file",
+        [this](const char *arg) {
+            loadIRFromBinary = true;
+            file = arg;
+            return true;
+        },
+        "read a previously dumped binary IR file instead of P4 source code");
     registerOption(
         "--turn-off-logn", nullptr,
         [](const char *) {
@@ -147,7 +157,7 @@ int main(int argc, char *const argv[]) {
     options.compilerVersion = cstring(P4TEST_VERSION_STRING);
 
     if (options.process(argc, argv) != nullptr) {
-        if (options.loadIRFromJson == false) options.setInputFile();
+        if (!options.loadIRFromJson && !options.loadIRFromBinary) options.setInputFile();
     }
     if (::P4::errorCount() > 0) return 1;
     const IR::P4Program *program = nullptr;
@@ -163,6 +173,18 @@ int main(int argc, char *const argv[]) {
         } else {
             error(ErrorType::ERR_IO, "Can't open %s", options.file);
         }
+    } else if (options.loadIRFromBinary) {
+        std::ifstream binary(options.file, std::ios::binary);
+        if (binary) {
+            BinaryReader reader(binary);
+            const IR::Node *node = nullptr;
+            reader >> node;
+            if (!node || !(program = node->to<IR::P4Program>()))
+                error(ErrorType::ERR_INVALID, "%s is not a P4Program in binary IR format",
+                      options.file);
+        } else {
+            error(ErrorType::ERR_IO, "Can't open %s", options.file);
+        }
     } else {
         P4::DiagnosticCountInfo info;
         program = P4::parseP4File(options);
@@ -221,6 +243,8 @@ int main(int argc, char *const argv[]) {
         if (program) {
             if (!options.dumpJsonFile.empty())
                 JSONGenerator(*openFile(options.dumpJsonFile, true), true).emit(program);
+            if (!options.dumpBinaryFile.empty())
+                BinaryWriter(*openFile(options.dumpBinaryFile, true), true).emit(program);
             if (options.debugJson) {
                 std::stringstream ss1, ss2;
                 JSONGenerator gen1(ss1), gen2(ss2);
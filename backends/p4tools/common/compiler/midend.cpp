@@ -40,7 +40,7 @@
 
 namespace P4::P4Tools {
 
-MidEnd::MidEnd(const CompilerOptions &options) {
+MidEnd::MidEnd(const CompilerOptions &options) : parserUnrollBudget(options.parserUnrollBudget) {
     setName("MidEnd");
     refMap.setIsV1(options.langVersion == CompilerOptions::FrontendVersion::P4_16);
 }
@@ -149,7 +149,7 @@ void MidEnd::addDefaultPasses() {
         // Replace any slices in the left side of assignments and convert them to casts.
         new P4::RemoveLeftSlices(&typeMap),
         // Remove loops from parsers by unrolling them as far as the stack indices allow.
-        new P4::ParsersUnroll(true, &refMap, &typeMap),
+        new P4::ParsersUnroll(true, &refMap, &typeMap, parserUnrollBudget),
         new P4::TypeChecking(&refMap, &typeMap, true),
         mkConvertErrors(),
         // Convert tuples into structs.
@@ -26,6 +26,10 @@ class MidEnd : public PassManager {
     P4::ReferenceMap refMap;
     P4::TypeMap typeMap;
 
+    /// The number of parser states ParsersUnroll may evaluate per parser, from
+    /// --parser-unroll-budget. 0 means no limit.
+    size_t parserUnrollBudget;
+
     /// Provides a target-specific pass that converts P4 enums to bit<n>. The default
     /// implementation returns P4::ConvertEnums, instantiated with the policy provided by
     /// @mkChooseEnumRepresentation.
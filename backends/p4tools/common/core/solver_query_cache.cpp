@@ -0,0 +1,408 @@
+#include "backends/p4tools/common/core/solver_query_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <utility>
+
+#include "frontends/p4/optimizeExpressions.h"
+#include "ir/ir.h"
+#include "ir/irutils.h"
+#include "ir/visitor.h"
+#include "lib/exceptions.h"
+#include "lib/timer.h"
+
+namespace P4::P4Tools {
+
+namespace {
+
+/// The statistics of all caches. Caches may be used by several threads at once.
+struct AtomicStatistics {
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> components{0};
+    std::atomic<uint64_t> exactHits{0};
+    std::atomic<uint64_t> unsatHits{0};
+    std::atomic<uint64_t> modelHits{0};
+    std::atomic<uint64_t> solverCalls{0};
+    std::atomic<uint64_t> constraints{0};
+    std::atomic<uint64_t> solvedConstraints{0};
+} statistics;
+
+/// Replaces the variables of a constraint with their value in a model. Variables that the model
+/// does not bind are replaced with their default value.
+class ModelSubstitution : public Transform {
+    const SymbolicMapping &model;
+
+ public:
+    /// Set if the constraint contains an operation that can not be folded the way the solver
+    /// evaluates it.
+    bool unsupported = false;
+
+    explicit ModelSubstitution(const SymbolicMapping &model) : model(model) {}
+
+    const IR::Node *preorder(IR::SymbolicVariable *var) override {
+        prune();
+        auto it = model.find(var);
+        if (it != model.end()) {
+            return it->second;
+        }
+        if (!var->type->is<IR::Type_Bits>() && !var->type->is<IR::Type_Boolean>()) {
+            unsupported = true;
+            return var;
+        }
+        return IR::getDefaultValue(var->type, var->srcInfo, true);
+    }
+
+    // Division by zero and shifts by a negative amount are defined in the solver, but are errors
+    // when folding constants.
+    const IR::Node *preorder(IR::Div *op) override { return stop(op); }
+    const IR::Node *preorder(IR::Mod *op) override { return stop(op); }
+    const IR::Node *preorder(IR::Shl *op) override { return stop(op); }
+    const IR::Node *preorder(IR::Shr *op) override { return stop(op); }
+
+ private:
+    const IR::Node *stop(const IR::Node *node) {
+        unsupported = true;
+        prune();
+        return node;
+    }
+};
+
+/// Collects the variables of a constraint.
+class CollectVariables : public Inspector {
+    std::vector<const IR::SymbolicVariable *> &variables;
+
+ public:
+    explicit CollectVariables(std::vector<const IR::SymbolicVariable *> &variables)
+        : variables(variables) {}
+
+    bool preorder(const IR::SymbolicVariable *var) override {
+        variables.push_back(var);
+        return false;
+    }
+};
+
+}  // namespace
+
+SolverQueryCache::SolverQueryCache(bool slice, SolverFactory makeSolver)
+    : slice(slice), makeSolver(std::move(makeSolver)) {}
+
+std::optional<bool> SolverQueryCache::checkSat(AbstractSolver &solver,
+                                               const std::vector<const Constraint *> &asserts) {
+    ++statistics.queries;
+    statistics.constraints += asserts.size();
+    querySolver = &solver;
+    lastComponents.clear();
+    lastModel = nullptr;
+    lastSatisfiable = false;
+    std::vector<bool> answered;
+    {
+        Util::ScopedTimer ctCache("solver_query_cache");
+        std::vector<std::vector<const Constraint *>> components;
+        if (slice) {
+            components = split(asserts);
+        } else {
+            components.push_back(asserts);
+        }
+        statistics.components += components.size();
+        for (auto &constraints : components) {
+            Query query(constraints.begin(), constraints.end());
+            std::sort(query.begin(), query.end());
+            query.erase(std::unique(query.begin(), query.end()), query.end());
+            auto result = lookup(query);
+            // The query is unsatisfiable if any of its components is.
+            if (result.has_value() && !result->satisfiable) {
+                lastComponents.clear();
+                return false;
+            }
+            answered.push_back(result.has_value());
+            lastComponents.push_back(
+                {std::move(constraints), std::move(query), result ? result->model : nullptr});
+        }
+    }
+
+    // Only hand the components that were not answered by the cache to the solver.
+    for (size_t i = 0; i < lastComponents.size(); ++i) {
+        if (answered[i]) {
+            continue;
+        }
+        auto result = solve(lastComponents[i]);
+        if (!result.has_value() || !result.value()) {
+            lastComponents.clear();
+            return result;
+        }
+    }
+    lastSatisfiable = true;
+    return true;
+}
+
+const std::vector<const IR::SymbolicVariable *> &SolverQueryCache::getVariables(
+    const Constraint *constraint) {
+    auto [it, inserted] = variables.try_emplace(constraint);
+    if (inserted) {
+        constraint->apply(CollectVariables(it->second));
+        variablesOrder.push_back(constraint);
+        if (variablesOrder.size() > MAX_VARIABLE_SETS) {
+            variables.erase(variablesOrder.front());
+            variablesOrder.pop_front();
+        }
+    }
+    return it->second;
+}
+
+std::vector<std::vector<const Constraint *>> SolverQueryCache::split(
+    const std::vector<const Constraint *> &asserts) {
+    // Union-find over the constraints: two constraints are in the same set if they share a
+    // variable. Variables are compared by label, as the solver does.
+    std::vector<size_t> parent(asserts.size());
+    for (size_t i = 0; i < parent.size(); ++i) {
+        parent[i] = i;
+    }
+    auto find = [&parent](size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    std::map<const IR::SymbolicVariable *, size_t, IR::SymbolicVariableLess> owners;
+    for (size_t i = 0; i < asserts.size(); ++i) {
+        for (const auto *var : getVariables(asserts[i])) {
+            auto [it, inserted] = owners.emplace(var, i);
+            if (!inserted) {
+                parent[find(i)] = find(it->second);
+            }
+        }
+    }
+
+    std::vector<std::vector<const Constraint *>> components;
+    std::vector<size_t> componentOf(asserts.size(), asserts.size());
+    for (size_t i = 0; i < asserts.size(); ++i) {
+        auto root = find(i);
+        if (componentOf[root] == asserts.size()) {
+            componentOf[root] = components.size();
+            components.emplace_back();
+        }
+        components[componentOf[root]].push_back(asserts[i]);
+    }
+    return components;
+}
+
+SolverQueryCache::SolverSlot &SolverQueryCache::solverFor(const Component &component) {
+    if (!slice || !makeSolver) {
+        // Everything goes to the solver of the query.
+        if (solvers.empty()) {
+            solvers.emplace_back();
+        }
+        auto &slot = solvers.front();
+        if (slot.solver != querySolver) {
+            slot.solver = querySolver;
+            slot.pending.reset();
+        }
+        return slot;
+    }
+    const auto *lineage = component.constraints.front();
+    SolverSlot *chosen = nullptr;
+    for (auto &slot : solvers) {
+        if (slot.lineage == lineage) {
+            chosen = &slot;
+            break;
+        }
+    }
+    if (chosen == nullptr && solvers.size() < MAX_SOLVERS) {
+        ownedSolvers.push_back(makeSolver());
+        chosen = &solvers.emplace_back();
+        chosen->solver = ownedSolvers.back().get();
+    }
+    if (chosen == nullptr) {
+        chosen = &*std::min_element(solvers.begin(), solvers.end(),
+                                    [](const SolverSlot &a, const SolverSlot &b) {
+                                        return a.lastUse < b.lastUse;
+                                    });
+    }
+    chosen->lineage = lineage;
+    chosen->lastUse = ++solverUses;
+    return *chosen;
+}
+
+SolverQueryCache::SolverSlot *SolverQueryCache::holderOf(ResultMap::iterator result) {
+    for (auto &slot : solvers) {
+        if (slot.pending.has_value() && *slot.pending == result) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+std::optional<bool> SolverQueryCache::solve(const Component &component) {
+    ++statistics.solverCalls;
+    statistics.solvedConstraints += component.constraints.size();
+    auto &slot = solverFor(component);
+    // The solver no longer holds the model of its pending result after this call.
+    slot.pending.reset();
+    auto result = slot.solver->checkSat(component.constraints);
+    // Do not remember timeouts; a later query may succeed.
+    if (result == std::nullopt) {
+        return std::nullopt;
+    }
+    auto it = insert(component.query, {result.value(), nullptr});
+    if (result.value()) {
+        slot.pending = it;
+    }
+    return result;
+}
+
+const SymbolicMapping *SolverQueryCache::fetchPending(SolverSlot &slot) {
+    auto &result = (*slot.pending)->second;
+    if (result.model == nullptr) {
+        result.model = &slot.solver->getSymbolicMapping();
+    }
+    return result.model;
+}
+
+std::optional<SolverQueryCache::Result> SolverQueryCache::lookup(const Query &query) {
+    auto exact = results.find(query);
+    if (exact != results.end()) {
+        ++statistics.exactHits;
+        return exact->second;
+    }
+
+    size_t candidates = 0;
+    for (auto it = history.rbegin(); it != history.rend() && candidates < MAX_CANDIDATES;
+         ++it, ++candidates) {
+        const auto &[solved, result] = **it;
+        if (!result.satisfiable) {
+            // A query that contains an unsatisfiable set of constraints is unsatisfiable.
+            if (std::includes(query.begin(), query.end(), solved.begin(), solved.end())) {
+                ++statistics.unsatHits;
+                return result;
+            }
+            continue;
+        }
+        // Of the models that were not fetched, only those that a solver still holds can be.
+        auto *holder = result.model == nullptr ? holderOf(*it) : nullptr;
+        if (result.model == nullptr && holder == nullptr) {
+            continue;
+        }
+        const auto *model = result.model != nullptr ? result.model : fetchPending(*holder);
+        if (satisfies(*model, query, solved)) {
+            ++statistics.modelHits;
+            Result hit{true, model};
+            // Remember the query, so that it is found again without evaluating the model.
+            insert(query, hit);
+            return hit;
+        }
+    }
+    return std::nullopt;
+}
+
+SolverQueryCache::ResultMap::iterator SolverQueryCache::insert(const Query &query,
+                                                               Result result) {
+    auto [it, inserted] = results.emplace(query, result);
+    if (!inserted) {
+        return it;
+    }
+    history.push_back(it);
+    if (history.size() > MAX_RESULTS) {
+        if (auto *holder = holderOf(history.front())) {
+            holder->pending.reset();
+        }
+        results.erase(history.front());
+        history.pop_front();
+    }
+    return it;
+}
+
+bool SolverQueryCache::satisfies(const SymbolicMapping &model, const Query &query,
+                                 const Query &solved) {
+    Query unsolved;
+    std::set_difference(query.begin(), query.end(), solved.begin(), solved.end(),
+                        std::back_inserter(unsolved));
+    for (const auto *constraint : unsolved) {
+        ModelSubstitution substitution(model);
+        const auto *substituted = constraint->apply(substitution);
+        if (substitution.unsupported) {
+            return false;
+        }
+        const auto *value = P4::optimizeExpression(substituted)->to<IR::BoolLiteral>();
+        if (value == nullptr || !value->value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const SymbolicMapping &SolverQueryCache::getModel(Component &component) {
+    if (component.model != nullptr) {
+        return *component.model;
+    }
+    auto it = results.find(component.query);
+    auto *holder = it != results.end() ? holderOf(it) : nullptr;
+    if (it != results.end() && it->second.model != nullptr) {
+        component.model = it->second.model;
+    } else if (holder != nullptr) {
+        component.model = fetchPending(*holder);
+    } else {
+        // The solver has moved on to other components since this one was answered.
+        auto result = solve(component);
+        BUG_CHECK(result == std::optional<bool>(true),
+                  "A satisfiable query is no longer satisfiable.");
+        component.model = fetchPending(*holderOf(results.find(component.query)));
+    }
+    return *component.model;
+}
+
+const SymbolicMapping &SolverQueryCache::getSymbolicMapping() {
+    if (lastModel != nullptr) {
+        return *lastModel;
+    }
+    BUG_CHECK(lastSatisfiable, "The last query to the solver query cache has no model.");
+    // Fetch the models the solvers hold first, as getting the others may need the solvers.
+    for (auto &component : lastComponents) {
+        if (component.model != nullptr) {
+            continue;
+        }
+        auto it = results.find(component.query);
+        if (it == results.end()) {
+            continue;
+        }
+        if (auto *holder = holderOf(it)) {
+            component.model = fetchPending(*holder);
+        }
+    }
+    if (lastComponents.size() == 1) {
+        lastModel = &getModel(lastComponents.front());
+        return *lastModel;
+    }
+    // The components have no variables in common, but the model of a component may come from a
+    // query with more variables. Only keep the values of the variables of each component.
+    auto *model = new SymbolicMapping();
+    for (auto &component : lastComponents) {
+        const auto &componentModel = getModel(component);
+        for (const auto *constraint : component.query) {
+            for (const auto *var : getVariables(constraint)) {
+                auto it = componentModel.find(var);
+                if (it != componentModel.end()) {
+                    model->emplace(it->first, it->second);
+                }
+            }
+        }
+    }
+    lastModel = model;
+    return *lastModel;
+}
+
+SolverQueryCache::Statistics SolverQueryCache::getStatistics() {
+    Statistics result;
+    result.queries = statistics.queries;
+    result.components = statistics.components;
+    result.exactHits = statistics.exactHits;
+    result.unsatHits = statistics.unsatHits;
+    result.modelHits = statistics.modelHits;
+    result.solverCalls = statistics.solverCalls;
+    result.constraints = statistics.constraints;
+    result.solvedConstraints = statistics.solvedConstraints;
+    return result;
+}
+
+}  // namespace P4::P4Tools
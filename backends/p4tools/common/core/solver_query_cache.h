@@ -0,0 +1,238 @@
+#ifndef BACKENDS_P4TOOLS_COMMON_CORE_SOLVER_QUERY_CACHE_H_
+#define BACKENDS_P4TOOLS_COMMON_CORE_SOLVER_QUERY_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "ir/ir.h"
+#include "ir/solver.h"
+
+namespace P4::P4Tools {
+
+/// Remembers the results of earlier satisfiability queries, so that a query whose result follows
+/// from them is answered without calling the solver. A query is the set of its constraints: their
+/// order and duplicates do not matter. Constraints are compared by identity, which is enough
+/// because the execution states that branch from one another share the constraints of their
+/// common prefix.
+///
+/// If slicing is enabled, a query is first split into independent components: constraints that
+/// share a variable, directly or through other constraints, are in the same component. A query is
+/// satisfiable if all its components are, and each component is looked up and solved on its own,
+/// so that a branch condition only needs the constraints on the variables it depends on to be
+/// sent to the solver.
+///
+/// A component (or a query, without slicing) is answered from the cache if
+///   - the same set of constraints was checked before;
+///   - it contains all the constraints of a set that was unsatisfiable; or
+///   - a recent model satisfies it. Only the constraints that the model was not computed for are
+///     evaluated, with the variables the model does not bind set to their default value, as
+///     Model does when completing a model.
+///
+/// An incremental solver only keeps the constraints that a new query shares with the previous one
+/// it checked, so handing it the components of a query in turn would drop and assert again almost
+/// everything for each of them. With a solver factory, the cache hands the components to solvers
+/// of its own instead, one for each line of components with the same first constraint: the
+/// components of the path constraints of a state and of the states that branch from it. Without
+/// one, all components go to the solver of the query.
+///
+/// The model of a satisfiable component is only fetched from the solver when it is needed: when
+/// the next query checks whether the model satisfies it, or when getSymbolicMapping() is called.
+/// A model that was not fetched before its solver moved on to another component is not kept; the
+/// result still answers later queries of the same set of constraints.
+///
+/// Only the most recent results, and the variables of the most recently split constraints, are
+/// kept. A cache is meant to be owned by a single symbolic executor and is not thread-safe; the
+/// statistics are shared by all caches.
+class SolverQueryCache {
+ public:
+    /// Counts how the queries to all caches were answered.
+    struct Statistics {
+        /// The number of queries.
+        uint64_t queries = 0;
+
+        /// The number of components the queries were split into; the same as @ref queries
+        /// without slicing.
+        uint64_t components = 0;
+
+        /// Components whose set of constraints was checked before.
+        uint64_t exactHits = 0;
+
+        /// Components that contain an unsatisfiable set of constraints.
+        uint64_t unsatHits = 0;
+
+        /// Components satisfied by a model of an earlier query.
+        uint64_t modelHits = 0;
+
+        /// Components that were handed to the solver.
+        uint64_t solverCalls = 0;
+
+        /// The number of constraints in all queries.
+        uint64_t constraints = 0;
+
+        /// The number of constraints that were handed to the solver.
+        uint64_t solvedConstraints = 0;
+    };
+
+    /// Makes a new solver for the cache.
+    using SolverFactory = std::function<std::unique_ptr<AbstractSolver>()>;
+
+    /// Creates a cache, which splits queries into independent components if @param slice is true.
+    /// If @param makeSolver is given, the components are handed to solvers it makes.
+    explicit SolverQueryCache(bool slice = true, SolverFactory makeSolver = nullptr);
+
+    /// Determines whether @param asserts are consistent, calling @param solver only for the parts
+    /// whose result does not follow from earlier queries. @returns the result as
+    /// AbstractSolver::checkSat does.
+    std::optional<bool> checkSat(AbstractSolver &solver,
+                                 const std::vector<const Constraint *> &asserts);
+
+    /// @returns a model of the last query, which may come from an earlier query. The models of
+    /// its components are fetched from the solver, which checks components again if it has moved
+    /// on since. A BUG occurs if the last query was not satisfiable.
+    [[nodiscard]] const SymbolicMapping &getSymbolicMapping();
+
+    /// @returns the statistics of all caches.
+    [[nodiscard]] static Statistics getStatistics();
+
+ private:
+    /// A query in canonical form: its constraints sorted by address, without duplicates.
+    using Query = std::vector<const Constraint *>;
+
+    /// The result of a query.
+    struct Result {
+        bool satisfiable = false;
+
+        /// A model of a satisfiable query, or nullptr if it was not fetched from the solver.
+        const SymbolicMapping *model = nullptr;
+    };
+
+    /// Maps queries to their result.
+    using ResultMap = std::map<Query, Result>;
+
+    /// A component of the last query.
+    struct Component {
+        /// The constraints of the component, in the order of the query.
+        std::vector<const Constraint *> constraints;
+
+        /// The canonical form of the component.
+        Query query;
+
+        /// The model of the component, if it was fetched.
+        const SymbolicMapping *model = nullptr;
+    };
+
+    /// A solver that components are handed to.
+    struct SolverSlot {
+        /// The solver, which is one of @ref ownedSolvers or the solver of the last query.
+        AbstractSolver *solver = nullptr;
+
+        /// The first constraint of the component the solver checked last.
+        const Constraint *lineage = nullptr;
+
+        /// The satisfiable result whose model the solver holds, as it was the last component the
+        /// solver checked.
+        std::optional<ResultMap::iterator> pending;
+
+        /// When the solver was last handed a component, to replace the least recently used one.
+        uint64_t lastUse = 0;
+    };
+
+    /// The maximum number of results that are kept.
+    static constexpr size_t MAX_RESULTS = 4096;
+
+    /// The maximum number of constraints whose variables are kept.
+    static constexpr size_t MAX_VARIABLE_SETS = 4 * MAX_RESULTS;
+
+    /// The number of the most recent results that are tried when a query was not checked before.
+    static constexpr size_t MAX_CANDIDATES = 16;
+
+    /// The maximum number of solvers made by @ref makeSolver. Each keeps a context of its own, so
+    /// once there are this many, the least recently used one is handed the next new line of
+    /// components.
+    static constexpr size_t MAX_SOLVERS = 8;
+
+    /// Whether queries are split into independent components.
+    bool slice;
+
+    /// Makes the solvers of the cache, if it has its own.
+    SolverFactory makeSolver;
+
+    /// The solvers made by @ref makeSolver.
+    std::vector<std::unique_ptr<AbstractSolver>> ownedSolvers;
+
+    /// The solvers components were handed to.
+    std::vector<SolverSlot> solvers;
+
+    /// Counts the components handed to solvers, to find the least recently used solver.
+    uint64_t solverUses = 0;
+
+    /// The results of earlier queries.
+    ResultMap results;
+
+    /// The results in the order they were added, the oldest first.
+    std::deque<ResultMap::iterator> history;
+
+    /// The variables of the constraints that were split into components.
+    std::unordered_map<const Constraint *, std::vector<const IR::SymbolicVariable *>> variables;
+
+    /// The constraints in @ref variables, in the order they were added, the oldest first.
+    std::deque<const Constraint *> variablesOrder;
+
+    /// The solver of the last query.
+    AbstractSolver *querySolver = nullptr;
+
+    /// The components of the last query.
+    std::vector<Component> lastComponents;
+
+    /// Whether the last query was satisfiable.
+    bool lastSatisfiable = false;
+
+    /// The model of the last query, once getSymbolicMapping() has computed it.
+    const SymbolicMapping *lastModel = nullptr;
+
+    /// @returns the variables of @param constraint.
+    const std::vector<const IR::SymbolicVariable *> &getVariables(const Constraint *constraint);
+
+    /// Splits @param asserts into independent components. The constraints of each component, and
+    /// the components, are in the order of @param asserts.
+    std::vector<std::vector<const Constraint *>> split(
+        const std::vector<const Constraint *> &asserts);
+
+    /// @returns the solver that @param component is handed to.
+    SolverSlot &solverFor(const Component &component);
+
+    /// @returns the solver whose pending result is @param result, or nullptr if there is none.
+    SolverSlot *holderOf(ResultMap::iterator result);
+
+    /// Hands @param component to its solver and records the result, without its model.
+    /// @returns the result as AbstractSolver::checkSat does.
+    std::optional<bool> solve(const Component &component);
+
+    /// Fetches the model of the pending result of @param slot from its solver, if it was not yet.
+    /// @returns the model.
+    static const SymbolicMapping *fetchPending(SolverSlot &slot);
+
+    /// @returns the model of @param component of the last query, fetching it if needed.
+    const SymbolicMapping &getModel(Component &component);
+
+    /// @returns the result of @param query if it follows from the most recent results, or
+    /// std::nullopt otherwise.
+    std::optional<Result> lookup(const Query &query);
+
+    /// Records the @param result of @param query. @returns the entry of @param query.
+    ResultMap::iterator insert(const Query &query, Result result);
+
+    /// @returns true if @param model satisfies all the constraints of @param query that are not in
+    /// @param solved. @returns false if it does not, or if it can not be decided without a solver.
+    static bool satisfies(const SymbolicMapping &model, const Query &query, const Query &solved);
+};
+
+}  // namespace P4::P4Tools
+
+#endif /* BACKENDS_P4TOOLS_COMMON_CORE_SOLVER_QUERY_CACHE_H_ */
@@ -65,19 +65,41 @@ std::string Z3Solver::generateName(const IR::SymbolicVariable &var) {
 
 z3::expr Z3Solver::declareVar(const IR::SymbolicVariable &var) {
     auto sort = toSort(var.type);
+    auto it = declaredVars.find(&var);
+    if (it != declaredVars.end() && z3::eq(it->second.get_sort(), sort)) {
+        return it->second;
+    }
     auto expr = ctx().constant(generateName(var).c_str(), sort);
-    BUG_CHECK(
-        !declaredVarsById.empty(),
-        "DeclaredVarsById should have at least one entry! Check if push() was used correctly.");
-    // Need to take the reference here to avoid accidental copies.
-    auto *latestVars = &declaredVarsById.back();
-    latestVars->emplace(expr.id(), &var);
+    declaredVars.insert_or_assign(&var, expr);
+    declaredVarsById.emplace(expr.id(), &var);
     return expr;
 }
 
+const z3::expr *Z3Solver::findTranslation(const IR::Expression *expression) {
+    auto it = translations.find(expression);
+    if (it != translations.end()) {
+        return &it->second;
+    }
+    auto old = oldTranslations.find(expression);
+    if (old == oldTranslations.end()) {
+        return nullptr;
+    }
+    auto translation = old->second;
+    oldTranslations.erase(old);
+    storeTranslation(expression, translation);
+    return &translations.at(expression);
+}
+
+void Z3Solver::storeTranslation(const IR::Expression *expression, const z3::expr &translation) {
+    if (translations.size() >= translationLimit) {
+        oldTranslations = std::move(translations);
+        translations.clear();
+    }
+    translations.emplace(expression, translation);
+}
+
 void Z3Solver::reset() {
     z3solver.reset();
-    declaredVarsById.clear();
     checkpoints.clear();
     z3Assertions.resize(0);
 }
@@ -85,6 +107,11 @@ void Z3Solver::reset() {
 void Z3Solver::clearMemory() {
     auto p4AssertionsBuf = p4Assertions;
     reset();
+    // The translations belong to the context that is about to be replaced.
+    translations.clear();
+    oldTranslations.clear();
+    declaredVars.clear();
+    declaredVarsById.clear();
     Z3_finalize_memory();
     z3solver = z3::solver(*new z3::context());
     p4Assertions.clear();
@@ -99,7 +126,6 @@ void Z3Solver::push() {
         z3solver.push();
     }
     checkpoints.push_back(p4Assertions.size());
-    declaredVarsById.emplace_back();
 }
 
 void Z3Solver::pop() {
@@ -109,12 +135,6 @@ void Z3Solver::pop() {
 
     size_t sz = checkpoints.back();
     checkpoints.pop_back();
-    // TODO: This check should be active, but because of JSON loader issues we can not use it.
-    // So we have to be tolerant for now.
-    // BUG_CHECK(!declaredVarsById.empty(), "Declaration list is empty");
-    if (!declaredVarsById.empty()) {
-        declaredVarsById.pop_back();
-    }
     if (isIncremental) {
         z3solver.pop();
     } else {
@@ -234,15 +254,7 @@ void Z3Solver::asrt(const z3::expr &assertion) {
 const SymbolicMapping &Z3Solver::getSymbolicMapping() const {
     Util::ScopedTimer ctZ3("z3");
     auto *result = new SymbolicMapping();
-    // First, collect a map of all the declared variables we have encountered in the stack.
-    std::map<unsigned int, const IR::SymbolicVariable *> declaredVars;
-    for (auto it = declaredVarsById.rbegin(); it != declaredVarsById.rend(); ++it) {
-        auto latestVars = *it;
-        for (auto var : latestVars) {
-            declaredVars.emplace(var);
-        }
-    }
-    // Then, get the model and match each declaration in the model to its IR::SymbolicVariable.
+    // Get the model and match each declaration in the model to its IR::SymbolicVariable.
     try {
         Util::ScopedTimer ctCheckSat("getModel");
         auto z3Model = z3solver.get_model();
@@ -259,9 +271,9 @@ const SymbolicMapping &Z3Solver::getSymbolicMapping() const {
 
             // Convert to a symbolic variable and value.
             auto exprId = z3Expr.id();
-            BUG_CHECK(declaredVars.count(exprId) > 0, "Z3Solver: unknown variable declaration: %1%",
-                      z3Expr);
-            const auto *symbolicVar = declaredVars.at(exprId);
+            BUG_CHECK(declaredVarsById.count(exprId) > 0,
+                      "Z3Solver: unknown variable declaration: %1%", z3Expr);
+            const auto *symbolicVar = declaredVarsById.at(exprId);
             const auto *value = toLiteral(z3Value, symbolicVar->type);
             result->emplace(symbolicVar, value);
         }
@@ -330,9 +342,6 @@ bool Z3Solver::isInIncrementalMode() const { return isIncremental; }
 
 Z3Solver::Z3Solver(bool isIncremental, std::optional<std::istream *> inOpt)
     : z3solver(*new z3::context), isIncremental(isIncremental), z3Assertions(ctx()) {
-    // Add a top-level set to declaration vars that we can insert variables.
-    // TODO: Think about whether this is necessary or it is not better to remove it.
-    declaredVarsById.emplace_back();
     if (inOpt == std::nullopt) {
         return;
     }
@@ -365,11 +374,9 @@ bool Z3Translator::preorder(const IR::Node *node) {
 }
 
 bool Z3Translator::preorder(const IR::Cast *cast) {
-    Z3Translator tCast(solver);
-    cast->expr->apply(tCast);
     uint64_t exprSize = 0;
     const auto *const castExtrType = cast->expr->type;
-    auto castExpr = tCast.result;
+    auto castExpr = translateOperand(cast->expr);
     if (const auto *tb = cast->destType->to<IR::Type_Bits>()) {
         uint64_t destSize = tb->width_bits();
         if (const auto *exprType = castExtrType->to<IR::Type_Bits>()) {
@@ -484,9 +491,7 @@ const ShiftType *Z3Translator::rewriteShift(const ShiftType *shift) const {
 /// General function for unary operations.
 bool Z3Translator::recurseUnary(const IR::Operation_Unary *unary, Z3UnaryOp f) {
     BUG_CHECK(unary, "Z3Translator: encountered null node during translation");
-    Z3Translator tExpr(solver);
-    unary->expr->apply(tExpr);
-    result = f(tExpr.result);
+    result = f(translateOperand(unary->expr));
     return false;
 }
 
@@ -569,11 +574,9 @@ bool Z3Translator::preorder(const IR::Concat *op) { return recurseBinary(op, z3:
 /// general function for binary operations
 bool Z3Translator::recurseBinary(const IR::Operation_Binary *binary, Z3BinaryOp f) {
     BUG_CHECK(binary, "Z3Translator: encountered null node during translation");
-    Z3Translator tLeft(solver);
-    Z3Translator tRight(solver);
-    binary->left->apply(tLeft);
-    binary->right->apply(tRight);
-    result = f(tLeft.result, tRight.result);
+    auto left = translateOperand(binary->left);
+    auto right = translateOperand(binary->right);
+    result = f(left, right);
     return false;
 }
 
@@ -589,21 +592,28 @@ bool Z3Translator::preorder(const IR::Slice *op) {
 /// general function for ternary operations
 bool Z3Translator::recurseTernary(const IR::Operation_Ternary *ternary, Z3TernaryOp f) {
     BUG_CHECK(ternary, "Z3Translator: encountered null node during translation");
-    Z3Translator t0(solver);
-    Z3Translator t1(solver);
-    Z3Translator t2(solver);
-    ternary->e0->apply(t0);
-    ternary->e1->apply(t1);
-    ternary->e2->apply(t2);
-    result = f(t0.result, t1.result, t2.result);
+    auto e0 = translateOperand(ternary->e0);
+    auto e1 = translateOperand(ternary->e1);
+    auto e2 = translateOperand(ternary->e2);
+    result = f(e0, e1, e2);
     return false;
 }
 
 z3::expr Z3Translator::getResult() { return result; }
 
+z3::expr Z3Translator::translateOperand(const IR::Expression *expression) {
+    if (const auto *translation = solver.get().findTranslation(expression)) {
+        return *translation;
+    }
+    Z3Translator translator(solver);
+    expression->apply(translator);
+    solver.get().storeTranslation(expression, translator.result);
+    return translator.result;
+}
+
 z3::expr Z3Translator::translate(const IR::Expression *expression) {
     try {
-        expression->apply(*this);
+        result = translateOperand(expression);
     } catch (z3::exception &e) {
         BUG("Z3Translator: Z3 exception: %1%\nExpression %2%", e.msg(), expression);
     }
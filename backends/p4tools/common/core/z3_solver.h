@@ -6,24 +6,25 @@
 
 #include <cstddef>
 #include <iosfwd>
+#include <map>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "ir/compare.h"
 #include "ir/ir.h"
 #include "ir/json_generator.h"
 #include "ir/solver.h"
 #include "lib/cstring.h"
-#include "lib/ordered_map.h"
 #include "lib/rtti.h"
 #include "lib/safe_vector.h"
 
 namespace P4::P4Tools {
 
-/// A stack of maps, which map Z3-internal expression IDs of declared Z3 variables to their
-/// corresponding P4 state variable. The maps are pushed and pop according to the solver push() and
-/// pop() operations.
-using Z3DeclaredVariablesMap = std::vector<ordered_map<unsigned, const IR::SymbolicVariable *>>;
+/// Maps Z3-internal expression IDs of declared Z3 variables to their corresponding P4 state
+/// variable.
+using Z3DeclaredVariablesMap = std::map<unsigned, const IR::SymbolicVariable *>;
 
 /// A Z3-based implementation of AbstractSolver. Encapsulates a z3::solver and a z3::context.
 class Z3Solver : public AbstractSolver {
@@ -78,8 +79,9 @@ class Z3Solver : public AbstractSolver {
     /// Removes the last solver context.
     void pop();
 
-    /// Reset the internal Z3 solver state (memory and active assertions).
-    /// In incremental state, all active assertions are reapplied after resetting.
+    /// Reset the internal Z3 solver state (memory and active assertions), including the
+    /// translations of P4 expressions to Z3. In incremental state, all active assertions are
+    /// reapplied after resetting.
     void clearMemory();
 
     /// Adds a Z3 assertion to the solver context.
@@ -95,7 +97,8 @@ class Z3Solver : public AbstractSolver {
     /// Get the actual Z3 context that this class uses. This context can be manipulated.
     [[nodiscard]] z3::context &ctx() const;
 
-    /// Declares the given symbolic variable to Z3.
+    /// Declares the given symbolic variable to Z3, unless a variable with the same label and sort
+    /// was declared before.
     ///
     /// @returns the resulting Z3 variable.
     z3::expr declareVar(const IR::SymbolicVariable &var);
@@ -124,6 +127,33 @@ class Z3Solver : public AbstractSolver {
     /// to the original state variable.
     Z3DeclaredVariablesMap declaredVarsById;
 
+    /// The Z3 variables that have been declared, by label. Variables are declared in the context,
+    /// not in a solver scope, so they are kept across push() and pop().
+    std::map<const IR::SymbolicVariable *, z3::expr, IR::SymbolicVariableLess> declaredVars;
+
+    /// @returns the cached Z3 translation of @param expression, or nullptr if there is none. A
+    /// translation found in @ref oldTranslations moves back to @ref translations.
+    const z3::expr *findTranslation(const IR::Expression *expression);
+
+    /// Caches @param translation as the Z3 translation of @param expression.
+    void storeTranslation(const IR::Expression *expression, const z3::expr &translation);
+
+    /// The Z3 translations of the P4 expressions that have been translated, including their
+    /// subexpressions. Execution states that branch from one another share the expressions of
+    /// their common path constraints, so these are only translated once, even after they are
+    /// popped and asserted again.
+    ///
+    /// Each entry keeps its expression and its Z3 AST alive, so the cache is kept in two
+    /// generations. Once @ref translations holds @ref translationLimit entries, it replaces
+    /// @ref oldTranslations, and whatever was not used again since the previous turn is dropped.
+    std::unordered_map<const IR::Expression *, z3::expr> translations;
+
+    /// The previous generation of @ref translations.
+    std::unordered_map<const IR::Expression *, z3::expr> oldTranslations;
+
+    /// The number of translations after which a new generation of the cache is started.
+    size_t translationLimit = 1 << 16;
+
     /// The sequence of P4 assertions that have been made to the solver.
     safe_vector<const Constraint *> p4Assertions;
 
@@ -205,6 +235,10 @@ class Z3Translator : public virtual Inspector {
     z3::expr translate(const IR::Expression *expression);
 
  private:
+    /// @returns the Z3 translation of @param expression, which is translated by a new translator
+    /// unless the solver has a translation of it already.
+    z3::expr translateOperand(const IR::Expression *expression);
+
     /// Function type for a unary operator.
     using Z3UnaryOp = z3::expr (*)(const z3::expr &);
 
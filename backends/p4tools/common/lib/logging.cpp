@@ -1,8 +1,10 @@
 #include "backends/p4tools/common/lib/logging.h"
 
+#include <cstdint>
 #include <fstream>
 #include <unordered_map>
 
+#include "backends/p4tools/common/core/solver_query_cache.h"
 #include "lib/error.h"
 #include "lib/log.h"
 #include "lib/timer.h"
@@ -13,6 +15,35 @@ void enableInformationLogging() { Log::addDebugSpec("tools_info:4"); }
 
 void enablePerformanceLogging() { Log::addDebugSpec("tools_performance:4"); }
 
+namespace {
+
+/// Prints how the queries to the solver query caches were answered, if there were any.
+void printSolverQueryCacheReport() {
+    auto stats = SolverQueryCache::getStatistics();
+    if (stats.queries == 0) {
+        return;
+    }
+    // The hits and solver calls are counted per component.
+    auto pct = [&stats](uint64_t count) {
+        return static_cast<double>(count) * 100 / static_cast<double>(stats.components);
+    };
+    printFeature("tools_performance", 4, "============ Solver query cache ============");
+    printFeature("tools_performance", 4, "Queries: %i in %i independent components",
+                 stats.queries, stats.components);
+    printFeature("tools_performance", 4, "Same constraints: %i (%0.2f %%)", stats.exactHits,
+                 pct(stats.exactHits));
+    printFeature("tools_performance", 4, "Unsatisfiable subset: %i (%0.2f %%)", stats.unsatHits,
+                 pct(stats.unsatHits));
+    printFeature("tools_performance", 4, "Satisfied by a cached model: %i (%0.2f %%)",
+                 stats.modelHits, pct(stats.modelHits));
+    printFeature("tools_performance", 4, "Solver calls: %i (%0.2f %%)", stats.solverCalls,
+                 pct(stats.solverCalls));
+    printFeature("tools_performance", 4, "Constraints handed to the solver: %i of %i",
+                 stats.solvedConstraints, stats.constraints);
+}
+
+}  // namespace
+
 void printPerformanceReport(const std::optional<std::filesystem::path> &basePath) {
     // Do not emit a report if performance logging is not enabled.
     if (!Log::fileLogLevelIsAtLeast("tools_performance", 4)) {
@@ -44,6 +75,7 @@ void printPerformanceReport(const std::optional<std::filesystem::path> &basePath
         }
         timerList.emplace_back(timerData);
     }
+    printSolverQueryCacheReport();
     // Write the report to the file, if one was provided.
     if (basePath.has_value()) {
         auto perfFilePath = basePath.value();
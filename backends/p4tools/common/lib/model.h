@@ -7,11 +7,13 @@
 #include "ir/ir.h"
 #include "ir/solver.h"
 #include "ir/visitor.h"
+#include "lib/persistent_map.h"
 
 namespace P4::P4Tools {
 
-/// Symbolic maps map a state variable to a IR::Expression.
-using SymbolicMapType = P4::flat_map<IR::StateVariable, const IR::Expression *>;
+/// Symbolic maps map a state variable to a IR::Expression. Execution states are copied at every
+/// branch and only change a few variables per branch, so the copies share their structure.
+using SymbolicMapType = P4::persistent_map<IR::StateVariable, const IR::Expression *>;
 
 /// Represents a solution found by the solver. A model is a concretized form of a symbolic
 /// environment. All the expressions in a Model must be of type IR::Literal.
@@ -12,14 +12,14 @@
 namespace P4::P4Tools {
 
 const IR::Expression *SymbolicEnv::get(const IR::StateVariable &var) const {
-    auto it = map.find(var);
-    if (it != map.end()) {
-        return it->second;
+    const auto *value = map.find(var);
+    if (value != nullptr) {
+        return *value;
     }
     BUG("Unable to find var %s in the symbolic environment.", var);
 }
 
-bool SymbolicEnv::exists(const IR::StateVariable &var) const { return map.find(var) != map.end(); }
+bool SymbolicEnv::exists(const IR::StateVariable &var) const { return map.find(var) != nullptr; }
 
 void SymbolicEnv::set(const IR::StateVariable &var, const IR::Expression *value) {
     BUG_CHECK(value->type && !value->type->is<IR::Type_Unknown>(),
@@ -27,7 +27,11 @@ namespace P4::P4Tools {
 
 std::optional<uint32_t> Utils::currentSeed = std::nullopt;
 
+#ifdef MULTITHREAD
+thread_local boost::random::mt19937 Utils::rng(0);
+#else
 boost::random::mt19937 Utils::rng(0);
+#endif  // MULTITHREAD
 
 std::string Utils::getTimeStamp() {
     // get current time
@@ -56,6 +60,8 @@ void Utils::setRandomSeed(int seed) {
 
 std::optional<uint32_t> Utils::getCurrentSeed() { return currentSeed; }
 
+void Utils::setThreadSeed(uint32_t seed) { rng.seed(seed); }
+
 uint64_t Utils::getRandInt(uint64_t max) {
     if (!currentSeed) {
         return 0;
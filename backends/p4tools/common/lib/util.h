@@ -22,7 +22,13 @@ class Utils {
      * ========================================================================================= */
  private:
     /// The random generator of this project. It is initialized with the input seed.
+    /// In builds with MULTITHREAD each thread has its own generator, which threads other than
+    /// the main one seed with setThreadSeed.
+#ifdef MULTITHREAD
+    static thread_local boost::random::mt19937 rng;
+#else
     static boost::random::mt19937 rng;
+#endif  // MULTITHREAD
 
     /// Stores the state of the PRNG.
     static std::optional<uint32_t> currentSeed;
@@ -40,6 +46,9 @@ class Utils {
     /// @returns currentSeed.
     static std::optional<uint32_t> getCurrentSeed();
 
+    /// Seeds the random generator of the calling thread only, without changing currentSeed.
+    static void setThreadSeed(uint32_t seed);
+
     /// @returns a random integer in the range [0, @param max]. Always return 0 if no seed is set.
     static uint64_t getRandInt(uint64_t max);
 
@@ -1,6 +1,9 @@
 #include "backends/p4tools/common/lib/variables.h"
 
 #include <map>
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 #include <string>
 #include <tuple>
 
@@ -41,6 +44,10 @@ const IR::TaintExpression *getTaintExpression(const IR::Type *type) {
     // type.
     using key_t = std::tuple<int, bool>;
     static std::map<key_t, const IR::TaintExpression *> TAINTS;
+#ifdef MULTITHREAD
+    static std::mutex TAINTS_LOCK;
+    std::lock_guard<std::mutex> guard(TAINTS_LOCK);
+#endif  // MULTITHREAD
 
     auto *&result = TAINTS[{tb->width_bits(), tb->isSigned}];
     if (result == nullptr) {
@@ -0,0 +1,278 @@
+#include "backends/p4tools/modules/testgen/core/symbolic_executor/parallel_search.h"
+
+#ifdef MULTITHREAD
+#include <pthread.h>
+#endif  // MULTITHREAD
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "backends/p4tools/common/core/z3_solver.h"
+#include "backends/p4tools/common/lib/util.h"
+#include "ir/solver.h"
+#include "lib/error.h"
+#include "lib/exceptions.h"
+#include "lib/gc.h"
+#include "lib/timer.h"
+
+#include "backends/p4tools/modules/testgen/core/program_info.h"
+#include "backends/p4tools/modules/testgen/core/symbolic_executor/symbolic_executor.h"
+#include "backends/p4tools/modules/testgen/lib/exceptions.h"
+#include "backends/p4tools/modules/testgen/lib/execution_state.h"
+#include "backends/p4tools/modules/testgen/options.h"
+
+namespace P4::P4Tools::P4Testgen {
+
+namespace {
+
+/// The solver of a worker. It is a base class of the worker, so that it is constructed before
+/// the SymbolicExecutor base, which seeds it.
+struct WorkerSolver {
+    Z3Solver workerSolver;
+};
+
+/// The argument of a worker thread.
+struct WorkerStart {
+    ParallelSearch *search;
+    unsigned index;
+};
+
+}  // namespace
+
+/// Explores paths with its own solver and evaluator, one path at a time, taking its branches
+/// from the queues of the search.
+class ParallelSearch::Worker : private WorkerSolver, public SymbolicExecutor {
+    ParallelSearch &search;
+    unsigned index;
+
+    /// Branch decisions made without producing a test, as in GreedyNodeSelection.
+    uint64_t stepsWithoutTest = 0;
+
+    /// The maximum number of steps without generating a test before falling back to random.
+    static const uint64_t MAX_STEPS_WITHOUT_TEST = 1000;
+
+    /// Picks the successor to continue the current path with, and queues the others.
+    ExecutionStateReference pickSuccessor(std::vector<Branch> &successors) {
+        if (successors.size() == 1) {
+            return successors.at(0).nextState;
+        }
+        std::optional<Branch> branch;
+        if (search.pathSelectionPolicy == PathSelectionPolicy::GreedyStmtCoverage &&
+            ++stepsWithoutTest < MAX_STEPS_WITHOUT_TEST) {
+            branch = search.popUncoveredBranch(successors);
+        }
+        if (!branch.has_value()) {
+            branch = popRandomBranch(successors);
+        }
+        search.pushBranches(index, successors);
+        return branch.value().nextState;
+    }
+
+ public:
+    Worker(ParallelSearch &search, unsigned index)
+        : SymbolicExecutor(workerSolver, search.programInfo), search(search), index(index) {}
+
+    /// Explores one path, starting at @param executionState.
+    void runImpl(const Callback &callBack, ExecutionStateReference executionState) override {
+        try {
+            while (!search.stop) {
+                if (executionState.get().isTerminal()) {
+                    // The callback records whether the exploration is over.
+                    handleTerminalState(callBack, executionState);
+                    stepsWithoutTest = 0;
+                    return;
+                }
+                StepResult successors = step(executionState);
+                if (successors->empty()) {
+                    return;
+                }
+                executionState = pickSuccessor(*successors);
+            }
+        } catch (TestgenUnimplemented &e) {
+            // If strict is enabled, bubble the exception up.
+            if (TestgenOptions::get().strict) {
+                throw;
+            }
+            // Otherwise we continue with another branch.
+            warning("Path encountered unimplemented feature. Message: %1%\n", e.what());
+        }
+    }
+
+    /// Explores branches until the exploration is over.
+    void explore() {
+        Callback commit = [this](const FinalState &finalState) {
+            return search.commit(finalState);
+        };
+        while (auto branch = search.takeBranch(index)) {
+            runImpl(commit, branch.value().nextState);
+            --search.pending;
+        }
+    }
+};
+
+ParallelSearch::ParallelSearch(AbstractSolver &solver, const ProgramInfo &programInfo,
+                               PathSelectionPolicy pathSelectionPolicy, unsigned numWorkers)
+    : SymbolicExecutor(solver, programInfo), pathSelectionPolicy(pathSelectionPolicy) {
+#ifndef MULTITHREAD
+    numWorkers = 1;
+#endif  // MULTITHREAD
+    BUG_CHECK(numWorkers > 0, "ParallelSearch needs at least one worker");
+    for (unsigned i = 0; i < numWorkers; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+}
+
+bool ParallelSearch::commit(const FinalState &finalState) {
+    std::lock_guard<std::mutex> guard(commitLock);
+    if (stop) {
+        return true;
+    }
+    if ((*callback)(finalState)) {
+        stop = true;
+    }
+    return stop;
+}
+
+template <class Container>
+std::optional<SymbolicExecutor::Branch> ParallelSearch::popUncoveredBranch(Container &branches) {
+    std::lock_guard<std::mutex> guard(commitLock);
+    for (size_t idx = 0; idx < branches.size(); ++idx) {
+        if (coversNewNodes(getVisitedNodes(), branches[idx])) {
+            auto branch = branches[idx];
+            branches[idx] = branches.back();
+            branches.pop_back();
+            return branch;
+        }
+    }
+    return std::nullopt;
+}
+
+void ParallelSearch::pushBranches(unsigned index, std::vector<Branch> &branches) {
+    // Count the branches before they can be taken, so that pending does not drop to 0 early.
+    pending += branches.size();
+    auto &queue = *queues.at(index);
+    std::lock_guard<std::mutex> guard(queue.lock);
+    queue.branches.insert(queue.branches.end(), branches.begin(), branches.end());
+}
+
+std::optional<SymbolicExecutor::Branch> ParallelSearch::takeBranch(unsigned index) {
+    while (!stop && pending != 0) {
+        {
+            auto &queue = *queues.at(index);
+            std::lock_guard<std::mutex> guard(queue.lock);
+            auto &branches = queue.branches;
+            if (!branches.empty()) {
+                Util::ScopedTimer chooseBranchtimer("branch_selection");
+                if (pathSelectionPolicy == PathSelectionPolicy::GreedyStmtCoverage) {
+                    if (auto branch = popUncoveredBranch(branches)) {
+                        return branch;
+                    }
+                }
+                if (pathSelectionPolicy != PathSelectionPolicy::DepthFirst) {
+                    // Pick a branch at random.
+                    auto branchIdx = Utils::getRandInt(branches.size() - 1);
+                    std::swap(branches[branchIdx], branches.back());
+                }
+                auto branch = branches.back();
+                branches.pop_back();
+                return branch;
+            }
+        }
+        // Steal the oldest branch of another worker.
+        for (size_t i = 1; i < queues.size(); ++i) {
+            auto &victim = *queues.at((index + i) % queues.size());
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.branches.empty()) {
+                auto branch = victim.branches.front();
+                victim.branches.pop_front();
+                return branch;
+            }
+        }
+        // All remaining branches are being explored; wait for them to produce more.
+        std::this_thread::yield();
+    }
+    return std::nullopt;
+}
+
+void ParallelSearch::runWorker(unsigned index) {
+    try {
+        // Workers other than the first run on threads of their own, whose random generators
+        // are seeded from the seed of the run.
+        auto seed = Utils::getCurrentSeed();
+        if (index != 0 && seed.has_value()) {
+            Utils::setThreadSeed(seed.value() + index);
+        }
+        Worker worker(*this, index);
+        worker.explore();
+    } catch (...) {
+        errors.at(index) = std::current_exception();
+        stop = true;
+    }
+}
+
+void *ParallelSearch::work(void *arg) {
+    const auto *start = static_cast<const WorkerStart *>(arg);
+    gc_register_thread();
+    start->search->runWorker(start->index);
+    gc_unregister_thread();
+    return nullptr;
+}
+
+void ParallelSearch::runImpl(const Callback &callBack, ExecutionStateReference executionState) {
+    callback = &callBack;
+    stop = false;
+    errors.assign(queues.size(), nullptr);
+    pending = 1;
+    queues.at(0)->branches.emplace_back(executionState.get());
+
+#ifdef MULTITHREAD
+    // The collector only lets threads register themselves once a registered thread allowed it.
+    gc_allow_register_threads();
+    std::vector<WorkerStart> starts;
+    for (unsigned i = 1; i < queues.size(); ++i) {
+        starts.push_back({this, i});
+    }
+    std::vector<pthread_t> workers;
+    for (auto &start : starts) {
+        pthread_t tid;
+        pthread_attr_t attr;
+        int err;
+        // Stepping and solving recurse over expressions; give workers the stack of the main
+        // thread rather than the (small) default.
+        size_t stack_size = 1024 * 1024 * 64;  // 64MB
+        err = pthread_attr_init(&attr);
+        BUG_CHECK(!err, "Pthread Attribute initialization fail with error: %d", err);
+        err = pthread_attr_setstacksize(&attr, stack_size);
+        BUG_CHECK(!err, "Pthread Attribute Set Stack Size fail with error: %d", err);
+        err = pthread_create(&tid, &attr, work, &start);
+        BUG_CHECK(!err, "Pthread Creation fail with error: %d", err);
+        err = pthread_attr_destroy(&attr);
+        BUG_CHECK(!err, "Pthread Attribute destroy fail with error: %d", err);
+        workers.push_back(tid);
+    }
+#endif  // MULTITHREAD
+
+    // The first worker runs on the calling thread.
+    runWorker(0);
+
+#ifdef MULTITHREAD
+    for (auto tid : workers) {
+        pthread_join(tid, nullptr);
+    }
+#endif  // MULTITHREAD
+
+    for (auto &queue : queues) {
+        queue->branches.clear();
+    }
+    callback = nullptr;
+    for (auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace P4::P4Tools::P4Testgen
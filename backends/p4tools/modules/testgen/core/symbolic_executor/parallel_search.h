@@ -0,0 +1,102 @@
+#ifndef BACKENDS_P4TOOLS_MODULES_TESTGEN_CORE_SYMBOLIC_EXECUTOR_PARALLEL_SEARCH_H_
+#define BACKENDS_P4TOOLS_MODULES_TESTGEN_CORE_SYMBOLIC_EXECUTOR_PARALLEL_SEARCH_H_
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "ir/solver.h"
+
+#include "backends/p4tools/modules/testgen/core/program_info.h"
+#include "backends/p4tools/modules/testgen/core/symbolic_executor/path_selection.h"
+#include "backends/p4tools/modules/testgen/core/symbolic_executor/symbolic_executor.h"
+#include "backends/p4tools/modules/testgen/lib/execution_state.h"
+#include "backends/p4tools/modules/testgen/lib/final_state.h"
+
+namespace P4::P4Tools::P4Testgen {
+
+/// Explores the paths of the program on a number of worker threads. Each worker has its own Z3
+/// solver and small-step evaluator, explores one path at a time, and keeps the branches it did
+/// not take in a queue of its own. A worker takes its next branch from its own queue as the path
+/// selection policy would (the newest one for depth-first search), and when its queue is empty,
+/// steals the oldest branch of another worker, which is the one closest to the start of the
+/// program and so likely to lead to the most work.
+///
+/// Terminal states are checked by the worker that reached them and handed to the callback one at
+/// a time, so the test back end numbers the tests densely in the order they are committed. The
+/// set of visited nodes is only changed by the callback and only read under the same lock. Once
+/// the callback asks to stop, because of --max-tests or --stop-metric, no other terminal state
+/// is committed and the workers return.
+///
+/// Worker threads are only used in builds with MULTITHREAD enabled; otherwise, a single worker
+/// explores the program on the calling thread.
+class ParallelSearch : public SymbolicExecutor {
+ public:
+    /// Explores the program from @param executionState on all workers and returns when all
+    /// paths have been explored or the callback asked to stop.
+    void runImpl(const Callback &callBack, ExecutionStateReference executionState) override;
+
+    ParallelSearch(AbstractSolver &solver, const ProgramInfo &programInfo,
+                   PathSelectionPolicy pathSelectionPolicy, unsigned numWorkers);
+
+ private:
+    class Worker;
+
+    /// The unexplored branches of a worker.
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<Branch> branches;
+    };
+
+    /// How workers choose among successors and among their unexplored branches.
+    PathSelectionPolicy pathSelectionPolicy;
+
+    /// One queue per worker.
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    /// The number of branches that are queued or being explored. The exploration is over when
+    /// it drops to 0.
+    std::atomic<size_t> pending{0};
+
+    /// Set once the callback asks to stop, or a worker fails.
+    std::atomic<bool> stop{false};
+
+    /// Serializes the calls to the callback and the accesses to the set of visited nodes.
+    std::mutex commitLock;
+
+    /// The exception each worker failed with, if any.
+    std::vector<std::exception_ptr> errors;
+
+    /// The callback of the current exploration.
+    const Callback *callback = nullptr;
+
+    /// Runs worker @param index until the exploration is over.
+    void runWorker(unsigned index);
+
+    /// Entry point of a worker thread.
+    static void *work(void *arg);
+
+    /// Hands @param finalState to the callback unless the exploration is over.
+    /// @returns true if the exploration is over.
+    bool commit(const FinalState &finalState);
+
+    /// Queues the branches in @param branches on the queue of worker @param index.
+    void pushBranches(unsigned index, std::vector<Branch> &branches);
+
+    /// @returns the next branch for worker @param index to explore, or std::nullopt once the
+    /// exploration is over.
+    std::optional<Branch> takeBranch(unsigned index);
+
+    /// Removes and returns a branch of @param branches that covers nodes that have not been
+    /// visited yet, if there is one.
+    template <class Container>
+    std::optional<Branch> popUncoveredBranch(Container &branches);
+};
+
+}  // namespace P4::P4Tools::P4Testgen
+
+#endif /* BACKENDS_P4TOOLS_MODULES_TESTGEN_CORE_SYMBOLIC_EXECUTOR_PARALLEL_SEARCH_H_ */
@@ -3,10 +3,12 @@
 #include <algorithm>
 #include <fstream>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "backends/p4tools/common/core/z3_solver.h"
 #include "backends/p4tools/common/lib/util.h"
 #include "ir/ir.h"
 #include "ir/solver.h"
@@ -19,9 +21,30 @@
 #include "backends/p4tools/modules/testgen/lib/execution_state.h"
 #include "backends/p4tools/modules/testgen/lib/final_state.h"
 #include "backends/p4tools/modules/testgen/lib/logging.h"
+#include "backends/p4tools/modules/testgen/options.h"
 
 namespace P4::P4Tools::P4Testgen {
 
+namespace {
+
+/// @returns a factory of the solvers the query cache hands independent components to. They are
+/// only needed if @param solver is incremental; otherwise it checks every component from scratch.
+SolverQueryCache::SolverFactory componentSolverFactory(const AbstractSolver &solver) {
+    if (!solver.isInIncrementalMode()) {
+        return nullptr;
+    }
+    return []() -> std::unique_ptr<AbstractSolver> {
+        auto componentSolver = std::make_unique<Z3Solver>();
+        auto seed = Utils::getCurrentSeed();
+        if (seed != std::nullopt) {
+            componentSolver->seed(*seed);
+        }
+        return componentSolver;
+    };
+}
+
+}  // namespace
+
 SymbolicExecutor::StepResult SymbolicExecutor::step(ExecutionState &state) {
     StepResult successors = nullptr;
     // Use a scope here to measure the time it takes for a step.
@@ -32,7 +55,7 @@ SymbolicExecutor::StepResult SymbolicExecutor::step(ExecutionState &state) {
     // Remove any successors that are unsatisfiable.
     successors->erase(
         std::remove_if(successors->begin(), successors->end(),
-                       [this](const Branch &b) -> bool { return !evaluateBranch(b, solver); }),
+                       [this](const Branch &b) -> bool { return !evaluateBranch(b); }),
         successors->end());
     return successors;
 }
@@ -45,7 +68,7 @@ bool SymbolicExecutor::handleTerminalState(const Callback &callback,
                                            const ExecutionState &terminalState) {
     // Check the solver for satisfiability. If it times out or reports non-satisfiability, issue
     // a warning and continue on a different path.
-    auto solverResult = solver.checkSat(terminalState.getPathConstraint());
+    auto solverResult = checkSat(terminalState);
     if (!solverResult) {
         warning("Solver timed out");
         return false;
@@ -56,15 +79,24 @@ bool SymbolicExecutor::handleTerminalState(const Callback &callback,
         return false;
     }
 
-    // Get the model from the solver, complete it with respect to the
+    // Get the model from the solver (or the query cache), complete it with respect to the
     // final symbolic environment and trace, use it to evaluate the
     // final execution state, and finally delegate to the callback.
-    const FinalState finalState(solver, terminalState);
+    const auto &symbolicMapping = TestgenOptions::get().solverQueryCache
+                                      ? queryCache.getSymbolicMapping()
+                                      : solver.getSymbolicMapping();
+    const FinalState finalState(solver, terminalState, symbolicMapping);
     return callback(finalState);
 }
 
-bool SymbolicExecutor::evaluateBranch(const SymbolicExecutor::Branch &branch,
-                                      AbstractSolver &solver) {
+std::optional<bool> SymbolicExecutor::checkSat(const ExecutionState &state) {
+    if (TestgenOptions::get().solverQueryCache) {
+        return queryCache.checkSat(solver, state.getPathConstraint());
+    }
+    return solver.checkSat(state.getPathConstraint());
+}
+
+bool SymbolicExecutor::evaluateBranch(const SymbolicExecutor::Branch &branch) {
     // Do not bother invoking the solver for a trivial case.
     // In either case (true or false), we do not need to add the assertion and check.
     if (const auto *boolLiteral = branch.constraint->to<IR::BoolLiteral>()) {
@@ -72,7 +104,7 @@ bool SymbolicExecutor::evaluateBranch(const SymbolicExecutor::Branch &branch,
     }
 
     // Check the consistency of the path constraints asserted so far.
-    auto solverResult = solver.checkSat(branch.nextState.get().getPathConstraint());
+    auto solverResult = checkSat(branch.nextState);
     if (solverResult == std::nullopt) {
         warning("Solver timed out");
     }
@@ -88,11 +120,29 @@ SymbolicExecutor::Branch SymbolicExecutor::popRandomBranch(
     return branch;
 }
 
+bool SymbolicExecutor::coversNewNodes(const P4::Coverage::CoverageSet &coveredNodes,
+                                      const SymbolicExecutor::Branch &branch) {
+    // First check all the potential set of nodes we can cover by looking ahead.
+    for (const auto &stmt : branch.potentialNodes) {
+        if (coveredNodes.count(stmt) == 0U) {
+            return true;
+        }
+    }
+    // If we did not find anything, check whether this state covers any new nodes already.
+    for (const auto &stmt : branch.nextState.get().getVisited()) {
+        if (coveredNodes.count(stmt) == 0U) {
+            return true;
+        }
+    }
+    return false;
+}
+
 SymbolicExecutor::SymbolicExecutor(AbstractSolver &solver, const ProgramInfo &programInfo)
     : programInfo(programInfo),
       solver(solver),
       coverableNodes(programInfo.getCoverableNodes()),
-      evaluator(solver, programInfo) {
+      evaluator(solver, programInfo),
+      queryCache(TestgenOptions::get().constraintSlicing, componentSolverFactory(solver)) {
     // If there is no seed provided, do not randomize the solver.
     auto seed = Utils::getCurrentSeed();
     if (seed != std::nullopt) {
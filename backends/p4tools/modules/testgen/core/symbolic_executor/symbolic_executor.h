@@ -3,8 +3,10 @@
 
 #include <functional>
 #include <iosfwd>
+#include <optional>
 #include <vector>
 
+#include "backends/p4tools/common/core/solver_query_cache.h"
 #include "ir/solver.h"
 #include "midend/coverage.h"
 
@@ -79,18 +81,31 @@ class SymbolicExecutor {
     /// Take one step in the program and return list of possible branches.
     StepResult step(ExecutionState &state);
 
-    /// Take a branch and a solver as input.
-    /// Compute the branch's path conditions using the solver.
+    /// Take a branch as input.
+    /// Compute the branch's path conditions using the solver, or the query cache.
     /// Return true if the solver can find a solution and does not time out.
-    static bool evaluateBranch(const SymbolicExecutor::Branch &branch, AbstractSolver &solver);
+    bool evaluateBranch(const SymbolicExecutor::Branch &branch);
+
+    /// Checks the path constraints of @param state, calling the solver only if the result does not
+    /// follow from earlier queries.
+    std::optional<bool> checkSat(const ExecutionState &state);
 
     /// Select a branch at random from the input @param candidateBranches.
     //  Remove the branch from the container.
     static SymbolicExecutor::Branch popRandomBranch(
         std::vector<SymbolicExecutor::Branch> &candidateBranches);
 
+    /// @returns true if @param branch has covered, or may cover when looking ahead, nodes that
+    /// are not in @param coveredNodes.
+    static bool coversNewNodes(const P4::Coverage::CoverageSet &coveredNodes,
+                               const SymbolicExecutor::Branch &branch);
+
  private:
     SmallStepEvaluator evaluator;
+
+    /// Answers queries whose result follows from earlier ones. Only used if the solver query
+    /// cache is enabled.
+    SolverQueryCache queryCache;
 };
 
 }  // namespace P4::P4Tools::P4Testgen
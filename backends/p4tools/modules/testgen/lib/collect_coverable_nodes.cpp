@@ -1,5 +1,8 @@
 #include "backends/p4tools/modules/testgen/lib/collect_coverable_nodes.h"
 
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 #include <string>
 #include <vector>
 
@@ -141,15 +144,26 @@ void CoverableNodesScanner::updateNodeCoverage(const IR::Node *node,
     CHECK_NULL(node);
 
     static NodeCache CACHED_NODES;
+#ifdef MULTITHREAD
+    // Parallel explorations share the cache; a node may be scanned by two of them at once.
+    static std::mutex CACHE_LOCK;
+    std::unique_lock<std::mutex> guard(CACHE_LOCK);
+#endif  // MULTITHREAD
     // If the node is already in the cache, return it.
     auto it = CACHED_NODES.find(node);
     if (it != CACHED_NODES.end()) {
         nodes.insert(it->second.begin(), it->second.end());
         return;
     }
+#ifdef MULTITHREAD
+    guard.unlock();
+#endif  // MULTITHREAD
     node->apply(*this);
     nodes.insert(coverableNodes.begin(), coverableNodes.end());
     // Store the result in the cache.
+#ifdef MULTITHREAD
+    guard.lock();
+#endif  // MULTITHREAD
     CACHED_NODES.emplace(node, coverableNodes);
 }
 
@@ -65,7 +65,7 @@ const NamespaceContext *ExecutionState::StackFrame::getNameSpaces() const { retu
 ExecutionState::ExecutionState(const IR::P4Program *program)
     : AbstractExecutionState(program),
       body({program}),
-      stack(*(new std::stack<std::reference_wrapper<const StackFrame>>())) {
+      stack() {
     env.set(&PacketVars::INPUT_PACKET_LABEL, IR::Constant::get(IR::Type_Bits::get(0), 0));
     env.set(&PacketVars::PACKET_BUFFER_LABEL, IR::Constant::get(IR::Type_Bits::get(0), 0));
     // We also add the taint property and set it to false.
@@ -83,7 +83,7 @@ ExecutionState::ExecutionState(const IR::P4Program *program)
 }
 
 ExecutionState::ExecutionState(Continuation::Body body)
-    : body(std::move(body)), stack(*(new std::stack<std::reference_wrapper<const StackFrame>>())) {
+    : body(std::move(body)), stack() {
     // We also add the taint property and set it to false.
     setProperty("inUndefinedState"_cs, false);
     // Drop is initialized to false, too.
@@ -219,8 +219,7 @@ const std::vector<std::reference_wrapper<const TraceEvent>> &ExecutionState::get
 
 const Continuation::Body &ExecutionState::getBody() const { return body; }
 
-const std::stack<std::reference_wrapper<const ExecutionState::StackFrame>> &
-ExecutionState::getStack() const {
+const ExecutionState::ContinuationStack &ExecutionState::getStack() const {
     return stack;
 }
 
@@ -239,10 +238,12 @@ void ExecutionState::addTestObject(cstring category, cstring objectLabel,
 
 const TestObject *ExecutionState::getTestObject(cstring category, cstring objectLabel,
                                                 bool checked) const {
-    auto testObjectCategory = getTestObjectCategory(category);
-    auto it = testObjectCategory.find(objectLabel);
-    if (it != testObjectCategory.end()) {
-        return it->second;
+    const auto *testObjectCategory = testObjects.find(category);
+    if (testObjectCategory != nullptr) {
+        auto it = testObjectCategory->find(objectLabel);
+        if (it != testObjectCategory->end()) {
+            return it->second;
+        }
     }
     if (checked) {
         BUG("Unable to find test object with the label %1% in the category %2%. ", objectLabel,
@@ -252,17 +253,16 @@ const TestObject *ExecutionState::getTestObject(cstring category, cstring object
 }
 
 TestObjectMap ExecutionState::getTestObjectCategory(cstring category) const {
-    auto it = testObjects.find(category);
-    if (it != testObjects.end()) {
-        return it->second;
+    const auto *testObjectCategory = testObjects.find(category);
+    if (testObjectCategory != nullptr) {
+        return *testObjectCategory;
     }
     return {};
 }
 
 void ExecutionState::deleteTestObject(cstring category, cstring objectLabel) {
-    auto it = testObjects.find(category);
-    if (it != testObjects.end()) {
-        it->second.erase(objectLabel);
+    if (testObjects.count(category) != 0) {
+        testObjects[category].erase(objectLabel);
     }
 }
 
@@ -21,8 +21,10 @@
 #include "ir/ir.h"
 #include "ir/node.h"
 #include "ir/solver.h"
+#include "lib/cow_map.h"
 #include "lib/cstring.h"
 #include "lib/exceptions.h"
+#include "lib/persistent_map.h"
 #include "midend/coverage.h"
 
 #include "backends/p4tools/modules/testgen/lib/continuation.h"
@@ -66,6 +68,9 @@ class ExecutionState : public AbstractExecutionState {
         [[nodiscard]] const NamespaceContext *getNameSpaces() const;
     };
 
+    using ContinuationStack = std::stack<std::reference_wrapper<const StackFrame>,
+                                         std::vector<std::reference_wrapper<const StackFrame>>>;
+
     /// No move semantics because of constant members. We always need to clone a state.
     ExecutionState(ExecutionState &&) = delete;
     ExecutionState &operator=(ExecutionState &&) = delete;
@@ -89,8 +94,12 @@ class ExecutionState : public AbstractExecutionState {
     /// find a corresponding handler. The handler body becomes the new @body, and the frame below
     /// becomes the top of the stack.
     ///
+    /// The stack is as deep as the nesting of calls and holds references, so copying it at a
+    /// branch copies a few pointers. It is kept in a vector, which copies them in one allocation;
+    /// a structure shared between copies would cost more on every push and pop than it saves.
+    ///
     // Invariant: if the @body is empty, then so is this, and this state is terminal.
-    std::stack<std::reference_wrapper<const StackFrame>> stack;
+    ContinuationStack stack;
 
     /// State properties are bools, integers, or strings that can be set and propagated across
     /// execution state. They are used to influence execution along a particular continuation path.
@@ -98,7 +107,8 @@ class ExecutionState : public AbstractExecutionState {
     /// written while this variable is active is tainted. This property must be unset manually to
     /// resume normal operation by setting the property "false". Usually, this is done directly
     /// after the tainted sequence of commands has been executed.
-    std::map<cstring, Continuation::PropertyValue> stateProperties;
+    /// States are copied at every branch, so the properties are shared until a branch sets one.
+    persistent_map<cstring, Continuation::PropertyValue> stateProperties;
 
     // Test objects are classes of variables that influence the execution of test frameworks. They
     // are collected during interpreter execution and consumed by the respective test framework. For
@@ -106,7 +116,8 @@ class ExecutionState : public AbstractExecutionState {
     // which defines control plane match action entries. Once the interpreter has solved for the
     // variables used by these test objects and concretized the values, they can be used to generate
     // a test. Test objects are not constant because they may be manipulated by a target back end.
-    std::map<cstring, TestObjectMap> testObjects;
+    // States are copied at every branch, so the categories are shared until a branch changes them.
+    cow_map<cstring, TestObjectMap> testObjects;
 
     /// The parserErrorLabel is set by the parser to indicate the variable corresponding to the
     /// parser error that is set by various built-in functions such as verify or extract.
@@ -183,7 +194,7 @@ class ExecutionState : public AbstractExecutionState {
     [[nodiscard]] const Continuation::Body &getBody() const;
 
     /// @returns the current stack.
-    [[nodiscard]] const std::stack<std::reference_wrapper<const StackFrame>> &getStack() const;
+    [[nodiscard]] const ContinuationStack &getStack() const;
 
     /// Set the property with @arg propertyName to @arg property.
     void setProperty(cstring propertyName, Continuation::PropertyValue property);
@@ -195,9 +206,9 @@ class ExecutionState : public AbstractExecutionState {
     /// BUG, If the specified type does not match or the property is not found.
     template <class T>
     [[nodiscard]] T getProperty(cstring propertyName) const {
-        auto iterator = stateProperties.find(propertyName);
-        if (iterator != stateProperties.end()) {
-            auto val = iterator->second;
+        const auto *value = stateProperties.find(propertyName);
+        if (value != nullptr) {
+            auto val = *value;
             try {
                 T resolvedVal = std::get<T>(val);
                 return resolvedVal;
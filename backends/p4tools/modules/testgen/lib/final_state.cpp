@@ -22,9 +22,13 @@
 namespace P4::P4Tools::P4Testgen {
 
 FinalState::FinalState(AbstractSolver &solver, const ExecutionState &finalState)
+    : FinalState(solver, finalState, solver.getSymbolicMapping()) {}
+
+FinalState::FinalState(AbstractSolver &solver, const ExecutionState &finalState,
+                       const SymbolicMapping &symbolicMapping)
     : solver(solver),
       state(finalState),
-      finalModel(processModel(finalState, *new Model(solver.getSymbolicMapping()))) {
+      finalModel(processModel(finalState, *new Model(symbolicMapping))) {
     for (const auto &event : finalState.getTrace()) {
         trace.emplace_back(*event.get().evaluate(finalModel, true));
     }
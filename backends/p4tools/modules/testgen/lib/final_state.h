@@ -47,6 +47,12 @@ class FinalState {
     /// and the executionState.
     FinalState(AbstractSolver &solver, const ExecutionState &finalState);
 
+    /// This constructor invokes @ref processModel() to produce the model based on
+    /// @param symbolicMapping, a solution of the path constraints of the executionState that was
+    /// not necessarily found by the last call to the solver.
+    FinalState(AbstractSolver &solver, const ExecutionState &finalState,
+               const SymbolicMapping &symbolicMapping);
+
     /// This constructor takes the input model as is and does not invoke @ref processModel().
     FinalState(AbstractSolver &solver, const ExecutionState &finalState, const Model &finalModel);
 
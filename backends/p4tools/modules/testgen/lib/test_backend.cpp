@@ -76,7 +76,9 @@ bool TestBackEnd::run(const FinalState &state) {
         }
 
         // For long-running tests periodically reset the solver state to free up memory.
-        if (testCount != 0 && testCount % RESET_THRESHOLD == 0) {
+        // Z3 frees its memory process-wide, which is not safe while other workers are still
+        // solving with their own contexts; with several workers, the state is kept.
+        if (testCount != 0 && testCount % RESET_THRESHOLD == 0 && testgenOptions.numWorkers <= 1) {
             auto &solver = state.getSolver();
             auto *z3Solver = solver.to<Z3Solver>();
             CHECK_NULL(z3Solver);
@@ -53,6 +53,32 @@ TestgenOptions::TestgenOptions()
         "Sets the maximum number of tests to be generated [default: 1]. Setting the value to 0 "
         "will generate tests until no more paths can be found.");
 
+    registerOption(
+        "--num-workers", "numWorkers",
+        [this](const char *arg) {
+            try {
+                auto workers = std::stoll(arg);
+                if (workers < 1 || workers > 1024) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+                numWorkers = static_cast<unsigned>(workers);
+            } catch (std::exception &) {
+                error("Invalid input value %1% for --num-workers. Expected a positive integer.",
+                      arg);
+                return false;
+            }
+#ifndef MULTITHREAD
+            if (numWorkers > 1) {
+                warning("--num-workers: this build does not support threads; paths are explored "
+                        "on a single worker.");
+            }
+#endif  // MULTITHREAD
+            return true;
+        },
+        "Explores paths on the given number of threads, each with its own solver [default: 1]. "
+        "Tests are numbered in the order they are generated; --max-tests and --stop-metric apply "
+        "to all workers together.");
+
     registerOption(
         "--stop-metric", "stopMetric",
         [this](const char *arg) {
@@ -408,6 +434,24 @@ TestgenOptions::TestgenOptions()
         "Do not apply the conditions defined within \"testgen_assume\" extern calls in P4 programs."
         "They will have no effect on P4Testgen's path exploration.");
 
+    registerOption(
+        "--disable-solver-query-cache", nullptr,
+        [this](const char * /*arg*/) {
+            solverQueryCache = false;
+            return true;
+        },
+        "Call the solver for every path constraint, instead of reusing the results and models of "
+        "earlier queries where they decide a query.");
+
+    registerOption(
+        "--disable-constraint-slicing", nullptr,
+        [this](const char * /*arg*/) {
+            constraintSlicing = false;
+            return true;
+        },
+        "Hand all the path constraints of a query to the solver, instead of only the constraints "
+        "that share variables with the constraints whose result is not cached.");
+
     registerOption(
         "--assertion-mode", nullptr,
         [this](const char * /*arg*/) {
@@ -27,6 +27,10 @@ class TestgenOptions : public AbstractP4cToolOptions {
     /// Selects the path selection policy for test generation
     P4Testgen::PathSelectionPolicy pathSelectionPolicy = P4Testgen::PathSelectionPolicy::DepthFirst;
 
+    /// Number of threads that explore paths in parallel, each with its own solver. Defaults to
+    /// 1, which explores paths on the calling thread.
+    unsigned numWorkers = 1;
+
     /// List of the supported stop metrics.
     static const std::set<cstring> SUPPORTED_STOP_METRICS;
 
@@ -84,6 +88,15 @@ class TestgenOptions : public AbstractP4cToolOptions {
     /// Only tests which satisfy these conditions can be generated. This is active by default.
     bool enforceAssumptions = true;
 
+    /// Answer the satisfiability queries of the symbolic executor from the results of earlier
+    /// queries where possible. This is active by default.
+    bool solverQueryCache = true;
+
+    /// Split the queries of the symbolic executor into components that share no variables, and
+    /// only hand the components whose result is not cached to the solver. This is active by
+    /// default and has no effect without the solver query cache.
+    bool constraintSlicing = true;
+
     /// Produce only tests that violate the condition defined in assert calls.
     /// This will either produce no tests or only tests that contain counter examples.
     bool assertionModeEnabled = false;
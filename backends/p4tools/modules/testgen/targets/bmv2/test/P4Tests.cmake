@@ -104,3 +104,20 @@ if(P4TOOLS_TESTGEN_BMV2_TEST_STF)
   )
   include(${CMAKE_CURRENT_LIST_DIR}/BMV2STFXfail.cmake)
 endif()
+
+# Parallel exploration
+# Runs the search on several workers. In builds with ENABLE_THREAD_SANITIZER, any data race between
+# the workers fails the test.
+if(ENABLE_MULTITHREAD)
+  set(P4C_V1_TEST_SUITES_P416_PARALLEL
+      "${P4C_SOURCE_DIR}/testdata/p4_16_samples/basic_routing-bmv2.p4"
+      "${P4C_SOURCE_DIR}/testdata/p4_16_samples/table-entries-ternary-bmv2.p4"
+      "${P4C_SOURCE_DIR}/testdata/p4_16_samples/v1model-special-ops-bmv2.p4"
+  )
+  p4tools_add_tests(
+    TESTS "${P4C_V1_TEST_SUITES_P416_PARALLEL}"
+    TAG "testgen-p4c-bmv2-parallel" DRIVER ${P4TESTGEN_DRIVER}
+    TARGET "bmv2" ARCH "v1model" VALIDATE_PROTOBUF_IR
+    TEST_ARGS "--test-backend PROTOBUF_IR --num-workers 4 --strict --seed 1000 --max-tests 100 "
+  )
+endif()
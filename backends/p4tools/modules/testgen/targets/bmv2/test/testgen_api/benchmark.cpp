@@ -1,10 +1,14 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <iostream>
+
 #include "backends/p4tools/common/compiler/context.h"
 #include "backends/p4tools/common/lib/logging.h"
 #include "frontends/common/options.h"
 #include "lib/compile_context.h"
+#include "lib/timer.h"
 #include "test/gtest/helpers.h"
 
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/path_selection.h"
@@ -16,7 +20,43 @@ namespace P4::P4Tools::Test {
 
 using namespace P4::literals;
 
-class P4TestgenBenchmark : public P4TestgenBmv2Test {};
+class P4TestgenBenchmark : public P4TestgenBmv2Test {
+ protected:
+    /// @returns the time spent in the solver so far, in milliseconds.
+    static size_t solverMilliseconds() {
+        size_t milliseconds = 0;
+        for (const auto &timer : Util::getTimers()) {
+            const auto &name = timer.timerName;
+            if (name == "z3" || (name.size() > 3 && name.compare(name.size() - 3, 3, ".z3") == 0)) {
+                milliseconds += timer.milliseconds;
+            }
+        }
+        return milliseconds;
+    }
+
+    /// Generates @param maxTests tests for the fabric program, depth-first.
+    /// @returns the number of tests.
+    static size_t generateFabricTests(int64_t maxTests) {
+        auto &testgenOptions = P4Testgen::TestgenOptions::get();
+        testgenOptions.target = "bmv2"_cs;
+        testgenOptions.arch = "v1model"_cs;
+        auto includePath = P4CTestEnvironment::getProjectRoot() / "p4include";
+        testgenOptions.preprocessor_options = "-I" + includePath.string();
+        auto fabricFile = P4CTestEnvironment::getProjectRoot() /
+                          "testdata/p4_16_samples/fabric_20190420/fabric.p4";
+        testgenOptions.file = fabricFile.string();
+        testgenOptions.testBackend = "PROTOBUF_IR"_cs;
+        testgenOptions.testBaseName = "dummy"_cs;
+        testgenOptions.seed = 1;
+        testgenOptions.minPktSize = 512;
+        testgenOptions.maxPktSize = 512;
+        testgenOptions.pathSelectionPolicy = P4Tools::P4Testgen::PathSelectionPolicy::DepthFirst;
+        testgenOptions.maxTests = maxTests;
+        auto testList = P4Testgen::Testgen::generateTests(testgenOptions);
+        EXPECT_TRUE(testList.has_value());
+        return testList.has_value() ? testList.value().size() : 0;
+    }
+};
 
 TEST_F(P4TestgenBenchmark, SuccessfullyGenerate1000Tests) {
     auto &testgenOptions = P4Testgen::TestgenOptions::get();
@@ -46,4 +86,24 @@ TEST_F(P4TestgenBenchmark, SuccessfullyGenerate1000Tests) {
     // Print the report.
     P4Tools::printPerformanceReport();
 }
+
+/// Prints the solver time on the same paths with and without constraint slicing.
+TEST_F(P4TestgenBenchmark, DISABLED_ConstraintSlicing) {
+    auto &testgenOptions = P4Testgen::TestgenOptions::get();
+    testgenOptions.constraintSlicing = false;
+    auto start = solverMilliseconds();
+    auto unslicedTests = generateFabricTests(500);
+    auto unsliced = solverMilliseconds() - start;
+
+    testgenOptions.constraintSlicing = true;
+    start = solverMilliseconds();
+    auto slicedTests = generateFabricTests(500);
+    auto sliced = solverMilliseconds() - start;
+
+    std::cout << "[constraint slicing] " << slicedTests << " tests: " << unsliced
+              << " ms in the solver without slicing, " << sliced << " ms with slicing"
+              << std::endl;
+    // Slicing does not change which paths are feasible.
+    EXPECT_EQ(slicedTests, unslicedTests);
+}
 }  // namespace P4::P4Tools::Test
@@ -33,6 +33,15 @@ class Z3SolverAccessor {
     /// Gets checkpoints that have been made. Used by GTests only.
     std::vector<size_t> &getCheckpoints() { return solver.checkpoints; }
 
+    /// Gets the number of P4 expressions with a cached Z3 translation. Used by GTests only.
+    size_t getTranslationCount() {
+        return solver.translations.size() + solver.oldTranslations.size();
+    }
+
+    /// Sets the number of translations after which the cache starts a new generation. Used by
+    /// GTests only.
+    void setTranslationLimit(size_t limit) { solver.translationLimit = limit; }
+
  private:
     /// Pointer to a solver.
     Z3Solver &solver;
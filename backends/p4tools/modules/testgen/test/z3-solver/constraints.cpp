@@ -9,6 +9,8 @@
 #include "ir/irutils.h"
 #include "lib/cstring.h"
 
+#include "backends/p4tools/modules/testgen/test/z3-solver/accessor.h"
+
 namespace P4::P4Tools::Test {
 
 using namespace P4::literals;
@@ -189,4 +191,51 @@ TEST_F(Z3SolverSatisfiabilityChecks, Bools) {
     }
 }
 
+TEST(Z3SolverTranslationCache, SharedPrefix) {
+    P4Tools::Z3Solver solver;
+    P4Tools::Z3SolverAccessor solverAccessor(solver);
+    const auto *eightBitType = IR::Type_Bits::get(8);
+    const auto *fooVar = P4Tools::ToolsVariables::getSymbolicVariable(eightBitType, "foo"_cs);
+    const auto *barVar = P4Tools::ToolsVariables::getSymbolicVariable(eightBitType, "bar"_cs);
+    const auto *fooIsBar = new IR::Equ(fooVar, barVar);
+    const auto *fooIsOne = new IR::Equ(fooVar, IR::Constant::get(eightBitType, 1));
+    const auto *barIsTwo = new IR::Equ(barVar, IR::Constant::get(eightBitType, 2));
+
+    EXPECT_EQ(solver.checkSat(ConstraintVector{fooIsBar, fooIsOne}), true);
+    auto translations = solverAccessor.getTranslationCount();
+    // Only the constraint that differs from the previous query, and the constant in it, are new.
+    EXPECT_EQ(solver.checkSat(ConstraintVector{fooIsBar, barIsTwo}), false);
+    EXPECT_EQ(solverAccessor.getTranslationCount(), translations + 2);
+    // Constraints that were popped are asserted again without being translated.
+    EXPECT_EQ(solver.checkSat(ConstraintVector{fooIsBar, fooIsOne}), true);
+    EXPECT_EQ(solverAccessor.getTranslationCount(), translations + 2);
+
+    // A variable with the same label is the same Z3 variable.
+    const auto *otherFooVar = P4Tools::ToolsVariables::getSymbolicVariable(eightBitType, "foo"_cs);
+    EXPECT_EQ(solver.checkSat(ConstraintVector{
+                  fooIsBar, fooIsOne, new IR::Equ(otherFooVar, IR::Constant::get(eightBitType, 3))}),
+              false);
+    EXPECT_EQ(solver.checkSat(ConstraintVector{fooIsBar, fooIsOne}), true);
+    const auto &model = solver.getSymbolicMapping();
+    ASSERT_EQ(model.size(), 2U);
+    EXPECT_EQ(model.at(barVar)->checkedTo<IR::Constant>()->asInt(), 1);
+}
+
+TEST(Z3SolverTranslationCache, Bounded) {
+    P4Tools::Z3Solver solver;
+    P4Tools::Z3SolverAccessor solverAccessor(solver);
+    solverAccessor.setTranslationLimit(4);
+    const auto *eightBitType = IR::Type_Bits::get(8);
+    const auto *fooVar = P4Tools::ToolsVariables::getSymbolicVariable(eightBitType, "foo"_cs);
+    const auto *fooIsOne = new IR::Equ(fooVar, IR::Constant::get(eightBitType, 1));
+
+    // Each query translates a new constraint; the ones that are not used again are dropped.
+    for (int i = 0; i < 100; ++i) {
+        const auto *fooIsNotI = new IR::Neq(fooVar, IR::Constant::get(eightBitType, i + 2));
+        EXPECT_EQ(solver.checkSat(ConstraintVector{fooIsOne, fooIsNotI}), true);
+        EXPECT_LE(solverAccessor.getTranslationCount(), 8U);
+    }
+    EXPECT_EQ(solver.checkSat(ConstraintVector{fooIsOne, new IR::Neq(fooVar, fooVar)}), false);
+}
+
 }  // namespace P4::P4Tools::Test
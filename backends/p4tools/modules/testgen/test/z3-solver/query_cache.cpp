@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "backends/p4tools/common/core/solver_query_cache.h"
+#include "backends/p4tools/common/core/z3_solver.h"
+#include "backends/p4tools/common/lib/variables.h"
+#include "ir/ir.h"
+#include "lib/cstring.h"
+
+namespace P4::P4Tools::Test {
+
+using namespace P4::literals;
+using ConstraintVector = const std::vector<const Constraint *>;
+
+class SolverQueryCacheTest : public testing::Test {
+    P4Tools::Z3Solver solver;
+
+ protected:
+    P4Tools::SolverQueryCache cache;
+
+    const IR::Type_Bits *eightBitType = IR::Type_Bits::get(8);
+    const IR::SymbolicVariable *fooVar =
+        P4Tools::ToolsVariables::getSymbolicVariable(eightBitType, "foo"_cs);
+    const IR::SymbolicVariable *barVar =
+        P4Tools::ToolsVariables::getSymbolicVariable(eightBitType, "bar"_cs);
+
+    /// Checks @param asserts with the cache and @returns the number of solver calls it made.
+    uint64_t check(const ConstraintVector &asserts, std::optional<bool> expectedResult) {
+        auto before = SolverQueryCache::getStatistics().solverCalls;
+        EXPECT_EQ(cache.checkSat(solver, asserts), expectedResult);
+        return SolverQueryCache::getStatistics().solverCalls - before;
+    }
+
+    /// @returns the value of @param var in the model of the last query, or -1 if it has none.
+    int valueOf(const IR::SymbolicVariable *var) {
+        const auto &model = cache.getSymbolicMapping();
+        auto it = model.find(var);
+        return it == model.end() ? -1 : it->second->checkedTo<IR::Constant>()->asInt();
+    }
+
+    const IR::Expression *equals(const IR::SymbolicVariable *var, int value) const {
+        return new IR::Equ(var, IR::Constant::get(eightBitType, value));
+    }
+};
+
+TEST_F(SolverQueryCacheTest, SameConstraints) {
+    const auto *fooIsOne = equals(fooVar, 1);
+    const auto *barIsTwo = equals(barVar, 2);
+    // The constraints are independent components, each handed to the solver.
+    EXPECT_EQ(check({fooIsOne, barIsTwo}, true), 2U);
+    // The order and duplicates of the constraints do not matter.
+    EXPECT_EQ(check({barIsTwo, fooIsOne, barIsTwo}, true), 0U);
+    EXPECT_EQ(valueOf(fooVar), 1);
+    EXPECT_EQ(valueOf(barVar), 2);
+}
+
+TEST_F(SolverQueryCacheTest, UnsatisfiableSubset) {
+    const auto *fooIsOne = equals(fooVar, 1);
+    const auto *fooIsTwo = equals(fooVar, 2);
+    EXPECT_EQ(check({fooIsOne, fooIsTwo}, false), 1U);
+    EXPECT_EQ(check({fooIsOne, fooIsTwo, equals(barVar, 3)}, false), 0U);
+    // A subset of an unsatisfiable set may be satisfiable.
+    EXPECT_EQ(check({fooIsOne}, true), 1U);
+}
+
+TEST_F(SolverQueryCacheTest, CachedModel) {
+    const auto *fooIsOne = equals(fooVar, 1);
+    EXPECT_EQ(check({fooIsOne}, true), 1U);
+    // The model of the first query satisfies the new constraint.
+    EXPECT_EQ(check({fooIsOne, new IR::Neq(fooVar, IR::Constant::get(eightBitType, 2))}, true),
+              0U);
+    EXPECT_EQ(valueOf(fooVar), 1);
+    // It does not satisfy this one.
+    EXPECT_EQ(check({fooIsOne, equals(barVar, 5)}, true), 1U);
+    EXPECT_EQ(valueOf(barVar), 5);
+}
+
+TEST_F(SolverQueryCacheTest, IndependentComponents) {
+    const auto *fooIsOne = equals(fooVar, 1);
+    const auto *barIsTwo = equals(barVar, 2);
+    EXPECT_EQ(check({fooIsOne}, true), 1U);
+    // Only the constraint on bar is handed to the solver.
+    auto before = SolverQueryCache::getStatistics().solvedConstraints;
+    EXPECT_EQ(check({fooIsOne, barIsTwo}, true), 1U);
+    EXPECT_EQ(SolverQueryCache::getStatistics().solvedConstraints - before, 1U);
+    EXPECT_EQ(valueOf(fooVar), 1);
+    EXPECT_EQ(valueOf(barVar), 2);
+    // A constraint on both variables joins the components.
+    EXPECT_EQ(check({fooIsOne, barIsTwo, new IR::Equ(fooVar, barVar)}, false), 1U);
+    // An unsatisfiable component makes the query unsatisfiable.
+    EXPECT_EQ(check({fooIsOne, barIsTwo, equals(barVar, 3)}, false), 1U);
+}
+
+TEST_F(SolverQueryCacheTest, ModelsFetchedOnDemand) {
+    const auto *fooIsOne = equals(fooVar, 1);
+    const auto *barIsTwo = equals(barVar, 2);
+    EXPECT_EQ(check({fooIsOne, barIsTwo}, true), 2U);
+    // The solver moved on to the component on bar before the model of the component on foo
+    // was needed, so that component is checked again for its model.
+    auto before = SolverQueryCache::getStatistics().solverCalls;
+    EXPECT_EQ(valueOf(fooVar), 1);
+    EXPECT_EQ(valueOf(barVar), 2);
+    EXPECT_EQ(SolverQueryCache::getStatistics().solverCalls - before, 1U);
+    // Fetched models are kept.
+    EXPECT_EQ(check({barIsTwo, fooIsOne}, true), 0U);
+    EXPECT_EQ(valueOf(fooVar), 1);
+    EXPECT_EQ(valueOf(barVar), 2);
+    EXPECT_EQ(SolverQueryCache::getStatistics().solverCalls - before, 1U);
+}
+
+TEST_F(SolverQueryCacheTest, SolverPerComponent) {
+    P4Tools::Z3Solver querySolver;
+    size_t solversMade = 0;
+    P4Tools::SolverQueryCache slicedCache(true, [&solversMade]() {
+        ++solversMade;
+        return std::make_unique<P4Tools::Z3Solver>();
+    });
+    const auto *fooIsOne = equals(fooVar, 1);
+    const auto *barIsTwo = equals(barVar, 2);
+    EXPECT_EQ(slicedCache.checkSat(querySolver, {fooIsOne, barIsTwo}), true);
+    EXPECT_EQ(solversMade, 2U);
+    // Each component has a solver of its own, which still holds its model.
+    auto before = SolverQueryCache::getStatistics().solverCalls;
+    const auto &model = slicedCache.getSymbolicMapping();
+    EXPECT_EQ(model.at(fooVar)->checkedTo<IR::Constant>()->asInt(), 1);
+    EXPECT_EQ(model.at(barVar)->checkedTo<IR::Constant>()->asInt(), 2);
+    EXPECT_EQ(SolverQueryCache::getStatistics().solverCalls - before, 0U);
+    // A component that extends one of the last query goes to the same solver.
+    EXPECT_EQ(slicedCache.checkSat(querySolver, {fooIsOne, barIsTwo, equals(barVar, 3)}), false);
+    EXPECT_EQ(solversMade, 2U);
+}
+
+}  // namespace P4::P4Tools::Test
@@ -18,6 +18,7 @@
 #include "backends/p4tools/modules/testgen/core/program_info.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/depth_first.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/greedy_node_cov.h"
+#include "backends/p4tools/modules/testgen/core/symbolic_executor/parallel_search.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/path_selection.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/random_backtrack.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/selected_branches.h"
@@ -37,6 +38,11 @@ namespace {
 SymbolicExecutor *pickExecutionEngine(const TestgenOptions &testgenOptions,
                                       const ProgramInfo &programInfo, AbstractSolver &solver) {
     const auto &pathSelectionPolicy = testgenOptions.pathSelectionPolicy;
+    // Selected branches describe a single path, which is explored on the calling thread.
+    if (testgenOptions.numWorkers > 1 && testgenOptions.selectedBranches.empty()) {
+        return new ParallelSearch(solver, programInfo, pathSelectionPolicy,
+                                  testgenOptions.numWorkers);
+    }
     if (pathSelectionPolicy == PathSelectionPolicy::GreedyStmtCoverage) {
         return new GreedyNodeSelection(solver, programInfo);
     }
@@ -8,7 +8,6 @@ macro(p4c_obtain_bdwgc)
   set(HAVE_LIBGC 1)
 
   if(P4C_USE_PREINSTALLED_BDWGC)
-    option(ENABLE_MULTITHREAD "Use multithreading" OFF)
     find_package(LibGc 7.2.0 REQUIRED)
     check_function_exists (GC_print_stats HAVE_GC_PRINT_STATS)
   else()
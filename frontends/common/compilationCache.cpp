@@ -0,0 +1,363 @@
+#include "frontends/common/compilationCache.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+#include "lib/error.h"
+#include "lib/log.h"
+#include "lib/sha256.h"
+
+namespace P4 {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view manifestName = "manifest";
+constexpr std::string_view inputsName = "inputs";
+constexpr std::string_view statisticsName = "statistics";
+constexpr std::string_view lockName = "lock";
+constexpr std::string_view temporarySuffix = ".tmp";
+
+/// If @p arg is @p option, sets @p takesValue and returns true.  If it is @p option with its
+/// value attached by '=', sets @p value to that value and returns true.
+bool matchOption(std::string_view arg, std::string_view option, bool &takesValue,
+                 std::string_view &value) {
+    if (arg == option) {
+        takesValue = true;
+        return true;
+    }
+    if (arg.size() > option.size() && arg.substr(0, option.size()) == option &&
+        arg[option.size()] == '=') {
+        value = arg.substr(option.size() + 1);
+        return true;
+    }
+    return false;
+}
+
+/// Options that only control the cache or name output files; they are left out of the key.
+/// The outputs are restored to the files named by the current command line.
+bool isIgnoredOption(std::string_view arg, bool &takesValue) {
+    std::string_view value;
+    for (std::string_view option : {"--cache-dir", "--cache-max-size"}) {
+        if (matchOption(arg, option, takesValue, value)) return true;
+    }
+    if (arg.substr(0, 2) == "-o") {
+        takesValue = arg.size() == 2;
+        return true;
+    }
+    return arg == "--cache-stats" || arg == "--reuse-frontend";
+}
+
+/// Options naming P4Runtime output files, whose extensions select the format written.
+bool isP4RuntimeFileOption(std::string_view arg, bool &takesValue, std::string_view &value) {
+    for (std::string_view option : {"--p4runtime-file", "--p4runtime-files",
+                                    "--p4runtime-entries-file", "--p4runtime-entries-files"}) {
+        if (matchOption(arg, option, takesValue, value)) return true;
+    }
+    return false;
+}
+
+/// The extensions of the comma-separated file names in @p files, which stand for the files in
+/// the key: the outputs are restored to the files named by the current command line.
+std::string extensions(std::string_view files) {
+    std::string result;
+    while (true) {
+        auto comma = files.find(',');
+        result += fs::path(files.substr(0, comma)).extension().string();
+        if (comma == std::string_view::npos) break;
+        result += ',';
+        files.remove_prefix(comma + 1);
+    }
+    return result;
+}
+
+/// @p path made absolute, with symbolic links and dot components resolved as far as it exists.
+std::string normalPath(std::string_view path) {
+    std::error_code ec;
+    auto absolute = fs::absolute(path, ec);
+    if (ec) return std::string(path);
+    auto normal = fs::weakly_canonical(absolute, ec);
+    if (ec) normal = absolute.lexically_normal();
+    // Drops a trailing separator, which a trailing ".." leaves.
+    if (!normal.has_filename() && normal.has_relative_path()) normal = normal.parent_path();
+    return normal.string();
+}
+
+void addCommaSeparated(std::vector<fs::path> &outputs, cstring files) {
+    if (files.isNullOrEmpty()) return;
+    std::string_view rest = files.string_view();
+    while (!rest.empty()) {
+        auto comma = rest.find(',');
+        outputs.emplace_back(rest.substr(0, comma));
+        if (comma == std::string_view::npos) break;
+        rest.remove_prefix(comma + 1);
+    }
+}
+
+uintmax_t directorySize(const fs::path &dir) {
+    std::error_code ec;
+    uintmax_t size = 0;
+    for (const auto &file : fs::directory_iterator(dir, ec)) {
+        if (file.is_regular_file(ec)) size += file.file_size(ec);
+    }
+    return size;
+}
+
+}  // namespace
+
+CompilationCache::CompilationCache(CompilerOptions &options, std::vector<fs::path> outputs)
+    : options(options), outputs(std::move(outputs)) {
+    if (!options.p4RuntimeFile.isNullOrEmpty())
+        this->outputs.emplace_back(options.p4RuntimeFile.string_view());
+    if (!options.p4RuntimeEntriesFile.isNullOrEmpty())
+        this->outputs.emplace_back(options.p4RuntimeEntriesFile.string_view());
+    addCommaSeparated(this->outputs, options.p4RuntimeFiles);
+    addCommaSeparated(this->outputs, options.p4RuntimeEntriesFiles);
+    this->outputs.erase(std::remove_if(this->outputs.begin(), this->outputs.end(),
+                                       [](const fs::path &path) { return path.empty(); }),
+                        this->outputs.end());
+
+    active = !options.cacheDirectory.empty() && !options.doNotPreprocess &&
+             !options.doNotCompile && options.top4.empty() && options.dumpJsonFile.empty() &&
+             options.dumpBinaryFile.empty() && options.prettyPrintFile.empty();
+    if (!active) return;
+    std::error_code ec;
+    fs::create_directories(options.cacheDirectory, ec);
+    if (ec) {
+        ::P4::error(ErrorType::ERR_IO, "%1%: cannot create cache directory: %2%",
+                    options.cacheDirectory, ec.message());
+        active = false;
+    }
+}
+
+std::string CompilationCache::inputs(std::string_view source,
+                                     const std::vector<std::string> &arguments,
+                                     std::string_view version) {
+    // Arguments cannot contain a NUL, and the source comes last, so the parts are delimited.
+    std::string result = "p4c-cache";
+    result += '\0';
+    result += version;
+    result += '\0';
+    for (const auto &arg : arguments) {
+        result += arg;
+        result += '\0';
+    }
+    result += '\0';
+    result += source;
+    return result;
+}
+
+std::string CompilationCache::key(std::string_view source,
+                                  const std::vector<std::string> &arguments,
+                                  std::string_view version) {
+    return Util::sha256Hex(inputs(source, arguments, version));
+}
+
+std::vector<std::string> CompilationCache::keyArguments(const CompilerOptions &options) {
+    std::vector<std::string> arguments;
+    const auto &commandLine = options.commandLine;
+    for (size_t i = 0; i < commandLine.size(); ++i) {
+        const auto &arg = commandLine[i];
+        bool takesValue = false;
+        std::string_view value;
+        if (isIgnoredOption(arg, takesValue)) {
+            if (takesValue) ++i;
+            continue;
+        }
+        if (isP4RuntimeFileOption(arg, takesValue, value)) {
+            if (!takesValue) {
+                arguments.push_back(arg.substr(0, arg.size() - value.size()) + extensions(value));
+            } else if (i + 1 < commandLine.size()) {
+                arguments.push_back(arg);
+                arguments.push_back(extensions(commandLine[++i]));
+            }
+            continue;
+        }
+        if (arg == "-I" && i + 1 < commandLine.size()) {
+            arguments.push_back(arg);
+            arguments.push_back(normalPath(commandLine[++i]));
+        } else if (arg.size() > 2 && arg.substr(0, 2) == "-I") {
+            arguments.push_back("-I" + normalPath(std::string_view(arg).substr(2)));
+        } else if (!options.file.empty() && arg == options.file.string()) {
+            arguments.push_back(normalPath(arg));
+        } else {
+            arguments.push_back(arg);
+        }
+    }
+    return arguments;
+}
+
+bool CompilationCache::restore() {
+    if (!active) return false;
+
+    auto preprocessed = options.preprocess();
+    bool preprocessorStarted = preprocessed.has_value();
+    std::string source;
+    if (preprocessorStarted) {
+        char buffer[1 << 16];
+        size_t size;
+        while ((size = fread(buffer, 1, sizeof(buffer), preprocessed->get())) > 0)
+            source.append(buffer, size);
+        // Closing waits for the preprocessor and reports its failure.
+        preprocessed.reset();
+    }
+    if (::P4::errorCount() > 0 || !preprocessorStarted) {
+        // The errors are reported; parseP4File finds nothing to parse and stops.
+        options.preprocessedSource = std::string();
+        return false;
+    }
+
+    std::string version = options.exe_name.string() + " " + options.compilerVersion.string();
+    entryInputs = inputs(source, keyArguments(options), version);
+    entryKey = Util::sha256Hex(entryInputs);
+    options.preprocessedSource = std::move(source);
+
+    auto entry = options.cacheDirectory / *entryKey;
+    std::error_code ec;
+    if (hasInputs(entry, entryInputs)) {
+        std::ifstream manifest(entry / manifestName);
+        std::vector<bool> restored(outputs.size());
+        size_t index;
+        while (manifest >> index) {
+            if (index >= outputs.size()) break;
+            fs::copy_file(entry / std::to_string(index), outputs[index],
+                          fs::copy_options::overwrite_existing, ec);
+            if (ec) break;
+            restored[index] = true;
+        }
+        // An output the compilation that stored the entry did not write is not restored.
+        hit = manifest.is_open() && manifest.eof() && !ec &&
+              std::all_of(restored.begin(), restored.end(), [](bool r) { return r; });
+    }
+    if (hit) {
+        // Entries are evicted in order of last use.
+        fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+        LOG1("Compilation cache hit " << *entryKey);
+    } else {
+        LOG1("Compilation cache miss " << *entryKey);
+    }
+
+    auto stats = updateStatistics(hit ? +[](Statistics &s) { ++s.hits; }
+                                      : +[](Statistics &s) { ++s.misses; });
+    if (options.cacheStatistics)
+        std::cerr << "Compilation cache: " << stats.hits << " hits, " << stats.misses
+                  << " misses" << std::endl;
+    return hit;
+}
+
+void CompilationCache::store() {
+    if (!active || hit || !entryKey || ::P4::errorCount() > 0) return;
+
+    // Filled under a temporary name and renamed, so that concurrent compilations never see a
+    // partial entry.
+    std::error_code ec;
+    auto entry = options.cacheDirectory / *entryKey;
+    auto temporary = entry;
+    temporary += std::string(temporarySuffix) + "." + std::to_string(getpid());
+    fs::remove_all(temporary, ec);
+    if (!fs::create_directory(temporary, ec)) return;
+    {
+        if (!storeInputs(temporary, entryInputs)) {
+            fs::remove_all(temporary, ec);
+            return;
+        }
+        std::ofstream manifest(temporary / manifestName);
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            if (!fs::is_regular_file(outputs[i], ec)) continue;
+            if (!fs::copy_file(outputs[i], temporary / std::to_string(i), ec)) {
+                fs::remove_all(temporary, ec);
+                return;
+            }
+            manifest << i << '\n';
+        }
+    }
+    fs::rename(temporary, entry, ec);
+    // Fails if another compilation stored the same entry first.
+    if (ec) fs::remove_all(temporary, ec);
+    evict();
+}
+
+CompilationCache::Statistics CompilationCache::updateStatistics(
+    void (*update)(Statistics &)) const {
+    Statistics stats;
+    int lock = open((options.cacheDirectory / lockName).c_str(), O_RDWR | O_CREAT, 0644);
+    if (lock < 0) return stats;
+    flock(lock, LOCK_EX);
+    auto path = options.cacheDirectory / statisticsName;
+    {
+        std::ifstream in(path);
+        in >> stats.hits >> stats.misses;
+        if (!in) stats = Statistics();
+    }
+    if (update) {
+        update(stats);
+        std::ofstream out(path, std::ios::trunc);
+        out << stats.hits << ' ' << stats.misses << '\n';
+    }
+    flock(lock, LOCK_UN);
+    close(lock);
+    return stats;
+}
+
+bool CompilationCache::storeInputs(const fs::path &entry, std::string_view inputs) {
+    std::ofstream out(entry / inputsName, std::ios::binary);
+    out.write(inputs.data(), inputs.size());
+    return static_cast<bool>(out);
+}
+
+bool CompilationCache::hasInputs(const fs::path &entry, std::string_view inputs) {
+    std::error_code ec;
+    auto path = entry / inputsName;
+    if (fs::file_size(path, ec) != inputs.size() || ec) return false;
+    std::ifstream in(path, std::ios::binary);
+    std::string stored(inputs.size(), '\0');
+    in.read(stored.data(), stored.size());
+    if (!in || stored != inputs) {
+        LOG1("Cache entry " << entry << " was stored for other inputs");
+        return false;
+    }
+    return true;
+}
+
+CompilationCache::Statistics CompilationCache::statistics() const {
+    return updateStatistics(nullptr);
+}
+
+void CompilationCache::evict() const {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type lastUse;
+        uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (const auto &file : fs::directory_iterator(options.cacheDirectory, ec)) {
+        if (!file.is_directory(ec)) continue;
+        if (file.path().filename().string().find(temporarySuffix) != std::string::npos) continue;
+        auto size = directorySize(file.path());
+        entries.push_back({file.path(), file.last_write_time(ec), size});
+        total += size;
+    }
+    if (total <= options.cacheMaxSize) return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b) { return a.lastUse < b.lastUse; });
+    for (const auto &entry : entries) {
+        if (total <= options.cacheMaxSize) break;
+        LOG2("Compilation cache evicting " << entry.path);
+        fs::remove_all(entry.path, ec);
+        total -= entry.size;
+    }
+}
+
+}  // namespace P4
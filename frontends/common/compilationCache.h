@@ -0,0 +1,90 @@
+#ifndef FRONTENDS_COMMON_COMPILATIONCACHE_H_
+#define FRONTENDS_COMMON_COMPILATIONCACHE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frontends/common/options.h"
+
+namespace P4 {
+
+/// Outputs of earlier compilations, kept in the directory given with --cache-dir and keyed by
+/// the SHA-256 digest of the preprocessed program, the command line and the compiler version.
+/// Each entry also keeps these inputs, and is only used if they are equal to those of the
+/// current compilation.
+///
+/// A backend looks the program up before parsing it.  On a hit the cached artifacts are copied
+/// to the output files the command line asks for and there is nothing left to compile; on a
+/// miss the artifacts are stored once the compilation succeeds.  When the directory grows past
+/// --cache-max-size, the least recently used entries are evicted.
+///
+/// Diagnostics are not cached, so a hit compiles silently even if the original compilation
+/// printed warnings.
+class CompilationCache {
+ public:
+    struct Statistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    /// @p outputs are the backend's artifacts; the P4Runtime files requested in @p options are
+    /// added to them.  The cache is inactive without --cache-dir, and when the command line
+    /// asks for debugging output it does not know about (--top4, --toJSON, --toBinary, --pp).
+    CompilationCache(CompilerOptions &options, std::vector<std::filesystem::path> outputs);
+
+    bool isActive() const { return active; }
+
+    /// Preprocesses the program and looks it up.  On a hit, which needs a stored copy of every
+    /// output, restores the outputs and returns true.  On a miss, the preprocessed program is left in the options for parseP4File.
+    bool restore();
+
+    /// Saves the outputs under the key computed by restore().  Does nothing after a hit, or if
+    /// errors were reported.
+    void store();
+
+    /// The counters kept in the cache directory, shared by all compilations that use it.
+    Statistics statistics() const;
+
+    /// The inputs of a compilation that a key is computed from: @p source, the arguments that
+    /// can affect the outputs, and @p version, delimited from one another.
+    static std::string inputs(std::string_view source, const std::vector<std::string> &arguments,
+                              std::string_view version);
+
+    /// Key for a program: hex digits of the SHA-256 digest of its inputs().
+    static std::string key(std::string_view source, const std::vector<std::string> &arguments,
+                           std::string_view version);
+
+    /// The arguments of the command line in @p options that can affect the outputs: all but
+    /// the options controlling the cache itself and -o.  The P4Runtime output files are
+    /// replaced by their extensions, which choose the format they are written in.  The paths of
+    /// the program and of include directories are made absolute and normal, so that the same
+    /// files named differently give the same arguments.
+    static std::vector<std::string> keyArguments(const CompilerOptions &options);
+
+    /// Writes @p inputs into the cache entry directory @p entry.  @return false on failure.
+    static bool storeInputs(const std::filesystem::path &entry, std::string_view inputs);
+    /// True if the cache entry directory @p entry was stored for @p inputs by storeInputs().
+    static bool hasInputs(const std::filesystem::path &entry, std::string_view inputs);
+
+ private:
+    CompilerOptions &options;
+    std::vector<std::filesystem::path> outputs;
+    bool active = false;
+    bool hit = false;
+    std::optional<std::string> entryKey;
+    /// The inputs() that entryKey is the digest of.
+    std::string entryInputs;
+
+    /// Runs @p update (if any) on the counters while holding the lock on the cache directory
+    /// and returns their new values.
+    Statistics updateStatistics(void (*update)(Statistics &)) const;
+    void evict() const;
+};
+
+}  // namespace P4
+
+#endif /* FRONTENDS_COMMON_COMPILATIONCACHE_H_ */
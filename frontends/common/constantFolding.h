@@ -123,6 +123,7 @@ class DoConstantFolding : public Transform, public ResolutionContext {
           typesKnown(typeMap != nullptr),
           warnings(warnings) {
         visitDagOnce = true;
+        cloneOnWrite = true;
         setName("DoConstantFolding");
         assignmentTarget = false;
     }
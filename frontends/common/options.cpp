@@ -59,6 +59,13 @@ CompilerOptions::CompilerOptions(std::string_view defaultMessage) : ParserOption
             return true;
         },
         "Dump the compiler IR after the midend as JSON in the specified file.");
+    registerOption(
+        "--toBinary", "file",
+        [this](const char *arg) {
+            dumpBinaryFile = arg;
+            return true;
+        },
+        "Dump the compiler IR after the midend in the binary IR format in the specified file.");
     registerOption(
         "--ndebug", nullptr,
         [this](const char *) {
@@ -155,6 +162,17 @@ CompilerOptions::CompilerOptions(std::string_view defaultMessage) : ParserOption
             return true;
         },
         "Unrolling all parser's loops");
+    registerOption(
+        "--parser-unroll-budget", "states",
+        [this](const char *arg) {
+            char *end = nullptr;
+            auto states = strtoull(arg, &end, 10);
+            if (end == arg || *end != 0) return false;
+            parserUnrollBudget = static_cast<size_t>(states);
+            return true;
+        },
+        "Leave a parser as is, with a warning, if unrolling its loops evaluates\n"
+        "more than this many states (default 0, no limit).");
     registerOption(
         "-O", nullptr,
         [this](const char *level) {
@@ -174,6 +192,61 @@ CompilerOptions::CompilerOptions(std::string_view defaultMessage) : ParserOption
             return *level == 0;
         },
         "Optimization level");
+    registerOption(
+        "--cache-dir", "dir",
+        [this](const char *arg) {
+            cacheDirectory = arg;
+            return true;
+        },
+        "Reuse the outputs of identical earlier compilations, and the parsed standard\n"
+        "include files of earlier compilations, kept in this directory.");
+    registerOption(
+        "--cache-max-size", "MB",
+        [this](const char *arg) {
+            char *end = nullptr;
+            auto size = strtoull(arg, &end, 10);
+            if (end == arg || *end != 0) return false;
+            cacheMaxSize = static_cast<uintmax_t>(size) << 20;
+            return true;
+        },
+        "Evict the least recently used compilation cache entries once the cache\n"
+        "directory grows past this size (default 1024).");
+    registerOption(
+        "--cache-stats", nullptr,
+        [this](const char *) {
+            cacheStatistics = true;
+            return true;
+        },
+        "Print the hit and miss counts of the compilation cache.");
+    registerOption(
+        "--reuse-frontend", nullptr,
+        [this](const char *) {
+            reuseFrontEnd = true;
+            return true;
+        },
+        "Keep the frontend result in the --cache-dir directory and reuse it for the whole\n"
+        "program when the text of every top-level declaration is unchanged; any other\n"
+        "change runs the whole frontend again.");
+    registerOption(
+        "--incremental-typemap", nullptr,
+        [this](const char *) {
+            incrementalTypeMap = true;
+            return true;
+        },
+        "Keep the types of the top-level declarations that a frontend pass did not\n"
+        "change, and type-check only the changed declarations and their users.");
+    registerOption(
+        "--parallel-jobs", "jobs",
+        [this](const char *arg) {
+            char *end = nullptr;
+            auto jobs = strtoul(arg, &end, 10);
+            if (end == arg || *end != 0 || jobs == 0) return false;
+            parallelJobs = static_cast<unsigned>(jobs);
+            return true;
+        },
+        "Apply the frontend passes that only look inside one top-level declaration\n"
+        "to the declarations on this many threads (default 1).  Only builds with\n"
+        "ENABLE_MULTITHREAD use threads.");
 }
 
 bool CompilerOptions::enable_intrinsic_metadata_fix() { return true; }
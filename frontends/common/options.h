@@ -56,6 +56,8 @@ class CompilerOptions : public ParserOptions {
     std::vector<cstring> passesToExcludeBackend;
     // Dump a JSON representation of the IR in the file.
     std::filesystem::path dumpJsonFile;
+    // Dump the IR in the binary format of ir/binary_writer.h in the file.
+    std::filesystem::path dumpBinaryFile;
     // Dump and undump the IR tree.
     bool debugJson = false;
     // if this flag is true, compile program in non-debug mode.
@@ -80,6 +82,19 @@ class CompilerOptions : public ParserOptions {
     cstring arch = nullptr;
     // If true, unroll all parser loops inside the midend.
     bool loopsUnrolling = false;
+    // Number of parser states evaluated before parser unrolling gives up on a parser, or 0
+    // for no limit.
+    size_t parserUnrollBudget = 0;
+    // Size of the cache directory past which its least recently used entries are evicted.
+    uintmax_t cacheMaxSize = uintmax_t(1) << 30;
+    // Print the hit and miss counts of the compilation cache.
+    bool cacheStatistics = false;
+    // Reuse the frontend result of the previous compilation of the program, see FrontEndSnapshot.
+    bool reuseFrontEnd = false;
+    // Keep the frontend TypeMap across passes that change the program, see TypeMap::update.
+    bool incrementalTypeMap = false;
+    // Number of threads applying the DeclarationLocal frontend passes, see PassManager.
+    unsigned parallelJobs = 1;
 
     // General optimization options -- can be interpreted by backends in various ways
     int optimizationLevel = 1;
@@ -48,4 +48,18 @@ const IR::P4Program *parseP4String(const std::string &input,
     return parseP4String("(string)", 1, input, version);
 }
 
+const IR::P4Program *parseP4WithCachedIncludes(const ParserOptions &options,
+                                               std::string_view source) {
+    std::string version = options.exe_name.string() + " " + options.compilerVersion.string();
+    return P4ParserDriver::parseWithCachedIncludes(source, options.file.string(),
+                                                   options.cacheDirectory, version);
+}
+
+const IR::P4Program *parseP4WithCachedIncludes(const ParserOptions &options, FILE *in) {
+    std::string source;
+    char buffer[1 << 16];
+    while (size_t size = fread(buffer, 1, sizeof(buffer), in)) source.append(buffer, size);
+    return parseP4WithCachedIncludes(options, source);
+}
+
 }  // namespace P4
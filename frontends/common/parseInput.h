@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef FRONTENDS_COMMON_PARSEINPUT_H_
 #define FRONTENDS_COMMON_PARSEINPUT_H_
 
+#include <sstream>
+
 #include "frontends/common/options.h"
 #include "frontends/common/parser_options.h"
 #include "frontends/p4-14/fromv1.0/converters.h"
@@ -51,6 +53,12 @@ static const IR::P4Program *parseV1Program(Input stream, std::string_view source
     return v1->to<IR::P4Program>();
 }
 
+/// Parses the preprocessed P4-16 program @p source, taking the standard include files it
+/// starts with from the --cache-dir directory, see P4ParserDriver::parseWithCachedIncludes.
+const IR::P4Program *parseP4WithCachedIncludes(const ParserOptions &options,
+                                               std::string_view source);
+const IR::P4Program *parseP4WithCachedIncludes(const ParserOptions &options, FILE *in);
+
 /**
  * Parse P4 source from a file. The filename and language version are specified
  * by @options. If the language version is not P4-16, then the program is
@@ -76,17 +84,28 @@ const IR::P4Program *parseP4File(const ParserOptions &options) {
                                                             options.getDebugHook())
                                 : P4ParserDriver::parse(file, options.file.string());
         fclose(file);
+    } else if (options.preprocessedSource) {
+        // Already preprocessed by the compilation cache.
+        if (options.isv1()) {
+            std::istringstream stream(*options.preprocessedSource);
+            result = parseV1Program<std::istream &, C>(stream, options.file.string(), 1,
+                                                       options.getDebugHook());
+        } else {
+            result = parseP4WithCachedIncludes(options, *options.preprocessedSource);
+        }
     } else {
         auto preprocessorResult = options.preprocess();
         if (::P4::errorCount() > 0 || !preprocessorResult.has_value()) {
             return nullptr;
         }
         // Need to assign file here because the parser requires an lvalue.
-        result =
-            options.isv1()
-                ? parseV1Program<FILE *, C>(preprocessorResult.value().get(), options.file.string(),
-                                            1, options.getDebugHook())
-                : P4ParserDriver::parse(preprocessorResult.value().get(), options.file.string());
+        if (options.isv1())
+            result = parseV1Program<FILE *, C>(preprocessorResult.value().get(),
+                                               options.file.string(), 1, options.getDebugHook());
+        else if (!options.cacheDirectory.empty())
+            result = parseP4WithCachedIncludes(options, preprocessorResult.value().get());
+        else
+            result = P4ParserDriver::parse(preprocessorResult.value().get(), options.file.string());
     }
 
     if (::P4::errorCount() > 0) {
@@ -30,7 +30,9 @@ limitations under the License.
 
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_format.h"
+#include "frontends/common/preprocessor.h"
 #include "frontends/p4/toP4/toP4.h"
+#include "ir/pass_profile.h"
 #include "lib/exceptions.h"
 #include "lib/exename.h"
 #include "lib/log.h"
@@ -51,6 +53,11 @@ using namespace P4::literals;
 
 bool isSystemFile(cstring file) { return file.startsWith(p4includePath); }
 
+/// Closes the output of the builtin preprocessor.
+static void closeMemoryFile(FILE *file) {
+    if (file != nullptr) fclose(file);
+}
+
 void ParserOptions::closeFile(FILE *file) {
     if (file == nullptr) {
         return;
@@ -199,6 +206,14 @@ ParserOptions::ParserOptions(std::string_view defaultMessage) : Util::Options(de
             return true;
         },
         "Skip preprocess, assume input file is already preprocessed.");
+    registerOption(
+        "--builtin-preprocessor", nullptr,
+        [this](const char *) {
+            builtinPreprocessor = true;
+            return true;
+        },
+        "Preprocess in the compiler instead of running cpp, unless the program uses\n"
+        "preprocessor features other than #include, #define of constants, #if and #line.");
     registerOption(
         "--disable-annotations", "annotations",
         [this](const char *arg) {
@@ -314,6 +329,14 @@ ParserOptions::ParserOptions(std::string_view defaultMessage) : Util::Options(de
             return true;
         },
         "[Compiler debugging] Folder where P4 programs are dumped\n");
+    registerOption(
+        "--pass-profile", "file",
+        [](const char *arg) {
+            PassProfile::enable(arg);
+            return true;
+        },
+        "[Compiler debugging] Write the time, allocated memory and IR node counts\n"
+        "of every pass to this file, as a Chrome trace with a per-pass summary.\n");
     registerOption(
         "--parser-inline-opt", nullptr,
         [this](const char *) {
@@ -372,6 +395,7 @@ bool ParserOptions::searchForIncludePath(const char *&includePathOut,
 }
 
 std::vector<const char *> *ParserOptions::process(int argc, char *const argv[]) {
+    commandLine.assign(argv + 1, argv + argc);
     auto executablePath = getExecutablePath(argv[0]);
     if (executablePath.empty()) {
         std::cerr << "Could not determine executable path" << std::endl;
@@ -405,11 +429,39 @@ const char *ParserOptions::getIncludePath() const {
     return path.c_str();
 }
 
+std::optional<std::string> ParserOptions::preprocessInProcess() const {
+    std::vector<std::filesystem::path> systemPaths{isv1() ? p4_14includePath : p4includePath};
+    if (!isv1()) systemPaths.push_back(std::filesystem::path(p4includePath) / "bmv2");
+    Preprocessor preprocessor({}, std::move(systemPaths));
+    if (!preprocessor.addOptions(preprocessor_options.string_view()) ||
+        !preprocessor.addOptions(getIncludePath()))
+        return std::nullopt;
+    return preprocessor.run(file);
+}
+
 std::optional<ParserOptions::PreprocessorResult> ParserOptions::preprocess() const {
     FILE *in = nullptr;
 
+    std::optional<std::string> source;
+    if (builtinPreprocessor && file != "-") source = preprocessInProcess();
+
     if (file == "-") {
         in = stdin;
+    } else if (source) {
+        if (Log::verbose()) std::cerr << "Preprocessed " << file << " in process" << std::endl;
+        if (doNotCompile) {
+            fwrite(source->data(), 1, source->size(), stdout);
+            return std::nullopt;
+        }
+        // The stream owns a buffer of the given size, freed when it is closed.
+        in = fmemopen(nullptr, source->size() + 1, "w+");
+        if (in == nullptr) {
+            ::P4::error(ErrorType::ERR_IO, "Error buffering the preprocessed program");
+            return std::nullopt;
+        }
+        fwrite(source->data(), 1, source->size(), in);
+        rewind(in);
+        return ParserOptions::PreprocessorResult(in, &closeMemoryFile);
     } else {
 #ifdef __clang__
         std::string cmd("cc -E -x c -Wno-comment");
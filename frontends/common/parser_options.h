@@ -21,7 +21,10 @@ limitations under the License.
 
 #include <cstdio>
 #include <filesystem>
+#include <optional>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "ir/configuration.h"
 #include "ir/pass_manager.h"
@@ -86,6 +89,8 @@ class ParserOptions : public Util::Options {
     cstring compilerVersion;
     /// if true skip preprocess
     bool doNotPreprocess = false;
+    /// if true preprocess in the compiler process when possible, see Preprocessor
+    bool builtinPreprocessor = false;
     /// substrings matched against pass names
     std::vector<cstring> top4;
     /// debugging dumps of programs written in this folder
@@ -98,6 +103,9 @@ class ParserOptions : public Util::Options {
     const char *getIncludePath() const override;
     /// Returns the output of the preprocessor.
     std::optional<ParserOptions::PreprocessorResult> preprocess() const;
+    /// Returns the output of the builtin preprocessor, or std::nullopt if the program needs
+    /// the external one.
+    std::optional<std::string> preprocessInProcess() const;
     /// True if we are compiling a P4 v1.0 or v1.1 program
     bool isv1() const;
     /// Get a debug hook function suitable for insertion in the pass managers. The hook is
@@ -113,6 +121,13 @@ class ParserOptions : public Util::Options {
     /// If true do not generate #include statements.
     /// Used for debugging.
     bool noIncludes = false;
+    /// Arguments given to process(), without the executable name.
+    std::vector<std::string> commandLine;
+    /// The output of the preprocessor, when it was already read (see CompilationCache).
+    std::optional<std::string> preprocessedSource;
+    /// Directory holding the outputs of earlier compilations, see CompilationCache, and the
+    /// parsed standard include files, see ParsedIncludes.
+    std::filesystem::path cacheDirectory;
 };
 
 /// A compilation context which exposes compiler options and a compiler
@@ -0,0 +1,857 @@
+#include "frontends/common/preprocessor.h"
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+#include <unordered_map>
+
+#include "lib/log.h"
+
+namespace P4 {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// Includes nested deeper than this are taken for a recursion, which cpp reports.
+constexpr unsigned maxIncludeDepth = 200;
+
+/// Macros cpp defines even with -undef.  A program that uses them is preprocessed externally.
+constexpr std::string_view predefinedMacros[] = {
+    "__DATE__",          "__TIME__",         "__TIMESTAMP__",   "__STDC__",
+    "__STDC_VERSION__",  "__STDC_HOSTED__",  "__ASSEMBLER__",   "__COUNTER__",
+    "__INCLUDE_LEVEL__", "__BASE_FILE__",    "__FILE_NAME__",   "__has_include",
+    "__has_include_next"};
+
+bool isPredefined(std::string_view name) {
+    if (name.size() < 2 || name[0] != '_' || name[1] != '_') return false;
+    for (auto predefined : predefinedMacros)
+        if (name == predefined) return true;
+    return false;
+}
+
+bool isIdentifierStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+bool isIdentifierChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+std::string_view identifier(std::string_view text, size_t &pos) {
+    size_t start = pos;
+    if (pos < text.size() && isIdentifierStart(text[pos]))
+        while (pos < text.size() && isIdentifierChar(text[pos])) ++pos;
+    return text.substr(start, pos - start);
+}
+
+void skipSpaces(std::string_view text, size_t &pos) {
+    while (pos < text.size() && isSpace(text[pos])) ++pos;
+}
+
+/// Skips the string literal starting at @p pos; stops at the end of the line if it is not
+/// terminated.
+void skipString(std::string_view text, size_t &pos) {
+    for (++pos; pos < text.size(); ++pos) {
+        if (text[pos] == '\\') {
+            ++pos;
+        } else if (text[pos] == '"') {
+            ++pos;
+            return;
+        }
+    }
+}
+
+/// Skips a preprocessing number, which may have letters in it as in 8w0xff.
+void skipNumber(std::string_view text, size_t &pos) {
+    while (pos < text.size()) {
+        char c = text[pos];
+        if ((c == '+' || c == '-') && pos > 0 && std::strchr("eEpP", text[pos - 1])) {
+            ++pos;
+        } else if (isIdentifierChar(c) || c == '.') {
+            ++pos;
+        } else {
+            break;
+        }
+    }
+}
+
+/// Updates @p inComment for the text of a line.
+void scanComments(std::string_view text, bool &inComment) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (inComment) {
+            if (text.compare(pos, 2, "*/") == 0) {
+                inComment = false;
+                pos += 2;
+            } else {
+                ++pos;
+            }
+        } else if (text[pos] == '"') {
+            skipString(text, pos);
+        } else if (text.compare(pos, 2, "//") == 0) {
+            return;
+        } else if (text.compare(pos, 2, "/*") == 0) {
+            inComment = true;
+            pos += 2;
+        } else {
+            ++pos;
+        }
+    }
+}
+
+/// The text of a directive without its comments, or std::nullopt if a comment in it
+/// continues on the next line.
+std::optional<std::string> stripComments(std::string_view text) {
+    std::string result;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (text[pos] == '"') {
+            size_t start = pos;
+            skipString(text, pos);
+            result.append(text.substr(start, pos - start));
+        } else if (text.compare(pos, 2, "//") == 0) {
+            break;
+        } else if (text.compare(pos, 2, "/*") == 0) {
+            auto end = text.find("*/", pos + 2);
+            if (end == std::string_view::npos) return std::nullopt;
+            result += ' ';
+            pos = end + 2;
+        } else {
+            result += text[pos++];
+        }
+    }
+    return result;
+}
+
+/// True if @p a followed by @p b could be read as one token, so that an expansion between
+/// them needs a space as cpp puts there.
+bool couldPaste(char a, char b) {
+    if (isIdentifierChar(a) && isIdentifierChar(b)) return true;
+    constexpr std::string_view operators = "+-*/%<>=!&|^.:#";
+    return operators.find(a) != std::string_view::npos &&
+           operators.find(b) != std::string_view::npos;
+}
+
+/// A value of an #if expression: as in cpp, an intmax_t or a uintmax_t.
+struct Value {
+    uint64_t bits = 0;
+    bool isUnsigned = false;
+
+    static Value of(bool b) { return {b, false}; }
+    int64_t signedValue() const { return static_cast<int64_t>(bits); }
+    bool isNegative() const { return !isUnsigned && signedValue() < 0; }
+    explicit operator bool() const { return bits != 0; }
+};
+
+/// Evaluates the expression of an #if once macros are expanded and `defined` is replaced.
+/// Arithmetic follows cpp: an operation is unsigned if either operand is, and signed values
+/// wrap around.
+class ConditionEvaluator {
+    std::string_view text;
+    size_t pos = 0;
+
+    void skip() { skipSpaces(text, pos); }
+    bool accept(std::string_view op) {
+        skip();
+        if (text.compare(pos, op.size(), op) != 0) return false;
+        // Don't take the first character of a longer operator.
+        if (op.size() == 1 && pos + 1 < text.size()) {
+            char next = text[pos + 1];
+            if ((op == "&" && next == '&') || (op == "|" && next == '|') ||
+                (op == "<" && (next == '<' || next == '=')) ||
+                (op == ">" && (next == '>' || next == '=')) || (op == "!" && next == '='))
+                return false;
+        }
+        pos += op.size();
+        return true;
+    }
+
+    /// The value of @p bits with the type of an operation on @p left and @p right.
+    static Value result(uint64_t bits, Value left, Value right) {
+        return {bits, left.isUnsigned || right.isUnsigned};
+    }
+    /// True if @p left is less than @p right, compared as an operation on both.
+    static bool less(Value left, Value right) {
+        if (left.isUnsigned || right.isUnsigned) return left.bits < right.bits;
+        return left.signedValue() < right.signedValue();
+    }
+    /// @p value shifted by @p count, to the left if @p left is set.  As in cpp, a negative
+    /// count shifts the other way, and the result has the type of @p value.
+    static Value shifted(Value value, Value count, bool left) {
+        if (count.isNegative()) {
+            left = !left;
+            count.bits = -count.bits;
+        }
+        if (count.bits >= 64)
+            return {!left && value.isNegative() ? ~uint64_t(0) : 0, value.isUnsigned};
+        if (left) return {value.bits << count.bits, value.isUnsigned};
+        if (value.isNegative()) return {~(~value.bits >> count.bits), false};
+        return {value.bits >> count.bits, value.isUnsigned};
+    }
+
+    Value conditional() {
+        auto value = logicalOr();
+        if (!accept("?")) return value;
+        auto first = conditional();
+        if (!accept(":")) failed = true;
+        auto second = conditional();
+        return result(value ? first.bits : second.bits, first, second);
+    }
+    Value logicalOr() {
+        auto value = logicalAnd();
+        while (accept("||")) {
+            auto right = logicalAnd();
+            value = Value::of(value || right);
+        }
+        return value;
+    }
+    Value logicalAnd() {
+        auto value = bitOr();
+        while (accept("&&")) {
+            auto right = bitOr();
+            value = Value::of(value && right);
+        }
+        return value;
+    }
+    Value bitOr() {
+        auto value = bitXor();
+        while (accept("|")) {
+            auto right = bitXor();
+            value = result(value.bits | right.bits, value, right);
+        }
+        return value;
+    }
+    Value bitXor() {
+        auto value = bitAnd();
+        while (accept("^")) {
+            auto right = bitAnd();
+            value = result(value.bits ^ right.bits, value, right);
+        }
+        return value;
+    }
+    Value bitAnd() {
+        auto value = equality();
+        while (accept("&")) {
+            auto right = equality();
+            value = result(value.bits & right.bits, value, right);
+        }
+        return value;
+    }
+    Value equality() {
+        auto value = relational();
+        while (true) {
+            if (accept("==")) {
+                value = Value::of(value.bits == relational().bits);
+            } else if (accept("!=")) {
+                value = Value::of(value.bits != relational().bits);
+            } else {
+                return value;
+            }
+        }
+    }
+    Value relational() {
+        auto value = shift();
+        while (true) {
+            if (accept("<=")) {
+                value = Value::of(!less(shift(), value));
+            } else if (accept(">=")) {
+                value = Value::of(!less(value, shift()));
+            } else if (accept("<")) {
+                value = Value::of(less(value, shift()));
+            } else if (accept(">")) {
+                value = Value::of(less(shift(), value));
+            } else {
+                return value;
+            }
+        }
+    }
+    Value shift() {
+        auto value = additive();
+        while (true) {
+            if (accept("<<")) {
+                value = shifted(value, additive(), true);
+            } else if (accept(">>")) {
+                value = shifted(value, additive(), false);
+            } else {
+                return value;
+            }
+        }
+    }
+    Value additive() {
+        auto value = multiplicative();
+        while (true) {
+            if (accept("+")) {
+                auto right = multiplicative();
+                value = result(value.bits + right.bits, value, right);
+            } else if (accept("-")) {
+                auto right = multiplicative();
+                value = result(value.bits - right.bits, value, right);
+            } else {
+                return value;
+            }
+        }
+    }
+    Value multiplicative() {
+        auto value = unary();
+        while (true) {
+            if (accept("*")) {
+                auto right = unary();
+                value = result(value.bits * right.bits, value, right);
+                continue;
+            }
+            bool divide = accept("/");
+            if (!divide && !accept("%")) return value;
+            auto right = unary();
+            if (right.bits == 0) {
+                failed = true;
+                return {};
+            }
+            if (value.isUnsigned || right.isUnsigned) {
+                value = result(divide ? value.bits / right.bits : value.bits % right.bits, value,
+                               right);
+            } else if (right.signedValue() == -1) {
+                // Also for INTMAX_MIN, which cpp wraps around as well.
+                value.bits = divide ? -value.bits : 0;
+            } else {
+                auto quotient = value.signedValue() / right.signedValue();
+                auto remainder = value.signedValue() % right.signedValue();
+                value.bits = static_cast<uint64_t>(divide ? quotient : remainder);
+            }
+        }
+    }
+    Value unary() {
+        if (accept("!")) return Value::of(!unary());
+        if (accept("~")) {
+            auto value = unary();
+            return {~value.bits, value.isUnsigned};
+        }
+        if (accept("-")) {
+            auto value = unary();
+            return {-value.bits, value.isUnsigned};
+        }
+        if (accept("+")) return unary();
+        return primary();
+    }
+    Value primary() {
+        skip();
+        if (accept("(")) {
+            auto value = conditional();
+            if (!accept(")")) failed = true;
+            return value;
+        }
+        if (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            size_t start = pos;
+            skipNumber(text, pos);
+            std::string number(text.substr(start, pos - start));
+            char *end = nullptr;
+            errno = 0;
+            Value value{std::strtoull(number.c_str(), &end, 0), false};
+            if (errno == ERANGE) failed = true;
+            for (; *end; ++end) {
+                if (*end == 'u' || *end == 'U')
+                    value.isUnsigned = true;
+                else if (*end != 'l' && *end != 'L')
+                    failed = true;
+            }
+            // Too large for intmax_t: cpp takes it as unsigned, and warns.
+            if (value.isNegative()) value.isUnsigned = true;
+            return value;
+        }
+        if (pos < text.size() && isIdentifierStart(text[pos])) {
+            // Identifiers left after expansion are 0.
+            identifier(text, pos);
+            return {};
+        }
+        failed = true;
+        return {};
+    }
+
+ public:
+    bool failed = false;
+    explicit ConditionEvaluator(std::string_view text) : text(text) {}
+    bool evaluate() {
+        auto value = conditional();
+        skip();
+        if (pos != text.size()) failed = true;
+        return bool(value);
+    }
+};
+
+/// The scanned standard headers, shared by the compilations of one process.
+struct SystemFileCache {
+    struct Entry {
+        fs::file_time_type time;
+        uintmax_t size;
+        std::shared_ptr<const Preprocessor::Lines> lines;
+    };
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::atomic<uint64_t> scanned{0};
+
+    static SystemFileCache &get() {
+        static SystemFileCache cache;
+        return cache;
+    }
+};
+
+std::optional<std::string> readFile(const fs::path &file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return std::nullopt;
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+}  // namespace
+
+Preprocessor::Preprocessor(std::vector<fs::path> includePaths, std::vector<fs::path> systemPaths)
+    : includePaths(std::move(includePaths)), systemPaths(std::move(systemPaths)) {}
+
+bool Preprocessor::define(std::string_view definition) {
+    auto equals = definition.find('=');
+    auto name = definition.substr(0, equals);
+    size_t pos = 0;
+    if (identifier(name, pos).size() != name.size() || name.empty() || name == "defined")
+        return false;
+    std::string body = equals == std::string_view::npos
+                           ? std::string("1")
+                           : std::string(trim(definition.substr(equals + 1)));
+    if (body.find("##") != std::string::npos) return false;
+    macros[std::string(name)] = std::move(body);
+    return true;
+}
+
+void Preprocessor::undefine(std::string_view name) {
+    auto it = macros.find(name);
+    if (it != macros.end()) macros.erase(it);
+}
+
+bool Preprocessor::addOptions(std::string_view options) {
+    std::istringstream words{std::string(options)};
+    std::string word;
+    while (words >> word) {
+        std::string_view option = word;
+        if (option.size() < 2 || option[0] != '-') return false;
+        auto argument = option.substr(2);
+        switch (option[1]) {
+            case 'I': {
+                fs::path path(argument);
+                bool known = false;
+                for (const auto &system : systemPaths) known |= system == path;
+                if (!known) includePaths.push_back(path);
+                break;
+            }
+            case 'D':
+                if (!define(argument)) return false;
+                break;
+            case 'U':
+                undefine(argument);
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+uint64_t Preprocessor::systemFilesScanned() { return SystemFileCache::get().scanned; }
+
+Preprocessor::Lines Preprocessor::scan(std::string_view source) {
+    Lines lines;
+    bool inComment = false;
+    size_t pos = 0;
+    while (pos < source.size()) {
+        auto end = source.find('\n', pos);
+        if (end == std::string_view::npos) end = source.size();
+        Line line;
+        line.inComment = inComment;
+        line.text = std::string(source.substr(pos, end - pos));
+        pos = end + 1;
+        // Join the continuation lines, anywhere as cpp does.
+        if (!line.text.empty() && line.text.back() == '\r') line.text.pop_back();
+        while (!line.text.empty() && line.text.back() == '\\' && pos < source.size()) {
+            line.text.pop_back();
+            end = source.find('\n', pos);
+            if (end == std::string_view::npos) end = source.size();
+            line.text.append(source.substr(pos, end - pos));
+            if (!line.text.empty() && line.text.back() == '\r') line.text.pop_back();
+            pos = end + 1;
+            ++line.physical;
+        }
+        size_t first = 0;
+        skipSpaces(line.text, first);
+        line.directive = !inComment && first < line.text.size() && line.text[first] == '#';
+        scanComments(line.text, inComment);
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+bool Preprocessor::isSystem(const fs::path &file) const {
+    auto name = file.lexically_normal().string();
+    for (const auto &system : systemPaths) {
+        auto prefix = system.lexically_normal().string();
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            (prefix.back() == '/' || name[prefix.size()] == '/'))
+            return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const Preprocessor::Lines> Preprocessor::load(const fs::path &file, bool system) {
+    if (!system) {
+        auto contents = readFile(file);
+        if (!contents) return nullptr;
+        return std::make_shared<const Lines>(scan(*contents));
+    }
+
+    auto &cache = SystemFileCache::get();
+    std::error_code ec;
+    auto time = fs::last_write_time(file, ec);
+    if (ec) return nullptr;
+    auto size = fs::file_size(file, ec);
+    if (ec) return nullptr;
+    auto key = fs::absolute(file, ec).lexically_normal().string();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.entries.find(key);
+        if (it != cache.entries.end() && it->second.time == time && it->second.size == size)
+            return it->second.lines;
+    }
+    auto contents = readFile(file);
+    if (!contents) return nullptr;
+    auto lines = std::make_shared<const Lines>(scan(*contents));
+    ++cache.scanned;
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.entries[key] = {time, size, lines};
+    return lines;
+}
+
+std::optional<fs::path> Preprocessor::findInclude(std::string_view name, bool quoted,
+                                                  const fs::path &from) const {
+    std::error_code ec;
+    fs::path path(name);
+    if (path.is_absolute()) {
+        if (fs::is_regular_file(path, ec)) return path;
+        return std::nullopt;
+    }
+    if (quoted) {
+        auto candidate = from.parent_path() / path;
+        if (fs::is_regular_file(candidate, ec)) return candidate;
+    }
+    for (const auto *paths : {&includePaths, &systemPaths}) {
+        for (const auto &dir : *paths) {
+            auto candidate = dir / path;
+            if (fs::is_regular_file(candidate, ec)) return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+void Preprocessor::lineMarker(long line, std::string_view name, const char *flag) {
+    output += "# ";
+    output += std::to_string(line);
+    output += " \"";
+    output += name;
+    output += '"';
+    if (flag) {
+        output += ' ';
+        output += flag;
+    }
+    output += '\n';
+}
+
+std::optional<std::string> Preprocessor::run(const fs::path &file) {
+    output.clear();
+    depth = 0;
+    unsupported = false;
+    process(file);
+    if (unsupported) {
+        LOG2("Preprocessing " << file << " externally");
+        return std::nullopt;
+    }
+    return std::move(output);
+}
+
+void Preprocessor::process(const fs::path &file) {
+    auto lines = load(file, isSystem(file));
+    if (lines == nullptr || ++depth > maxIncludeDepth) {
+        unsupported = true;
+        return;
+    }
+    Source source;
+    source.path = file;
+    source.name = file.string();
+    lineMarker(1, source.name, depth > 1 ? "1" : nullptr);
+
+    std::set<std::string, std::less<>> expanding;
+    unsigned number = 1;
+    for (const auto &line : *lines) {
+        if (unsupported) return;
+        auto resume = Resume::Newlines;
+        if (line.directive) {
+            resume = directive(line.text, source, number, line.physical);
+        } else if (source.active()) {
+            bool inComment = line.inComment;
+            output += expand(line.text, inComment, source, number, expanding);
+        }
+        number += line.physical;
+        if (resume == Resume::Newlines)
+            output.append(line.physical, '\n');
+        else
+            lineMarker(number + source.delta, source.name,
+                       resume == Resume::ReturnMarker ? "2" : nullptr);
+    }
+    // An unterminated #if is an error.
+    if (!source.conditions.empty()) unsupported = true;
+    --depth;
+}
+
+Preprocessor::Resume Preprocessor::directive(std::string_view text, Source &source,
+                                             unsigned line, unsigned physical) {
+    auto stripped = stripComments(text);
+    if (!stripped) {
+        unsupported = true;
+        return Resume::Newlines;
+    }
+    std::string_view rest = *stripped;
+    size_t pos = rest.find('#') + 1;
+    skipSpaces(rest, pos);
+    std::string_view name = identifier(rest, pos);
+    bool isLineMarker = name.empty() && pos < rest.size() &&
+                        std::isdigit(static_cast<unsigned char>(rest[pos]));
+    rest = trim(rest.substr(pos));
+    auto &conditions = source.conditions;
+
+    auto firstWord = [&]() {
+        size_t start = 0;
+        auto word = identifier(rest, start);
+        if (word.empty() || isPredefined(word) || word == "__LINE__" || word == "__FILE__")
+            unsupported = true;
+        return word;
+    };
+    if (name == "if" || name == "ifdef" || name == "ifndef") {
+        bool parent = source.active();
+        bool value = false;
+        if (parent) {
+            if (name == "if")
+                value = evaluate(rest, source, line);
+            else
+                value = (macros.count(firstWord()) != 0) == (name == "ifdef");
+        }
+        conditions.push_back({parent, value, value});
+        return Resume::Newlines;
+    }
+    if (name == "elif" || name == "else") {
+        if (conditions.empty() || conditions.back().sawElse) {
+            unsupported = true;
+            return Resume::Newlines;
+        }
+        auto &condition = conditions.back();
+        if (!condition.parent || condition.taken) {
+            condition.active = false;
+        } else {
+            condition.active = name == "else" || evaluate(rest, source, line);
+            condition.taken = condition.active;
+        }
+        condition.sawElse = name == "else";
+        return Resume::Newlines;
+    }
+    if (name == "endif") {
+        if (conditions.empty())
+            unsupported = true;
+        else
+            conditions.pop_back();
+        return Resume::Newlines;
+    }
+    if (!source.active()) return Resume::Newlines;
+
+    if (name.empty() && !isLineMarker) return Resume::Newlines;  // the null directive
+    if (name == "pragma") {
+        // The lexer skips pragmas, but `once` changes what is included.
+        size_t start = 0;
+        if (identifier(rest, start) == "once") unsupported = true;
+        return Resume::Newlines;
+    }
+    if (name == "define") {
+        size_t end = 0;
+        auto macro = identifier(rest, end);
+        if (macro.empty() || (end < rest.size() && rest[end] == '(') || isPredefined(macro) ||
+            macro == "__LINE__" || macro == "__FILE__") {
+            // Function-like macros are left to cpp.
+            unsupported = true;
+            return Resume::Newlines;
+        }
+        std::string definition(macro);
+        definition += '=';
+        definition += trim(rest.substr(end));
+        if (!define(definition)) unsupported = true;
+        return Resume::Newlines;
+    }
+    if (name == "undef") {
+        undefine(firstWord());
+        return Resume::Newlines;
+    }
+    if (name == "include") {
+        char close = rest.empty() ? 0 : rest[0] == '"' ? '"' : rest[0] == '<' ? '>' : 0;
+        auto end = close ? rest.find(close, 1) : std::string_view::npos;
+        if (end == std::string_view::npos) {
+            unsupported = true;
+            return Resume::Newlines;
+        }
+        auto file = findInclude(rest.substr(1, end - 1), close == '"', source.path);
+        if (!file) {
+            unsupported = true;
+            return Resume::Newlines;
+        }
+        process(*file);
+        return Resume::ReturnMarker;
+    }
+    if (name == "line" || isLineMarker) {
+        bool inComment = false;
+        std::set<std::string, std::less<>> expanding;
+        auto expanded = expand(rest, inComment, source, line, expanding);
+        std::string_view arguments = trim(expanded);
+        size_t end = 0;
+        while (end < arguments.size() && std::isdigit(static_cast<unsigned char>(arguments[end])))
+            ++end;
+        if (end == 0) {
+            unsupported = true;
+            return Resume::Newlines;
+        }
+        long number = std::strtol(std::string(arguments.substr(0, end)).c_str(), nullptr, 10);
+        arguments = trim(arguments.substr(end));
+        if (!arguments.empty() && arguments[0] == '"') {
+            auto close = arguments.find('"', 1);
+            if (close == std::string_view::npos) {
+                unsupported = true;
+                return Resume::Newlines;
+            }
+            source.name = std::string(arguments.substr(1, close - 1));
+        }
+        source.delta = number - static_cast<long>(line + physical);
+        return Resume::Marker;
+    }
+    // #error, #warning, #include_next, ...
+    unsupported = true;
+    return Resume::Newlines;
+}
+
+bool Preprocessor::evaluate(std::string_view expression, const Source &source, unsigned line) {
+    // Replace `defined NAME` and `defined(NAME)` before expanding macros.
+    std::string replaced;
+    size_t pos = 0;
+    while (pos < expression.size()) {
+        if (expression[pos] == '"') {
+            unsupported = true;
+            return false;
+        }
+        if (std::isdigit(static_cast<unsigned char>(expression[pos]))) {
+            size_t start = pos;
+            skipNumber(expression, pos);
+            replaced.append(expression.substr(start, pos - start));
+            continue;
+        }
+        auto word = identifier(expression, pos);
+        if (word.empty()) {
+            replaced += expression[pos++];
+            continue;
+        }
+        if (word != "defined") {
+            replaced.append(word);
+            continue;
+        }
+        skipSpaces(expression, pos);
+        bool parenthesized = pos < expression.size() && expression[pos] == '(';
+        if (parenthesized) ++pos;
+        skipSpaces(expression, pos);
+        auto macro = identifier(expression, pos);
+        skipSpaces(expression, pos);
+        if (parenthesized && (pos >= expression.size() || expression[pos++] != ')'))
+            macro = {};
+        if (macro.empty() || isPredefined(macro) || macro == "__LINE__" || macro == "__FILE__") {
+            unsupported = true;
+            return false;
+        }
+        replaced += macros.count(macro) ? " 1 " : " 0 ";
+    }
+
+    bool inComment = false;
+    std::set<std::string, std::less<>> expanding;
+    auto expanded = expand(replaced, inComment, source, line, expanding);
+    ConditionEvaluator evaluator(expanded);
+    bool value = evaluator.evaluate();
+    if (evaluator.failed) unsupported = true;
+    return value;
+}
+
+std::string Preprocessor::expand(std::string_view text, bool &inComment, const Source &source,
+                                 unsigned line, std::set<std::string, std::less<>> &expanding) {
+    std::string result;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t start = pos;
+        if (inComment) {
+            auto end = text.find("*/", pos);
+            if (end == std::string_view::npos) {
+                pos = text.size();
+            } else {
+                pos = end + 2;
+                inComment = false;
+            }
+        } else if (text[pos] == '"') {
+            skipString(text, pos);
+        } else if (text.compare(pos, 2, "//") == 0) {
+            pos = text.size();
+        } else if (text.compare(pos, 2, "/*") == 0) {
+            inComment = true;
+            pos += 2;
+        } else if (std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            skipNumber(text, pos);
+        } else if (isIdentifierStart(text[pos])) {
+            auto word = identifier(text, pos);
+            std::string replacement;
+            if (word == "__LINE__") {
+                replacement = std::to_string(line + source.delta);
+            } else if (word == "__FILE__") {
+                replacement = "\"" + source.name + "\"";
+            } else if (isPredefined(word)) {
+                unsupported = true;
+                return result;
+            } else {
+                auto macro = macros.find(word);
+                if (macro == macros.end() || expanding.count(word)) {
+                    result.append(word);
+                    continue;
+                }
+                auto name = expanding.emplace(word).first;
+                bool bodyComment = false;
+                replacement = expand(macro->second, bodyComment, source, line, expanding);
+                expanding.erase(name);
+            }
+            if (!result.empty() && !replacement.empty() &&
+                couldPaste(result.back(), replacement.front()))
+                result += ' ';
+            result += replacement;
+            if (pos < text.size() && !replacement.empty() &&
+                couldPaste(replacement.back(), text[pos]))
+                result += ' ';
+            continue;
+        } else {
+            ++pos;
+        }
+        result.append(text.substr(start, pos - start));
+    }
+    return result;
+}
+
+}  // namespace P4
@@ -0,0 +1,111 @@
+#ifndef FRONTENDS_COMMON_PREPROCESSOR_H_
+#define FRONTENDS_COMMON_PREPROCESSOR_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace P4 {
+
+/// A C preprocessor for the directives P4 programs use, run in the compiler process instead of
+/// an external cpp: #include, object-like #define and #undef, #if, #ifdef, #ifndef, #elif,
+/// #else, #endif, #line and #pragma.  Like `cpp -C -undef`, it keeps comments and predefines
+/// no macros, and it writes line markers the lexer understands.
+///
+/// It does not diagnose anything.  For a program using anything else (function-like macros,
+/// #error, a missing include, ...) run() returns std::nullopt, and the caller runs the external
+/// preprocessor, which gives the same diagnostics as before.
+///
+/// Files found under the standard include directories (p4include/) are split into lines and
+/// scanned for directives and comments once per process, and reused while they are unchanged.
+/// This only saves work in a process that preprocesses several programs: a compiler run still
+/// reads and scans them once.  What is reused across runs is the result of parsing them, see
+/// ParsedIncludes.
+class Preprocessor {
+ public:
+    /// @p systemPaths are searched after @p includePaths, and their files are cached.
+    Preprocessor(std::vector<std::filesystem::path> includePaths,
+                 std::vector<std::filesystem::path> systemPaths);
+
+    /// Defines a macro as -D does: "NAME" is defined as 1, "NAME=VALUE" as VALUE.
+    /// @return false if @p definition is not an object-like macro.
+    bool define(std::string_view definition);
+    void undefine(std::string_view name);
+
+    /// Applies the -I, -D and -U options in @p options, as given to the external preprocessor.
+    /// @return false if there are other options.
+    bool addOptions(std::string_view options);
+
+    /// The preprocessed contents of @p file, or std::nullopt if it must be preprocessed
+    /// externally.
+    std::optional<std::string> run(const std::filesystem::path &file);
+
+    /// A file split into lines, with what the preprocessor needs to know about each one.
+    struct Line {
+        std::string text;        // with continuation lines joined
+        unsigned physical = 1;   // number of lines of the file
+        bool directive = false;  // starts with '#' outside of a comment
+        bool inComment = false;  // starts inside a block comment
+    };
+    using Lines = std::vector<Line>;
+
+    /// Splits @p source into lines.  Never fails.
+    static Lines scan(std::string_view source);
+
+    /// Number of standard header files read from disk and scanned so far by this process, for
+    /// tests.
+    static uint64_t systemFilesScanned();
+
+ private:
+    /// A conditional group (#if ... #endif) being read.
+    struct Condition {
+        bool parent;        // the enclosing groups are all taken
+        bool active;        // the current branch is taken
+        bool taken;         // some branch is or was taken
+        bool sawElse = false;
+    };
+    /// A file being read.
+    struct Source {
+        std::filesystem::path path;
+        std::string name;  // as written in line markers, changed by #line
+        long delta = 0;    // from line numbers in the file to those in markers
+        std::vector<Condition> conditions;
+        bool active() const { return conditions.empty() || conditions.back().active; }
+    };
+
+    std::vector<std::filesystem::path> includePaths;
+    std::vector<std::filesystem::path> systemPaths;
+    std::map<std::string, std::string, std::less<>> macros;
+    std::string output;
+    unsigned depth = 0;
+    bool unsupported = false;
+
+    std::shared_ptr<const Lines> load(const std::filesystem::path &file, bool system);
+    bool isSystem(const std::filesystem::path &file) const;
+    std::optional<std::filesystem::path> findInclude(std::string_view name, bool quoted,
+                                                     const std::filesystem::path &from) const;
+    /// What replaces a directive in the output.
+    enum class Resume {
+        Newlines,     // as many newlines as it has lines
+        Marker,       // a line marker for the next line
+        ReturnMarker  // a line marker for the next line, after an included file
+    };
+
+    void process(const std::filesystem::path &file);
+    /// Runs the directive @p text found at @p line of @p source, which has @p physical lines.
+    Resume directive(std::string_view text, Source &source, unsigned line, unsigned physical);
+    bool evaluate(std::string_view expression, const Source &source, unsigned line);
+    std::string expand(std::string_view text, bool &inComment, const Source &source,
+                       unsigned line, std::set<std::string, std::less<>> &expanding);
+    void lineMarker(long line, std::string_view name, const char *flag);
+};
+
+}  // namespace P4
+
+#endif /* FRONTENDS_COMMON_PREPROCESSOR_H_ */
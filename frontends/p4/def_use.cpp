@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "def_use.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "absl/strings/str_cat.h"
 #include "frontends/p4/methodInstance.h"
 #include "frontends/p4/tableApply.h"
@@ -178,7 +181,7 @@ const LocationSet *LocationSet::join(const LocationSet *other) const {
     CHECK_NULL(other);
     if (this == LocationSet::empty) return other;
     if (other == LocationSet::empty) return this;
-    auto result = new LocationSet(locations);
+    auto result = new LocationSet(*this);
     for (auto e : other->locations) result->add(e);
     return result;
 }
@@ -292,21 +295,34 @@ bool ProgramPoint::operator==(const ProgramPoint &other) const {
 
 std::size_t ProgramPoint::hash() const { return Util::hash_range(stack.begin(), stack.end()); }
 
-void ProgramPoints::add(const ProgramPoints *from) {
-    points.insert(from->points.begin(), from->points.end());
+namespace {
+bool byNumber(const ProgramPointIndex::Entry *left, const ProgramPointIndex::Entry *right) {
+    return left->number < right->number;
 }
+}  // namespace
 
-const ProgramPoints *ProgramPoints::merge(const ProgramPoints *with) const {
-    auto *result = new ProgramPoints(points);
-    result->points.insert(with->points.begin(), with->points.end());
-    return result;
+void ProgramPoints::add(const ProgramPoints *from) {
+    if (from->points.empty()) return;
+    Entries result;
+    result.reserve(points.size() + from->points.size());
+    std::set_union(points.begin(), points.end(), from->points.begin(), from->points.end(),
+                   std::back_inserter(result), byNumber);
+    points = std::move(result);
 }
 
-bool ProgramPoints::operator==(const ProgramPoints &other) const {
-    if (points.size() != other.points.size()) return false;
-    for (auto p : points)
-        if (other.points.find(p) == other.points.end()) return false;
-    return true;
+const ProgramPoints *ProgramPoints::merge(const ProgramPoints *with) const {
+    // At most joins one side already holds all points of the other; share it then.
+    if (std::includes(points.begin(), points.end(), with->points.begin(), with->points.end(),
+                      byNumber))
+        return this;
+    if (std::includes(with->points.begin(), with->points.end(), points.begin(), points.end(),
+                      byNumber))
+        return with;
+    Entries result;
+    result.reserve(points.size() + with->points.size());
+    std::set_union(points.begin(), points.end(), with->points.begin(), with->points.end(),
+                   std::back_inserter(result), byNumber);
+    return new ProgramPoints(std::move(result));
 }
 
 Definitions *Definitions::joinDefinitions(const Definitions *other) const {
@@ -360,9 +376,9 @@ const ProgramPoints *Definitions::getPoints(const LocationSet &locations) const
     return result;
 }
 
-Definitions *Definitions::writes(ProgramPoint point, const LocationSet &locations) const {
+Definitions *Definitions::writes(const ProgramPoints *points,
+                                 const LocationSet &locations) const {
     auto result = new Definitions(*this);
-    auto points = new ProgramPoints(point);
     for (auto l : locations.canonical()) result->setDefinition(l->to<BaseLocation>(), points);
     return result;
 }
@@ -391,8 +407,8 @@ void ComputeWriteSet::enterScope(const IR::ParameterList *parameters,
     if (!clear) defs = currentDefinitions;
     if (defs == nullptr) defs = new Definitions();
 
-    auto startPoints = new ProgramPoints(entryPoint);
-    auto uninit = new ProgramPoints(ProgramPoint::beforeStart);
+    auto startPoints = allDefinitions->points(entryPoint);
+    auto uninit = allDefinitions->points(ProgramPoint::beforeStart);
 
     if (parameters != nullptr) {
         for (auto p : parameters->parameters) {
@@ -866,7 +882,7 @@ bool ComputeWriteSet::preorder(const IR::IfStatement *statement) {
     visit(statement->condition);
     auto cond = getWrites(statement->condition);
     // defs are the definitions after evaluating the condition
-    auto defs = currentDefinitions->writes(getProgramPoint(), *cond);
+    auto defs = currentDefinitions->writes(allDefinitions->points(getProgramPoint()), *cond);
     (void)setDefinitions(defs, statement->condition, false);
     visit(statement->ifTrue);
     auto result = currentDefinitions;
@@ -893,7 +909,7 @@ bool ComputeWriteSet::preorder(const IR::ForStatement *statement) {
         visit(statement->condition, "condition");
         auto cond = getWrites(statement->condition);
         // exitDefs are the definitions after evaluating the condition
-        exitDefs = currentDefinitions->writes(getProgramPoint(), *cond);
+        exitDefs = currentDefinitions->writes(allDefinitions->points(getProgramPoint()), *cond);
         (void)setDefinitions(exitDefs, statement->condition, true);
         visit(statement->body, "body");
         currentDefinitions = currentDefinitions->joinDefinitions(continueDefinitions);
@@ -925,7 +941,7 @@ bool ComputeWriteSet::preorder(const IR::ForInStatement *statement) {
         visit(statement->ref, "ref");
         lhs = false;
         auto cond = getWrites(statement->ref);
-        auto defs = currentDefinitions->writes(getProgramPoint(), *cond);
+        auto defs = currentDefinitions->writes(allDefinitions->points(getProgramPoint()), *cond);
         (void)setDefinitions(defs, statement->ref, true);
         visit(statement->body, "body");
         currentDefinitions = currentDefinitions->joinDefinitions(continueDefinitions);
@@ -992,7 +1008,7 @@ bool ComputeWriteSet::preorder(const IR::BaseAssignmentStatement *statement) {
     auto l = getWrites(statement->left);
     auto r = getWrites(statement->right);
     locs = l->join(r);
-    auto defs = currentDefinitions->writes(getProgramPoint(), *locs);
+    auto defs = currentDefinitions->writes(allDefinitions->points(getProgramPoint()), *locs);
     return setDefinitions(defs);
 }
 
@@ -1001,7 +1017,8 @@ bool ComputeWriteSet::preorder(const IR::SwitchStatement *statement) {
     if (currentDefinitions->isUnreachable()) return setDefinitions(currentDefinitions);
     visit(statement->expression);
     auto locs = getWrites(statement->expression);
-    auto defs = currentDefinitions->writes(getProgramPoint(statement->expression), *locs);
+    auto defs = currentDefinitions->writes(
+        allDefinitions->points(getProgramPoint(statement->expression)), *locs);
     (void)setDefinitions(defs, statement->expression, false);
     auto save = currentDefinitions;
     auto result = new Definitions();
@@ -1126,7 +1143,7 @@ bool ComputeWriteSet::preorder(const IR::MethodCallStatement *statement) {
     lhs = false;
     visit(statement->methodCall);
     auto locs = getWrites(statement->methodCall);
-    auto defs = currentDefinitions->writes(getProgramPoint(), *locs);
+    auto defs = currentDefinitions->writes(allDefinitions->points(getProgramPoint()), *locs);
     return setDefinitions(defs, statement, true);  // overwrite
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef FRONTENDS_P4_DEF_USE_H_
 #define FRONTENDS_P4_DEF_USE_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_set.h"
@@ -26,7 +27,7 @@ limitations under the License.
 #include "lib/flat_map.h"
 #include "lib/hash.h"
 #include "lib/hvec_map.h"
-#include "lib/ordered_set.h"
+#include "lib/hvec_set.h"
 #include "typeMap.h"
 
 namespace P4 {
@@ -249,8 +250,10 @@ class StorageFactory {
 
 /// A set of locations that may be read or written by a computation.
 /// In general this is a conservative approximation of the actual location set.
+/// Locations are kept in insertion order in a flat hvec_set: sets are built once and
+/// iterated often, and are never erased from.
 class LocationSet : public IHasDbPrint {
-    using LocationsStorage = ordered_set<const StorageLocation *>;
+    using LocationsStorage = hvec_set<const StorageLocation *>;
     LocationsStorage locations;
 
     class canonical_iterator {
@@ -312,7 +315,6 @@ class LocationSet : public IHasDbPrint {
 
  public:
     LocationSet() = default;
-    explicit LocationSet(const ordered_set<const StorageLocation *> &other) : locations(other) {}
     explicit LocationSet(const StorageLocation *location) {
         CHECK_NULL(location);
         locations.emplace(location);
@@ -472,28 +474,75 @@ struct Hasher<P4::loc_t> {
 }  // namespace P4::Util
 
 namespace P4 {
+/// Interns the program points of one analysis and numbers them in the order they are first
+/// seen, from 0 for ProgramPoint::beforeStart.  The interned entries are not owned by the index,
+/// so sets holding them do not refer back to it.
+class ProgramPointIndex {
+ public:
+    struct Entry {
+        unsigned number;
+        ProgramPoint point;
+    };
+
+    ProgramPointIndex() { intern(ProgramPoint()); }
+    const Entry *intern(const ProgramPoint &point) {
+        auto &entry = entries[point];
+        if (entry == nullptr) entry = new Entry{static_cast<unsigned>(entries.size() - 1), point};
+        return entry;
+    }
+    size_t size() const { return entries.size(); }
+
+ private:
+    absl::flat_hash_map<ProgramPoint, const Entry *, Util::Hash> entries;
+};
+
+/// A set of program points, kept as interned entries sorted by their number.  Most sets of
+/// reaching definitions hold one or two points, so the storage follows the size of the set
+/// rather than the number of points in the analysis.
 class ProgramPoints : public IHasDbPrint {
-    typedef absl::flat_hash_set<ProgramPoint, Util::Hash> Points;
-    Points points;
-    explicit ProgramPoints(const Points &points) : points(points) {}
+    using Entry = ProgramPointIndex::Entry;
+    using Entries = absl::InlinedVector<const Entry *, 2>;
+    Entries points;
+    explicit ProgramPoints(Entries &&points) : points(std::move(points)) {}
 
  public:
+    class const_iterator {
+        Entries::const_iterator it;
+
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ProgramPoint;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ProgramPoint *;
+        using reference = const ProgramPoint &;
+        explicit const_iterator(Entries::const_iterator it) : it(it) {}
+        const ProgramPoint &operator*() const { return (*it)->point; }
+        const ProgramPoint *operator->() const { return &(*it)->point; }
+        const_iterator &operator++() {
+            ++it;
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return it == other.it; }
+        bool operator!=(const const_iterator &other) const { return it != other.it; }
+    };
+
     ProgramPoints() = default;
-    explicit ProgramPoints(ProgramPoint point) { points.emplace(point); }
+    explicit ProgramPoints(const Entry *point) {
+        CHECK_NULL(point);
+        points.push_back(point);
+    }
     void add(const ProgramPoints *from);
     const ProgramPoints *merge(const ProgramPoints *with) const;
-    bool operator==(const ProgramPoints &other) const;
+    bool operator==(const ProgramPoints &other) const { return points == other.points; }
     void dbprint(std::ostream &out) const override {
         out << "{";
-        for (auto p : points) out << p << " ";
+        for (const auto &p : *this) out << p << " ";
         out << "}";
     }
     size_t size() const { return points.size(); }
-    bool containsBeforeStart() const {
-        return points.find(ProgramPoint::beforeStart) != points.end();
-    }
-    Points::const_iterator begin() const { return points.cbegin(); }
-    Points::const_iterator end() const { return points.cend(); }
+    bool containsBeforeStart() const { return !points.empty() && points.front()->number == 0; }
+    const_iterator begin() const { return const_iterator(points.begin()); }
+    const_iterator end() const { return const_iterator(points.end()); }
 };
 
 /// List of definers for each base storage (at a specific program point).
@@ -509,8 +558,8 @@ class Definitions : public IHasDbPrint {
     Definitions(const Definitions &other)
         : definitions(other.definitions), unreachable(other.unreachable) {}
     Definitions *joinDefinitions(const Definitions *other) const;
-    /// Point writes the specified LocationSet.
-    Definitions *writes(ProgramPoint point, const LocationSet &locations) const;
+    /// The program points in @p points write the specified LocationSet.
+    Definitions *writes(const ProgramPoints *points, const LocationSet &locations) const;
     void setDefintion(const BaseLocation *loc, const ProgramPoints *point) {
         CHECK_NULL(loc);
         CHECK_NULL(point);
@@ -558,6 +607,7 @@ class AllDefinitions : public IHasDbPrint {
     /// ProgramPoint.
     hvec_map<ProgramPoint, Definitions *> atPoint;
     StorageMap storageMap;
+    ProgramPointIndex pointIndex;
 
  public:
     AllDefinitions(ReferenceMap *refMap, TypeMap *typeMap) : storageMap(refMap, typeMap) {}
@@ -594,6 +644,11 @@ class AllDefinitions : public IHasDbPrint {
         return storageMap.getOrAdd(decl);
     }
 
+    /// The set holding only @p point.
+    const ProgramPoints *points(const ProgramPoint &point) {
+        return new ProgramPoints(pointIndex.intern(point));
+    }
+
     void dbprint(std::ostream &out) const override {
         for (auto e : atPoint) out << e.first << " => " << e.second << Log::endl;
     }
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "../common/options.h"
 #include "frontends/common/resolveReferences/resolveReferences.h"
+#include "frontends/p4/frontendSnapshot.h"
 #include "frontends/p4/typeChecking/bindVariables.h"
 #include "frontends/p4/typeMap.h"
 #include "ir/ir.h"
@@ -152,6 +153,7 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
     if (program == nullptr && options.listFrontendPasses == 0) return nullptr;
 
     TypeMap typeMap;
+    typeMap.setIncremental(options.incrementalTypeMap);
 
     ParseAnnotations *parseAnnotations = policy->getParseAnnotations();
     if (!parseAnnotations) parseAnnotations = new ParseAnnotations();
@@ -289,10 +291,15 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
         passes.removePasses(options.passesToExcludeFrontend);
     }
 
+    FrontEndSnapshot snapshot(options, program);
+    if (const auto *restored = snapshot.restore()) return restored;
+
     passes.setName("FrontEnd");
     passes.setStopOnError(true);
     passes.addDebugHooks(hooks, true);
+    passes.setParallelJobs(options.parallelJobs, true);
     const IR::P4Program *result = program->apply(passes);
+    snapshot.store(result);
     return result;
 }
 
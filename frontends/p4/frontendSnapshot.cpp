@@ -0,0 +1,207 @@
+#include "frontends/p4/frontendSnapshot.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <system_error>
+
+#include "frontends/common/compilationCache.h"
+#include "ir/binary_reader.h"
+#include "ir/binary_writer.h"
+#include "lib/error.h"
+#include "lib/hash.h"
+#include "lib/log.h"
+
+namespace P4 {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view declarationsName = "declarations";
+constexpr std::string_view programName = "program";
+
+/// Finds the lines a top-level declaration spans.
+class ScanDeclaration : public Inspector {
+ public:
+    const Util::InputSources *sources = nullptr;
+    unsigned firstLine = std::numeric_limits<unsigned>::max();
+    unsigned lastLine = 0;
+
+    bool preorder(const IR::Node *node) override {
+        if (node->srcInfo.isValid()) {
+            if (sources == nullptr) sources = node->srcInfo.getSources();
+            firstLine = std::min(firstLine, node->srcInfo.getStart().getLineNumber());
+            lastLine = std::max(lastLine, node->srcInfo.getEnd().getLineNumber());
+        }
+        return true;
+    }
+};
+
+/// Line numbers of the positions written by the previous compilation, translated to the lines
+/// the same declarations span now.
+class MoveLines {
+    struct Range {
+        unsigned firstLine, lastLine;
+        int delta;
+    };
+    std::vector<Range> ranges;
+
+ public:
+    MoveLines(const std::vector<DeclarationFingerprint> &previous,
+              const std::vector<DeclarationFingerprint> &current) {
+        for (size_t i = 0; i < previous.size(); ++i) {
+            int delta = static_cast<int>(current[i].firstLine) -
+                        static_cast<int>(previous[i].firstLine);
+            ranges.push_back({previous[i].firstLine, previous[i].lastLine, delta});
+        }
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const Range &a, const Range &b) { return a.firstLine < b.firstLine; });
+    }
+
+    /// 0 for lines outside all declarations.
+    unsigned operator()(unsigned line) const {
+        auto it = std::upper_bound(
+            ranges.begin(), ranges.end(), line,
+            [](unsigned line, const Range &range) { return line < range.firstLine; });
+        if (it == ranges.begin() || line > std::prev(it)->lastLine) return 0;
+        return line + std::prev(it)->delta;
+    }
+};
+
+}  // namespace
+
+std::vector<DeclarationFingerprint> DeclarationFingerprint::compute(const IR::P4Program *program) {
+    std::vector<DeclarationFingerprint> result;
+    const Util::InputSources *sources = nullptr;
+    for (const auto *object : program->objects) {
+        ScanDeclaration scan;
+        object->apply(scan);
+        if (scan.sources == nullptr || (sources != nullptr && scan.sources != sources) ||
+            scan.lastLine > scan.sources->lineCount())
+            return {};
+        sources = scan.sources;
+
+        DeclarationFingerprint fingerprint;
+        if (const auto *declaration = object->to<IR::IDeclaration>())
+            fingerprint.name = declaration->getName().name;
+        else
+            fingerprint.name = object->node_type_name();
+        fingerprint.firstLine = scan.firstLine;
+        fingerprint.lastLine = scan.lastLine;
+        // Whole lines, so that columns stay valid when the text is the same.
+        for (unsigned line = scan.firstLine; line <= scan.lastLine; ++line)
+            fingerprint.text =
+                Util::hash_combine(fingerprint.text, Util::hash(sources->getLine(line)));
+        result.push_back(fingerprint);
+    }
+    return result;
+}
+
+std::ostream &operator<<(std::ostream &out, const DeclarationFingerprint &fingerprint) {
+    return out << fingerprint.name << ' ' << fingerprint.text << ' ' << fingerprint.firstLine
+               << ' ' << fingerprint.lastLine;
+}
+
+std::istream &operator>>(std::istream &in, DeclarationFingerprint &fingerprint) {
+    std::string name;
+    if (in >> name >> fingerprint.text >> fingerprint.firstLine >> fingerprint.lastLine)
+        fingerprint.name = cstring(name);
+    return in;
+}
+
+FrontEndSnapshot::FrontEndSnapshot(const CompilerOptions &options, const IR::P4Program *program)
+    : options(options), program(program) {
+    active = options.reuseFrontEnd && !options.cacheDirectory.empty() &&
+             program != nullptr && options.top4.empty() && options.dumpJsonFile.empty() &&
+             options.dumpBinaryFile.empty() && options.prettyPrintFile.empty() &&
+             !options.excludeFrontendPasses;
+    if (!active) return;
+    declarations = DeclarationFingerprint::compute(program);
+    for (const auto *object : program->objects) {
+        if ((sources = object->srcInfo.getSources()) != nullptr) break;
+    }
+    if (declarations.empty() || sources == nullptr) {
+        active = false;
+        return;
+    }
+    std::error_code ec;
+    fs::create_directories(options.cacheDirectory, ec);
+    if (ec) {
+        ::P4::error(ErrorType::ERR_IO, "%1%: cannot create cache directory: %2%",
+                    options.cacheDirectory, ec.message());
+        active = false;
+        return;
+    }
+    // One snapshot per command line: the program is identified by its file name, and the
+    // snapshot of the previous compilation replaces the one before.
+    std::string version = options.exe_name.string() + " " + options.compilerVersion.string();
+    entry = options.cacheDirectory /
+            ("frontend-" + CompilationCache::key(
+                               "frontend", CompilationCache::keyArguments(options), version));
+    diagnostics = ::P4::diagnosticCount();
+}
+
+const IR::P4Program *FrontEndSnapshot::restore() {
+    if (!active) return nullptr;
+
+    std::vector<DeclarationFingerprint> previous;
+    {
+        std::ifstream in(entry / declarationsName);
+        DeclarationFingerprint fingerprint;
+        while (in >> fingerprint) previous.push_back(fingerprint);
+    }
+    bool same = !previous.empty() && previous.size() == declarations.size();
+    for (size_t i = 0; same && i < previous.size(); ++i)
+        same = previous[i].name == declarations[i].name &&
+               previous[i].text == declarations[i].text;
+    if (!same) {
+        LOG1("Frontend snapshot " << entry << " is out of date");
+        return nullptr;
+    }
+
+    std::ifstream in(entry / programName, std::ios::binary);
+    BinaryReader reader(in);
+    reader.setSources(sources, MoveLines(previous, declarations));
+    const IR::Node *node = nullptr;
+    reader >> node;
+    const auto *result = node ? node->to<IR::P4Program>() : nullptr;
+    if (!reader || result == nullptr) {
+        LOG1("Frontend snapshot " << entry << " is unreadable");
+        return nullptr;
+    }
+    std::error_code ec;
+    // Snapshots are evicted along with the compilation cache entries, in order of last use.
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    LOG1("Reusing frontend snapshot " << entry);
+    return result;
+}
+
+void FrontEndSnapshot::store(const IR::P4Program *result) {
+    if (!active || result == nullptr || ::P4::diagnosticCount() != diagnostics) return;
+
+    std::error_code ec;
+    auto temporary = entry;
+    temporary += ".tmp." + std::to_string(getpid());
+    fs::remove_all(temporary, ec);
+    if (!fs::create_directory(temporary, ec)) return;
+    {
+        std::ofstream out(temporary / programName, std::ios::binary);
+        BinaryWriter(out, false, true).emit(result);
+        std::ofstream list(temporary / declarationsName);
+        for (const auto &fingerprint : declarations) list << fingerprint << '\n';
+        if (!out || !list) {
+            fs::remove_all(temporary, ec);
+            return;
+        }
+    }
+    fs::remove_all(entry, ec);
+    fs::rename(temporary, entry, ec);
+    // Fails if another compilation stored its snapshot in between.
+    if (ec) fs::remove_all(temporary, ec);
+}
+
+}  // namespace P4
@@ -0,0 +1,75 @@
+#ifndef FRONTENDS_P4_FRONTENDSNAPSHOT_H_
+#define FRONTENDS_P4_FRONTENDSNAPSHOT_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <vector>
+
+#include "frontends/common/options.h"
+#include "ir/ir.h"
+
+namespace P4 {
+
+/// Fingerprint of a top-level declaration of a parsed program.
+struct DeclarationFingerprint {
+    /// The name of the declaration, or the node type for top-level objects without one.
+    cstring name;
+    /// Hash of the lines of the preprocessed program the declaration spans, annotations
+    /// included.
+    uint64_t text = 0;
+    /// The lines the declaration spans in the preprocessed program.
+    unsigned firstLine = 0, lastLine = 0;
+
+    /// Fingerprints of the top-level declarations of @p program, in program order.  Empty if
+    /// some declaration has no source position, as in programs that were not parsed from P4-16
+    /// source.
+    static std::vector<DeclarationFingerprint> compute(const IR::P4Program *program);
+};
+
+/// Frontend result of the previous compilation of a program, kept in the --cache-dir directory
+/// when --reuse-frontend is given.
+///
+/// This is a cache of the whole program, not an incremental frontend: the frontend passes --
+/// type inference, specialization, inlining and the removal of unused declarations -- look
+/// across top-level declarations, so their results cannot be reused piecemeal.  The result is
+/// reused while the text of every top-level declaration stays the same, which covers edits to
+/// comments and blank lines between declarations; any other edit runs the whole frontend again.
+/// Declarations may move to other lines: the positions in the restored program are translated to
+/// the lines the declarations are on now, so diagnostics of later passes point at the current
+/// source.
+///
+/// The snapshot is only stored when the frontend reported no diagnostics, so reusing it never
+/// hides a warning.
+class FrontEndSnapshot {
+ public:
+    /// @p program is the parsed program the frontend is about to run on.  The snapshot is
+    /// inactive without --reuse-frontend and --cache-dir, and when the command line asks for
+    /// debugging output of the frontend.
+    FrontEndSnapshot(const CompilerOptions &options, const IR::P4Program *program);
+
+    bool isActive() const { return active; }
+
+    /// The frontend result stored by the previous compilation if no top-level declaration
+    /// changed since, null otherwise.
+    const IR::P4Program *restore();
+
+    /// Saves @p result, the output of the frontend on the program given to the constructor.
+    void store(const IR::P4Program *result);
+
+ private:
+    const CompilerOptions &options;
+    const IR::P4Program *program;
+    const Util::InputSources *sources = nullptr;
+    bool active = false;
+    unsigned diagnostics = 0;
+    std::filesystem::path entry;
+    std::vector<DeclarationFingerprint> declarations;
+};
+
+std::ostream &operator<<(std::ostream &out, const DeclarationFingerprint &fingerprint);
+std::istream &operator>>(std::istream &in, DeclarationFingerprint &fingerprint);
+
+}  // namespace P4
+
+#endif /* FRONTENDS_P4_FRONTENDSNAPSHOT_H_ */
@@ -60,6 +60,8 @@ class DoSimplifyControlFlow : public Transform, public ResolutionContext {
         // We may want to replace the same statement with different things
         // in different places.
         visitDagOnce = false;
+        // Only statements are simplified; do not copy the expressions and types.
+        cloneOnWrite = true;
     }
     const IR::Node *postorder(IR::BlockStatement *statement) override;
     const IR::Node *postorder(IR::IfStatement *statement) override;
@@ -25,6 +25,7 @@ limitations under the License.
 #include "frontends/p4/tableApply.h"
 #include "frontends/p4/ternaryBool.h"
 #include "lib/hash.h"
+#include "lib/ordered_set.h"
 
 namespace P4 {
 
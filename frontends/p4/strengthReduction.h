@@ -44,7 +44,7 @@ using namespace literals;
  *   - division and modulus by `0`
  *
  */
-class DoStrengthReduction final : public Transform {
+class DoStrengthReduction final : public Transform, public DeclarationLocal {
  protected:
     /// Enable the subtract constant to add negative constant transform.
     /// Replaces `a - constant` with `a + (-constant)`.
@@ -83,6 +83,8 @@ class DoStrengthReduction final : public Transform {
         DoStrengthReduction();
     }
 
+    DoStrengthReduction *clone() const override { return new DoStrengthReduction(*this); }
+
     using Transform::postorder;
 
     const IR::Node *postorder(IR::Cmpl *expr) override;
@@ -16,7 +16,11 @@ limitations under the License.
 
 #include "symbol_table.h"
 
+#include <algorithm>
+#include <istream>
+#include <ostream>
 #include <sstream>
+#include <tuple>
 
 #include "lib/cstring.h"
 #include "lib/error.h"
@@ -106,6 +110,16 @@ class Namespace : public NamedSymbol {
         into << "}" << std::endl;
     }
     void clear() { contents.clear(); }
+    /// The symbols declared in this namespace, sorted by name.
+    std::vector<const NamedSymbol *> sorted() const {
+        std::vector<const NamedSymbol *> result;
+        for (const auto &[name, symbol] : contents) result.push_back(symbol);
+        std::sort(result.begin(), result.end(), [](const NamedSymbol *a, const NamedSymbol *b) {
+            return a->getName().string_view() < b->getName().string_view();
+        });
+        return result;
+    }
+    bool getAllowDuplicates() const { return allowDuplicates; }
     static const Namespace empty;
 
     DECLARE_TYPEINFO(Namespace, NamedSymbol);
@@ -283,6 +297,90 @@ cstring ProgramStructure::toString() const {
     return cstring(res.str());
 }
 
+namespace {
+
+void savePosition(std::ostream &out, const SourcePosition &position) {
+    out << ' ' << position.getLineNumber() << ' ' << position.getColumnNumber();
+}
+
+void saveSymbols(std::ostream &out, const Namespace *ns, unsigned depth) {
+    for (const auto *symbol : ns->sorted()) {
+        char kind = symbol->is<ContainerType>() ? 'C' : symbol->is<SimpleType>() ? 'T' : 'O';
+        bool allowDuplicates = false;
+        if (const auto *container = symbol->to<ContainerType>())
+            allowDuplicates = container->getAllowDuplicates();
+        out << depth << ' ' << kind << ' ' << symbol->template_args << ' ' << allowDuplicates;
+        savePosition(out, symbol->getSourceInfo().getStart());
+        savePosition(out, symbol->getSourceInfo().getEnd());
+        out << ' ' << symbol->getName();
+        if (symbol->is<Object>() && symbol->symNamespace() != &Namespace::empty)
+            out << ' ' << symbol->symNamespace()->getName();
+        out << '\n';
+        if (const auto *container = symbol->to<ContainerType>())
+            saveSymbols(out, container, depth + 1);
+    }
+}
+
+}  // namespace
+
+void ProgramStructure::save(std::ostream &out) const {
+    BUG_CHECK(currentNamespace == rootNamespace, "Saving the symbols of a partial declaration");
+    saveSymbols(out, rootNamespace, 0);
+}
+
+bool ProgramStructure::load(std::istream &in, const InputSources *sources) {
+    std::vector<Namespace *> scopes = {currentNamespace};
+    // Objects whose type is a container type, resolved once all symbols are declared.
+    std::vector<std::tuple<Object *, Namespace *, cstring>> typed;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        size_t depth;
+        char kind;
+        bool templateArgs, allowDuplicates;
+        unsigned startLine, startColumn, endLine, endColumn;
+        std::string name, typeName;
+        if (!(fields >> depth >> kind >> templateArgs >> allowDuplicates >> startLine >>
+              startColumn >> endLine >> endColumn >> name) ||
+            depth >= scopes.size())
+            return false;
+        fields >> typeName;
+        scopes.resize(depth + 1);
+        SourceInfo srcInfo;
+        if (startLine != 0 && endLine != 0) {
+            SourcePosition start(startLine, startColumn), end(endLine, endColumn);
+            if (end < start) return false;
+            srcInfo = SourceInfo(sources, start, end);
+        }
+        NamedSymbol *symbol = nullptr;
+        if (kind == 'C') {
+            auto *container = new ContainerType(cstring(name), srcInfo, allowDuplicates);
+            container->setParent(scopes[depth]);
+            scopes.push_back(container);
+            symbol = container;
+        } else if (kind == 'T') {
+            symbol = new SimpleType(cstring(name), srcInfo);
+        } else if (kind == 'O') {
+            auto *object = new Object(cstring(name), srcInfo);
+            if (!typeName.empty()) typed.emplace_back(object, scopes[depth], cstring(typeName));
+            symbol = object;
+        } else {
+            return false;
+        }
+        symbol->template_args = templateArgs;
+        scopes[depth]->declare(symbol);
+    }
+    for (auto &[object, scope, typeName] : typed) {
+        for (const Namespace *ns = scope; ns != nullptr; ns = ns->getParent()) {
+            if (auto *type = ns->lookup(typeName)) {
+                if (const auto *tns = type->to<Namespace>()) object->setNamespace(tns);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
 void ProgramStructure::clear() {
     rootNamespace->clear();
     currentNamespace = rootNamespace;
@@ -22,6 +22,7 @@ limitations under the License.
 /* A very simple symbol table that recognizes types; necessary because
    the v1.2 grammar is ambiguous without type information */
 
+#include <iosfwd>
 #include <unordered_map>
 #include <vector>
 
@@ -85,6 +86,14 @@ class ProgramStructure final {
 
     cstring toString() const;
     void clear();
+
+    /// Writes the symbols declared so far, one per line, for load().  Only valid between
+    /// top-level declarations.
+    void save(std::ostream &out) const;
+    /// Declares the symbols written by save() in the current namespace, with their source
+    /// positions in @p sources.  @return false if @p in is malformed, in which case some of
+    /// the symbols may have been declared.
+    bool load(std::istream &in, const InputSources *sources);
 };
 
 }  // namespace P4::Util
@@ -19,6 +19,7 @@ limitations under the License.
 namespace P4 {
 
 bool SameExpression::sameType(const IR::Type *left, const IR::Type *right) const {
+    if (left == right) return true;
     auto lt = typeMap->getType(left, true);
     auto rt = typeMap->getType(right, true);
     return typeMap->equivalent(lt, rt);
@@ -43,6 +44,8 @@ bool SameExpression::sameExpressions(const IR::Vector<IR::Argument> *left,
 bool SameExpression::sameExpression(const IR::Expression *left, const IR::Expression *right) const {
     CHECK_NULL(left);
     CHECK_NULL(right);
+    // Constants and literals are often interned.
+    if (left == right) return true;
     if (left->node_type_name() != right->node_type_name()) return false;
     if (auto lu = left->to<IR::Operation_Unary>()) {
         auto ru = right->to<IR::Operation_Unary>();
@@ -20,6 +20,7 @@ limitations under the License.
 #include "frontends/common/constantFolding.h"
 #include "frontends/common/resolveReferences/referenceMap.h"
 #include "frontends/common/resolveReferences/resolveReferences.h"
+#include "ir/pass_profile.h"
 #include "lib/cstring.h"
 #include "lib/log.h"
 #include "typeConstraints.h"
@@ -113,6 +114,7 @@ void TypeInferenceBase::start(const IR::Node *node) {
         LOG2("TypeInference for " << dbp(node));
     }
     initialNode = node;
+    typedBefore = typeMap->nodesTyped();
     if (!nameGen) {
         nameGen = std::make_shared<MinimalNameGenerator>();
         node->apply(*nameGen);
@@ -121,7 +123,12 @@ void TypeInferenceBase::start(const IR::Node *node) {
 
 void TypeInferenceBase::finish(const IR::Node *node) {
     typeMap->updateMap(node);
-    if (node->is<IR::P4Program>()) LOG3("Typemap: " << std::endl << typeMap);
+    if (!node->is<IR::P4Program>()) return;
+    // Learners type parts of the program for the inference that called them.
+    auto typed = typeMap->nodesTyped() - typedBefore;
+    PassProfile::nodesTyped(typed);
+    LOG2("TypeInference typed " << typed << " nodes");
+    LOG3("Typemap: " << std::endl << typeMap);
 }
 
 ReadOnlyTypeInference *TypeInferenceBase::readOnlyClone() const {
@@ -246,11 +253,19 @@ const IR::Type *TypeInferenceBase::canonicalize(const IR::Type *type) {
     } else if (type->is<IR::Type_Dontcare>()) {
         return IR::Type_Dontcare::get();
     } else if (type->is<IR::Type_Base>()) {
-        auto *tb = type->to<IR::Type_Bits>();
-        if (!tb)
+        // Interned, so that equal canonical types are the same node.
+        const IR::Type *canon;
+        if (auto *tb = type->to<IR::Type_Bits>())
+            canon = IR::Type_Bits::get(tb->size, tb->isSigned);
+        else if (auto *tv = type->to<IR::Type_Varbits>(); tv && tv->expression == nullptr)
+            canon = IR::Type_Varbits::get(tv->size);
+        else if (type->is<IR::Type_Boolean>())
+            canon = IR::Type_Boolean::get();
+        else if (type->is<IR::Type_String>())
+            canon = IR::Type_String::get();
+        else
             // all other base types are singletons
             return type;
-        auto canon = IR::Type_Bits::get(tb->size, tb->isSigned);
         if (!typeMap->contains(canon)) typeMap->setType(canon, new IR::Type_Type(canon));
         return canon;
     } else if (type->is<IR::Type_Enum>() || type->is<IR::Type_SerEnum>() ||
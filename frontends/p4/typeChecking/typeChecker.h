@@ -27,7 +27,8 @@ limitations under the License.
 namespace P4 {
 
 // This pass only clears the typeMap if the program has changed
-// or the 'force' flag is set.
+// or the 'force' flag is set.  An incremental typeMap is updated
+// instead, dropping the types of the changed declarations.
 // This is needed if the types of some objects in the program change.
 class ClearTypeMap : public Inspector {
     TypeMap *typeMap;
@@ -43,7 +44,10 @@ class ClearTypeMap : public Inspector {
         // because the program is saved only *after* typechecking,
         // so if the program changes during type-checking, the
         // typeMap may not be complete.
-        if (force || !typeMap->checkMap(program)) typeMap->clear();
+        if (force)
+            typeMap->clear();
+        else if (!typeMap->checkMap(program))
+            typeMap->update(program);
         return false;  // prune()
     }
 };
@@ -82,6 +86,8 @@ class TypeInferenceBase : public virtual Visitor, public ResolutionContext {
     TypeMap *typeMap;
     const IR::Node *initialNode;
     std::shared_ptr<MinimalNameGenerator> nameGen;
+    // typeMap->nodesTyped() when the visit started.
+    size_t typedBefore = 0;
 
  public:
     // Node itself + flag whether we'd prune()
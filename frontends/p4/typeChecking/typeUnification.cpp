@@ -256,6 +256,8 @@ bool TypeUnification::unify(const BinaryConstraint *constraint) {
     if (dest->is<IR::ITypeVar>()) {
         dest = dest->apply(constraints->replaceVariables)->to<IR::Type>();
     }
+    // Equal base types, tuples and stacks are the same canonical node.
+    if (dest == src) return true;
 
     if (auto dsc = dest->to<IR::Type_SpecializedCanonical>()) {
         if (auto ssc = src->to<IR::Type_SpecializedCanonical>()) {
@@ -16,8 +16,58 @@ limitations under the License.
 
 #include "typeMap.h"
 
+#include <set>
+
+#include "lib/hash.h"
+
 namespace P4 {
 
+namespace {
+
+/// Collects the distinct nodes of a top-level object and the names it uses.
+class ScanObject : public Inspector {
+ public:
+    std::vector<const IR::Node *> nodes;
+    std::set<cstring> references;
+
+    bool preorder(const IR::Node *node) override {
+        nodes.push_back(node);
+        return true;
+    }
+    void postorder(const IR::Path *path) override { references.insert(path->name.name); }
+};
+
+/// A hash of @p type that is the same for types that are equivalent in TypeMap::equivalent,
+/// strict or not.  Only the parts of the type that are cheap to hash are hashed.
+size_t structuralHash(const IR::Type *type) {
+    if (type == nullptr) return 0;
+    size_t hash = type->typeId();
+    if (auto *tb = type->to<IR::Type_Bits>()) {
+        return Util::hash_combine(hash, Util::hash_combine(tb->size, tb->isSigned));
+    } else if (auto *tt = type->to<IR::Type_Type>()) {
+        return Util::hash_combine(hash, structuralHash(tt->type));
+    } else if (auto *ts = type->to<IR::Type_Stack>()) {
+        hash = Util::hash_combine(hash, structuralHash(ts->elementType));
+        return ts->sizeKnown() ? Util::hash_combine(hash, ts->getSize()) : hash;
+    } else if (auto *tl = type->to<IR::Type_P4List>()) {
+        return Util::hash_combine(hash, structuralHash(tl->elementType));
+    } else if (auto *tl = type->to<IR::Type_BaseList>()) {
+        for (auto *component : tl->components)
+            hash = Util::hash_combine(hash, structuralHash(component));
+        return hash;
+    } else if (auto *ts = type->to<IR::Type_StructLike>()) {
+        // Names are only compared by strict equivalence.
+        for (auto *field : ts->fields) {
+            hash = Util::hash_combine(hash, Util::Hash{}(field->name.name));
+            hash = Util::hash_combine(hash, structuralHash(field->type));
+        }
+        return hash;
+    }
+    return hash;
+}
+
+}  // namespace
+
 bool TypeMap::typeIsEmpty(const IR::Type *type) const {
     if (auto bt = type->to<IR::Type_Bits>()) {
         return bt->size == 0;
@@ -46,7 +96,9 @@ bool TypeMap::typeIsEmpty(const IR::Type *type) const {
 
 void TypeMap::dbprint(std::ostream &out) const {
     out << "TypeMap for " << dbp(program) << std::endl;
-    for (auto it : typeMap) out << "\t" << dbp(it.first) << "->" << dbp(it.second) << std::endl;
+    typeMap.forEach([&out](const IR::Node *node, const IR::Type *type) {
+        out << "\t" << dbp(node) << "->" << dbp(type) << std::endl;
+    });
     out << "Left values" << std::endl;
     for (auto it : leftValues) out << "\t" << dbp(it) << std::endl;
     out << "Constants" << std::endl;
@@ -87,9 +139,109 @@ void TypeMap::clear() {
     constants.clear();
     allTypeVariables.clear();
     program = nullptr;
+    indexed = nullptr;
+    objects.clear();
+    owners.clear();
+    referrers.clear();
     ProgramMap::clear();
 }
 
+void TypeMap::index(const IR::Node *object) {
+    if (objects.count(object)) return;
+    ScanObject scan;
+    object->apply(scan);
+    auto &info = objects[object];
+    info.nodes = std::move(scan.nodes);
+    info.references.assign(scan.references.begin(), scan.references.end());
+    if (auto *declaration = object->to<IR::IDeclaration>())
+        info.declared.push_back(declaration->getName().name);
+    // Match kinds are used without the name of their declaration.
+    if (auto *matchKind = object->to<IR::Declaration_MatchKind>())
+        for (auto *member : matchKind->members) info.declared.push_back(member->name.name);
+    for (auto *node : info.nodes) ++owners[node];
+    for (auto name : info.references) referrers[name].insert(object);
+}
+
+void TypeMap::unindex(const IR::Node *object) {
+    auto it = objects.find(object);
+    if (it == objects.end()) return;
+    for (auto *node : it->second.nodes) {
+        if (--*owners.find(node) == 0) owners.erase(node);
+    }
+    for (auto name : it->second.references) {
+        auto referrer = referrers.find(name);
+        referrer->second.erase(object);
+        if (referrer->second.empty()) referrers.erase(referrer);
+    }
+    objects.erase(it);
+}
+
+void TypeMap::update(const IR::P4Program *newProgram) {
+    CHECK_NULL(newProgram);
+    if (!incremental || program == nullptr || program == fake) {
+        clear();
+        return;
+    }
+    if (indexed != program) {
+        objects.clear();
+        owners.clear();
+        referrers.clear();
+        for (auto *object : program->objects) index(object);
+    }
+
+    absl::flat_hash_set<const IR::Node *, Util::Hash> current(newProgram->objects.begin(),
+                                                              newProgram->objects.end());
+    absl::flat_hash_set<const IR::Node *, Util::Hash> removed, added, affected;
+    for (auto *object : program->objects)
+        if (!current.count(object)) removed.insert(object);
+    for (auto *object : newProgram->objects)
+        if (!objects.count(object)) added.insert(object);
+
+    // The types of the objects using a name may change with its declaration.
+    std::set<cstring> changed;
+    std::vector<cstring> work;
+    auto declare = [&](cstring name) {
+        if (changed.insert(name).second) work.push_back(name);
+    };
+    for (auto *object : removed)
+        for (auto name : objects.at(object).declared) declare(name);
+    for (auto *object : added) {
+        index(object);
+        for (auto name : objects.at(object).declared) declare(name);
+    }
+    while (!work.empty()) {
+        auto name = work.back();
+        work.pop_back();
+        auto it = referrers.find(name);
+        if (it == referrers.end()) continue;
+        for (auto *object : it->second) {
+            if (removed.count(object) || added.count(object) || !affected.insert(object).second)
+                continue;
+            for (auto declared : objects.at(object).declared) declare(declared);
+        }
+    }
+
+    // Nodes shared with an object that keeps its types keep theirs: type inference does not
+    // revisit them below a parent it finds in the map.
+    absl::flat_hash_map<const IR::Node *, unsigned, Util::Hash> dropped;
+    for (const auto *objectSet : {&removed, &added, &affected})
+        for (auto *object : *objectSet)
+            for (auto *node : objects.at(object).nodes) ++dropped[node];
+    size_t erased = 0;
+    for (auto [node, count] : dropped) {
+        if (*owners.find(node) > count) continue;
+        erased += typeMap.erase(node);
+        if (auto *expression = node->to<IR::Expression>()) {
+            leftValues.erase(expression);
+            constants.erase(expression);
+        }
+    }
+    for (auto *object : removed) unindex(object);
+    indexed = newProgram;
+    LOG2("TypeMap: " << added.size() << " new, " << removed.size() << " removed and "
+                     << affected.size() << " affected objects, " << erased << " types dropped");
+}
+
 void TypeMap::checkPrecondition(const IR::Node *element, const IR::Type *type) const {
     CHECK_NULL(element);
     CHECK_NULL(type);
@@ -99,20 +251,22 @@ void TypeMap::checkPrecondition(const IR::Node *element, const IR::Type *type) c
 
 void TypeMap::setType(const IR::Node *element, const IR::Type *type) {
     checkPrecondition(element, type);
-    auto [it, inserted] = typeMap.emplace(element, type);
+    auto [existing, inserted] = typeMap.emplace(element, type);
     if (!inserted) {
-        const IR::Type *existingType = it->second;
+        const IR::Type *existingType = *existing;
         if (!implicitlyConvertibleTo(type, existingType))
             BUG("Changing type of %1% in type map from %2% to %3%", dbp(element), dbp(existingType),
                 dbp(type));
         return;
     }
+    ++typed;
     LOG3("setType " << dbp(element) << " => " << dbp(type));
 }
 
 const IR::Type *TypeMap::getType(const IR::Node *element, bool notNull) const {
     CHECK_NULL(element);
-    const auto *result = get(typeMap, element);
+    const auto *found = typeMap.find(element);
+    const auto *result = found ? *found : nullptr;
     LOG4("Looking up type for " << dbp(element) << " => " << dbp(result));
     if (notNull && result == nullptr)
         BUG_CHECK(errorCount() > 0, "Could not find type for %1%", dbp(element));
@@ -140,6 +294,7 @@ void TypeMap::addSubstitutions(const TypeVariableSubstitution *tvs) {
 bool TypeMap::equivalent(const IR::Type *left, const IR::Type *right, bool strict) const {
     if (!strict) strict = strictStruct;
     LOG3("Checking equivalence of " << left << " and " << right);
+    // Most canonical types are interned, see TypeInferenceBase::canonicalize.
     if (left == right) return true;
     if (left == nullptr) return right == nullptr;
     if (right == nullptr) return false;
@@ -333,23 +488,15 @@ bool TypeMap::implicitlyConvertibleTo(const IR::Type *from, const IR::Type *to)
 
 // Used for tuples, stacks and lists only
 const IR::Type *TypeMap::getCanonical(const IR::Type *type) {
-    // Currently a linear search; hopefully this won't be too expensive in practice
-    std::vector<const IR::Type *> *searchIn;
-    if (type->is<IR::Type_Stack>())
-        searchIn = &canonicalStacks;
-    else if (type->is<IR::Type_Tuple>())
-        searchIn = &canonicalTuples;
-    else if (type->is<IR::Type_List>())
-        searchIn = &canonicalLists;
-    else if (type->is<IR::Type_P4List>())
-        searchIn = &canonicalP4lists;
-    else
+    if (!type->is<IR::Type_Stack>() && !type->is<IR::Type_Tuple>() &&
+        !type->is<IR::Type_List>() && !type->is<IR::Type_P4List>())
         BUG("%1%: unexpected type", type);
 
-    for (auto t : *searchIn) {
+    auto &candidates = canonicalTypes[structuralHash(type)];
+    for (auto t : candidates) {
         if (equivalent(type, t, true)) return t;
     }
-    searchIn->push_back(type);
+    candidates.push_back(type);
     return type;
 }
 
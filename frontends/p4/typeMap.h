@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "frontends/common/programMap.h"
 #include "frontends/p4/typeChecking/typeSubstitution.h"
+#include "ir/node_side_table.h"
 
 namespace P4 {
 /**
@@ -41,13 +42,11 @@ Objects that have a type in the map:
 class TypeMap final : public ProgramMap {
     // We want to have the same canonical type for two
     // different tuples, lists, stacks, or p4lists with the same signature.
-    std::vector<const IR::Type *> canonicalTuples;
-    std::vector<const IR::Type *> canonicalStacks;
-    std::vector<const IR::Type *> canonicalP4lists;
-    std::vector<const IR::Type *> canonicalLists;
+    // Indexed by a hash that is equal for equivalent types.
+    absl::flat_hash_map<size_t, std::vector<const IR::Type *>> canonicalTypes;
 
     // Map each node to its canonical type
-    absl::flat_hash_map<const IR::Node *, const IR::Type *, Util::Hash> typeMap;
+    NodeSideTable<const IR::Type *> typeMap;
     // All left-values in the program.
     absl::flat_hash_set<const IR::Expression *, Util::Hash> leftValues;
     // All compile-time constants.  A compile-time constant
@@ -61,6 +60,25 @@ class TypeMap final : public ProgramMap {
     // checks some preconditions before setting the type
     void checkPrecondition(const IR::Node *element, const IR::Type *type) const;
 
+    /// The nodes of a top-level object of the program, and the names it declares and uses.
+    struct ObjectInfo {
+        std::vector<const IR::Node *> nodes;
+        std::vector<cstring> declared, references;
+    };
+    bool incremental = false;
+    /// The program whose objects are indexed below, by update().
+    const IR::P4Program *indexed = nullptr;
+    absl::flat_hash_map<const IR::Node *, ObjectInfo, Util::Hash> objects;
+    /// For each node of an indexed object, the number of indexed objects containing it.
+    NodeSideTable<unsigned> owners;
+    /// For each name, the indexed objects using it.
+    absl::flat_hash_map<cstring, absl::flat_hash_set<const IR::Node *, Util::Hash>, Util::Hash>
+        referrers;
+    size_t typed = 0;
+
+    void index(const IR::Node *object);
+    void unindex(const IR::Node *object);
+
  public:
     TypeMap() : ProgramMap("TypeMap"), strictStruct(false) {}
 
@@ -75,6 +93,17 @@ class TypeMap final : public ProgramMap {
     const IR::Type *getTypeType(const IR::Node *element, bool notNull) const;
     void dbprint(std::ostream &out) const override;
     void clear();
+    /// If @p value is true, update() keeps the types of the unchanged parts of a changed
+    /// program instead of clearing the map.
+    void setIncremental(bool value) { incremental = value; }
+    /// Prepares the map for type-checking @p program, which differs from the program the map
+    /// was computed for.  Unless incremental, this is clear().  Otherwise the map keeps the
+    /// nodes of the top-level objects that are in both programs, except for those objects
+    /// that use, directly or through other such objects, a name declared by an object that
+    /// is new or gone.  Type inference then only types the nodes that are not in the map.
+    void update(const IR::P4Program *program);
+    /// The number of nodes given a type since the map was created.
+    size_t nodesTyped() const { return typed; }
     bool isLeftValue(const IR::Expression *expression) const {
         return leftValues.count(expression) > 0;
     }
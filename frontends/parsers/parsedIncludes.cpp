@@ -0,0 +1,203 @@
+#include "frontends/parsers/parsedIncludes.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <fstream>
+#include <optional>
+#include <streambuf>
+#include <system_error>
+
+#include "frontends/common/compilationCache.h"
+#include "frontends/common/parser_options.h"
+#include "ir/binary_reader.h"
+#include "ir/binary_writer.h"
+#include "lib/log.h"
+#include "lib/sha256.h"
+
+namespace P4 {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view symbolsName = "symbols";
+constexpr std::string_view declarationsName = "declarations";
+
+/// A file mapped in memory, read as a stream buffer.
+class MappedFile : public std::streambuf {
+    void *data = MAP_FAILED;
+    size_t size = 0;
+
+ public:
+    explicit MappedFile(const fs::path &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat status;
+        if (fstat(fd, &status) == 0 && status.st_size > 0) {
+            size = static_cast<size_t>(status.st_size);
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (data == MAP_FAILED) return;
+        auto *begin = static_cast<char *>(data);
+        setg(begin, begin, begin + size);
+    }
+    ~MappedFile() override {
+        if (data != MAP_FAILED) munmap(data, size);
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const { return data != MAP_FAILED; }
+};
+
+/// The line number and file name of a line marker, as the lexer reads them: `# N "file"` or
+/// `#line N "file"` at the start of a line.
+std::optional<std::pair<unsigned, std::string_view>> lineMarker(std::string_view line) {
+    size_t pos;
+    if (line.substr(0, 2) == "# ")
+        pos = 2;
+    else if (line.substr(0, 5) == "#line")
+        pos = 5;
+    else
+        return std::nullopt;
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) ++pos;
+    size_t digits = pos;
+    unsigned number = 0;
+    while (pos < line.size() && std::isdigit(static_cast<unsigned char>(line[pos])))
+        number = number * 10 + (line[pos++] - '0');
+    if (pos == digits) return std::nullopt;
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) ++pos;
+    if (pos == line.size() || line[pos] != '"') return std::nullopt;
+    auto close = line.find('"', ++pos);
+    if (close == std::string_view::npos) return std::nullopt;
+    return std::make_pair(number, line.substr(pos, close - pos));
+}
+
+/// True if @p line has only comments and white space, starting inside a block comment if
+/// @p inComment is set, which is updated for the next line.
+bool isBlank(std::string_view line, bool &inComment) {
+    bool blank = true;
+    for (size_t pos = 0; pos < line.size(); ++pos) {
+        if (inComment) {
+            if (line.substr(pos, 2) == "*/") {
+                inComment = false;
+                ++pos;
+            }
+        } else if (line.substr(pos, 2) == "/*") {
+            inComment = true;
+            ++pos;
+        } else if (line.substr(pos, 2) == "//") {
+            break;
+        } else if (line[pos] == '"') {
+            // Skip the string, so that a comment delimiter in it does not count.
+            blank = false;
+            for (++pos; pos < line.size() && line[pos] != '"'; ++pos)
+                if (line[pos] == '\\') ++pos;
+        } else if (!std::isspace(static_cast<unsigned char>(line[pos]))) {
+            blank = false;
+        }
+    }
+    return blank;
+}
+
+}  // namespace
+
+size_t ParsedIncludes::prefixLength(std::string_view program) {
+    size_t length = 0, pos = 0;
+    bool inComment = false, system = false;
+    while (pos < program.size()) {
+        auto end = program.find('\n', pos);
+        auto next = end == std::string_view::npos ? program.size() : end + 1;
+        auto line = program.substr(pos, next - pos);
+        pos = next;
+        if (!inComment && !line.empty() && line[0] == '#') {
+            // The lexer ignores other directives.
+            if (auto marker = lineMarker(line)) {
+                bool wasSystem = system;
+                system = isSystemFile(cstring(marker->second));
+                if (wasSystem && !system) length = next;
+            }
+        } else if (!isBlank(line, inComment) && !system) {
+            break;
+        }
+    }
+    return length;
+}
+
+void ParsedIncludes::appendSources(Util::InputSources *sources, std::string_view prefix) {
+    bool inComment = false;
+    size_t pos = 0;
+    while (pos < prefix.size()) {
+        auto end = prefix.find('\n', pos);
+        auto next = end == std::string_view::npos ? prefix.size() : end;
+        std::string line(prefix.substr(pos, next - pos));
+        sources->appendText(line.c_str());
+        if (!inComment && !line.empty() && line[0] == '#') {
+            if (auto marker = lineMarker(line)) sources->mapLine(marker->second, marker->first);
+        } else {
+            isBlank(line, inComment);
+        }
+        if (next < prefix.size()) sources->appendText("\n");
+        pos = next + 1;
+    }
+}
+
+ParsedIncludes::ParsedIncludes(const fs::path &cacheDirectory, std::string_view prefix,
+                               std::string_view version)
+    : cacheDirectory(cacheDirectory), inputs(CompilationCache::inputs(prefix, {}, version)) {
+    entry = cacheDirectory / ("includes-" + Util::sha256Hex(inputs));
+}
+
+bool ParsedIncludes::load(const Util::InputSources *sources, Util::ProgramStructure &structure,
+                          IR::Vector<IR::Node> &nodes) const {
+    if (!CompilationCache::hasInputs(entry, inputs)) return false;
+    MappedFile declarations(entry / declarationsName);
+    if (!declarations.isOpen()) return false;
+    std::istream in(&declarations);
+    BinaryReader reader(in);
+    reader.setSources(sources);
+    const IR::Node *node = nullptr;
+    reader >> node;
+    const auto *parsed = node ? node->to<IR::Vector<IR::Node>>() : nullptr;
+    std::ifstream symbols(entry / symbolsName);
+    if (!reader || parsed == nullptr || !symbols || !structure.load(symbols, sources)) {
+        LOG1("Parsed include files " << entry << " are unreadable");
+        return false;
+    }
+    nodes.append(*parsed);
+    std::error_code ec;
+    // Evicted along with the compilation cache entries, in order of last use.
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    LOG1("Reusing parsed include files " << entry);
+    return true;
+}
+
+void ParsedIncludes::store(const Util::ProgramStructure &structure,
+                           const IR::Vector<IR::Node> &nodes) const {
+    std::error_code ec;
+    fs::create_directories(cacheDirectory, ec);
+    auto temporary = entry;
+    temporary += ".tmp." + std::to_string(getpid());
+    fs::remove_all(temporary, ec);
+    if (!fs::create_directory(temporary, ec)) return;
+    {
+        std::ofstream out(temporary / declarationsName, std::ios::binary);
+        BinaryWriter(out, false, true).emit(&nodes);
+        std::ofstream symbols(temporary / symbolsName);
+        structure.save(symbols);
+        if (!out || !symbols || !CompilationCache::storeInputs(temporary, inputs)) {
+            fs::remove_all(temporary, ec);
+            return;
+        }
+    }
+    fs::rename(temporary, entry, ec);
+    // Fails if another compilation stored the same entry in between.
+    if (ec) fs::remove_all(temporary, ec);
+}
+
+}  // namespace P4
@@ -0,0 +1,60 @@
+#ifndef FRONTENDS_PARSERS_PARSEDINCLUDES_H_
+#define FRONTENDS_PARSERS_PARSEDINCLUDES_H_
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "frontends/p4/symbol_table.h"
+#include "ir/ir.h"
+
+namespace P4 {
+
+/// The parsed standard include files at the start of a program, kept in the --cache-dir
+/// directory by an earlier compilation.
+///
+/// Nearly every program starts by including core.p4 and the include file of its architecture,
+/// which are longer than many programs.  The parser takes the top-level declarations of that
+/// prefix of the preprocessed program from the cache instead of parsing it: the declarations
+/// are read in the binary IR format from a memory-mapped file, along with the symbols the
+/// parser had declared for them, which the lexer needs to tell type names from other
+/// identifiers in the rest of the program.  Entries are keyed by the text of the prefix, line
+/// markers included, so the source positions of the declarations stay valid.  Each entry keeps
+/// that text, and is only used if it is equal to the prefix of the current program.
+///
+/// Only parsing is saved: the declarations are type-checked along with the rest of the program
+/// by the frontend, which works on the whole program.
+class ParsedIncludes {
+ public:
+    /// Length of the prefix of the preprocessed @p program that ends where it returns from the
+    /// last standard include file before its own first declaration, or 0.  Outside of the
+    /// standard include files the prefix has only comments, blank lines and line markers.
+    static size_t prefixLength(std::string_view program);
+
+    /// Appends the text of @p prefix to @p sources as the lexer does while reading it.
+    static void appendSources(Util::InputSources *sources, std::string_view prefix);
+
+    /// @p prefix is the prefix of a program given by prefixLength(), and @p version identifies
+    /// the compiler.
+    ParsedIncludes(const std::filesystem::path &cacheDirectory, std::string_view prefix,
+                   std::string_view version);
+
+    /// Declares the cached symbols in @p structure and appends the cached declarations to
+    /// @p nodes, with their positions in @p sources.  @return false if there is no usable entry,
+    /// in which case @p structure may have changed.
+    bool load(const Util::InputSources *sources, Util::ProgramStructure &structure,
+              IR::Vector<IR::Node> &nodes) const;
+    /// Saves the state of the parser at the end of the prefix.
+    void store(const Util::ProgramStructure &structure, const IR::Vector<IR::Node> &nodes) const;
+
+ private:
+    std::filesystem::path cacheDirectory;
+    /// The prefix and compiler version, as CompilationCache::inputs().
+    std::string inputs;
+    std::filesystem::path entry;
+};
+
+}  // namespace P4
+
+#endif /* FRONTENDS_PARSERS_PARSEDINCLUDES_H_ */
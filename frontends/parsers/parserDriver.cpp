@@ -10,6 +10,7 @@
 
 #include "frontends/common/constantFolding.h"
 #include "frontends/common/options.h"
+#include "frontends/parsers/parsedIncludes.h"
 #include "frontends/parsers/p4/p4AnnotationLexer.hpp"
 #include "frontends/parsers/p4/p4lexer.hpp"
 #include "frontends/parsers/p4/p4parser.hpp"
@@ -119,6 +120,12 @@ P4ParserDriver::P4ParserDriver()
 
 bool P4ParserDriver::parse(AbstractP4Lexer &lexer, std::string_view sourceFile,
                            unsigned sourceLine /* = 1 */) {
+    // Provide an initial source location.
+    sources->mapLine(sourceFile, sourceLine);
+    return parse(lexer);
+}
+
+bool P4ParserDriver::parse(AbstractP4Lexer &lexer) {
     // Create and configure the parser.
     P4Parser parser(*this, lexer);
 
@@ -127,9 +134,6 @@ bool P4ParserDriver::parse(AbstractP4Lexer &lexer, std::string_view sourceFile,
     structure->setDebug(parser.debug_level() != 0);
 #endif
 
-    // Provide an initial source location.
-    sources->mapLine(sourceFile, sourceLine);
-
     // Parse.
     if (parser.parse() != 0) return false;
     structure->endParse();
@@ -175,6 +179,46 @@ P4ParserDriver::parseProgramSources(FILE *in, std::string_view sourceFile,
     return parseProgramSources(inputStream.get(), sourceFile, sourceLine);
 }
 
+/* static */ const IR::P4Program *P4ParserDriver::parseWithCachedIncludes(
+    std::string_view program, std::string_view sourceFile,
+    const std::filesystem::path &cacheDirectory, std::string_view version) {
+    auto length = ParsedIncludes::prefixLength(program);
+    if (cacheDirectory.empty() || length == 0) {
+        std::istringstream in{std::string(program)};
+        return parse(in, sourceFile);
+    }
+    LOG1("Parsing P4-16 program " << sourceFile);
+
+    auto prefix = program.substr(0, length);
+    ParsedIncludes includes(cacheDirectory, prefix, version);
+    P4ParserDriver driver;
+    driver.sources->mapLine(sourceFile, 1);
+    ParsedIncludes::appendSources(driver.sources, prefix);
+    if (includes.load(driver.sources, *driver.structure, *driver.nodes)) {
+        // Later error declarations are merged into this one.
+        for (auto &node : *driver.nodes) {
+            if (const auto *error = node->to<IR::Type_Error>()) {
+                driver.allErrors = error->clone();
+                node = driver.allErrors;
+            }
+        }
+    } else {
+        driver = P4ParserDriver();
+        auto diagnostics = ::P4::diagnosticCount();
+        std::istringstream in{std::string(prefix)};
+        P4Lexer lexer(in);
+        if (!driver.parse(lexer, sourceFile)) return nullptr;
+        // Reusing the declarations must not hide a warning.
+        if (::P4::diagnosticCount() == diagnostics)
+            includes.store(*driver.structure, *driver.nodes);
+    }
+
+    std::istringstream in{std::string(program.substr(length))};
+    P4Lexer lexer(in);
+    if (!driver.parse(lexer)) return nullptr;
+    return new IR::P4Program(driver.nodes->srcInfo, *driver.nodes);
+}
+
 template <typename T>
 const T *P4ParserDriver::parse(P4AnnotationLexer::Type type, const Util::SourceInfo &srcInfo,
                                const IR::Vector<IR::AnnotationToken> &body) {
@@ -18,6 +18,7 @@ limitations under the License.
 #define FRONTENDS_PARSERS_PARSERDRIVER_H_
 
 #include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <string_view>
@@ -124,6 +125,14 @@ class P4ParserDriver final : public AbstractParserDriver {
     static std::pair<const IR::P4Program *, const Util::InputSources *> parseProgramSources(
         FILE *in, std::string_view sourceFile, unsigned sourceLine = 1);
 
+    /// Parses the preprocessed @p program like parse(), but takes the standard include files it
+    /// starts with from @p cacheDirectory when an earlier compilation parsed the same ones, and
+    /// saves them there otherwise, see ParsedIncludes.  @p version identifies the compiler.
+    static const IR::P4Program *parseWithCachedIncludes(std::string_view program,
+                                                        std::string_view sourceFile,
+                                                        const std::filesystem::path &cacheDirectory,
+                                                        std::string_view version);
+
     /**
      * Parses a P4-16 annotation body.
      *
@@ -214,6 +223,8 @@ class P4ParserDriver final : public AbstractParserDriver {
 
     /// Common functionality for parsing.
     bool parse(AbstractP4Lexer &lexer, std::string_view sourceFile, unsigned sourceLine = 1);
+    /// Parses the input of @p lexer as a continuation of what was parsed so far.
+    bool parse(AbstractP4Lexer &lexer);
 
     /// Common functionality for parsing annotation bodies.
     template <typename T>
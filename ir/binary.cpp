@@ -0,0 +1,212 @@
+#include <istream>
+#include <ostream>
+
+#include "frontends/common/constantParsing.h"
+#include "ir/binary_reader.h"
+#include "ir/binary_writer.h"
+
+namespace P4 {
+
+BinaryWriter::BinaryWriter(std::ostream &out, bool dumpSourceInfo, bool dumpPositions)
+    : out(out), dumpSourceInfo(dumpSourceInfo && !dumpPositions), dumpPositions(dumpPositions) {
+    put(Binary::magic, sizeof(Binary::magic));
+    writeVarint(Binary::version);
+    writeVarint((this->dumpSourceInfo ? Binary::hasSourceInfo : 0) |
+                (dumpPositions ? Binary::hasPositions : 0));
+}
+
+void BinaryWriter::emit(const IR::Node *node) {
+    writeNode(node);
+    flush();
+}
+
+void BinaryWriter::flush() {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void BinaryWriter::writeNode(const IR::Node *node) {
+    if (node == nullptr) {
+        writeVarint(Binary::Null);
+        return;
+    }
+    auto [it, inserted] = nodes.emplace(node, nodes.size());
+    if (!inserted) {
+        writeVarint(it->second + Binary::FirstIndex);
+        return;
+    }
+    writeVarint(Binary::New);
+    auto type = typeNames.find(typeid(*node));
+    if (type == typeNames.end())
+        type = typeNames.emplace(typeid(*node), node->node_type_name()).first;
+    write(type->second);
+    node->toBinary(*this);
+    if (dumpSourceInfo || dumpPositions) node->sourceInfoToBinary(*this);
+    // Keep memory use flat while writing large programs.
+    if (buffer.size() >= (1 << 16)) flush();
+}
+
+void BinaryWriter::write(cstring v) {
+    if (v.isNull()) {
+        writeVarint(Binary::Null);
+        return;
+    }
+    auto [it, inserted] = strings.emplace(v.c_str(), strings.size());
+    if (!inserted) {
+        writeVarint(it->second + Binary::FirstIndex);
+        return;
+    }
+    writeVarint(Binary::New);
+    writeVarint(v.size());
+    put(v.c_str(), v.size());
+}
+
+void BinaryWriter::write(const UnparsedConstant *v) {
+    write(v != nullptr);
+    if (v == nullptr) return;
+    write(v->text);
+    write(v->skip);
+    write(v->base);
+    write(v->hasWidth);
+}
+
+BinaryReader::BinaryReader(std::istream &in) : in(in), buffer(1 << 16) {
+    char magic[sizeof(Binary::magic)];
+    get(magic, sizeof(magic));
+    if (!valid || memcmp(magic, Binary::magic, sizeof(magic)) != 0) {
+        fail();
+        return;
+    }
+    if (readVarint() != Binary::version) fail();
+    auto flags = readVarint();
+    positions = flags & Binary::hasPositions;
+    sourceInfo = positions || (flags & Binary::hasSourceInfo);
+}
+
+void BinaryReader::setSources(const Util::InputSources *sources,
+                              std::function<unsigned(unsigned)> mapLine) {
+    this->sources = sources;
+    this->mapLine = std::move(mapLine);
+}
+
+Util::SourceInfo BinaryReader::readPosition() {
+    unsigned startLine = 0, startColumn = 0, endLine = 0, endColumn = 0;
+    read(startLine);
+    read(startColumn);
+    read(endLine);
+    read(endColumn);
+    if (sources == nullptr || startLine == 0) return {};
+    if (mapLine) {
+        startLine = mapLine(startLine);
+        endLine = mapLine(endLine);
+    }
+    if (startLine == 0 || endLine == 0) return {};
+    Util::SourcePosition start(startLine, startColumn), end(endLine, endColumn);
+    if (end < start) return {};
+    return Util::SourceInfo(sources, start, end);
+}
+
+bool BinaryReader::refill() {
+    if (!in) return false;
+    in.read(buffer.data(), buffer.size());
+    pos = 0;
+    end = in.gcount();
+    return end > 0;
+}
+
+void BinaryReader::get(void *data, size_t size) {
+    auto *to = static_cast<char *>(data);
+    while (size > 0) {
+        if (atEnd()) {
+            fail();
+            memset(to, 0, size);
+            return;
+        }
+        size_t n = std::min(size, end - pos);
+        memcpy(to, buffer.data() + pos, n);
+        pos += n;
+        to += n;
+        size -= n;
+    }
+}
+
+int64_t BinaryReader::readString() {
+    auto tag = readVarint();
+    if (tag == Binary::Null || !valid) return -1;
+    if (tag == Binary::New) {
+        auto size = readVarint();
+        // Guards against allocating huge strings for corrupted input.
+        if (size > (uint64_t(1) << 32)) {
+            fail();
+            return -1;
+        }
+        std::string text(size, '\0');
+        get(text.data(), size);
+        strings.push_back(cstring(text));
+        return strings.size() - 1;
+    }
+    if (tag - Binary::FirstIndex >= strings.size()) {
+        fail();
+        return -1;
+    }
+    return tag - Binary::FirstIndex;
+}
+
+IR::Node *BinaryReader::readNode(BinaryNodeFactoryFn fallback) {
+    auto tag = readVarint();
+    if (tag == Binary::Null || !valid) return nullptr;
+    if (tag != Binary::New) {
+        if (tag - Binary::FirstIndex >= nodes.size() || !nodes[tag - Binary::FirstIndex]) {
+            // A reference to a node that is not complete yet cannot occur in a tree.
+            fail();
+            return nullptr;
+        }
+        return nodes[tag - Binary::FirstIndex];
+    }
+
+    auto type = readString();
+    if (type < 0) {
+        fail();
+        return nullptr;
+    }
+    if (factories.size() <= static_cast<size_t>(type)) factories.resize(strings.size());
+    auto &factory = factories[type];
+    if (!factory) {
+        auto it = IR::binary_unpacker_table.find(strings[type]);
+        if (it != IR::binary_unpacker_table.end()) factory = it->second;
+    }
+    auto *create = factory ? factory : fallback;
+    if (!create) {
+        fail();
+        return nullptr;
+    }
+
+    // Nodes are numbered in the order they are started, as in the writer.
+    size_t index = nodes.size();
+    nodes.push_back(nullptr);
+    auto *node = create(*this);
+    if (sourceInfo) node->sourceInfoFromBinary(*this);
+    nodes[index] = node;
+    return node;
+}
+
+BinaryReader &BinaryReader::operator>>(const IR::Node *&node) {
+    node = valid && !atEnd() ? readNode(nullptr) : nullptr;
+    if (!valid) node = nullptr;
+    return *this;
+}
+
+void BinaryReader::read(big_int &v) {
+    auto header = readVarint();
+    std::vector<unsigned char> bytes(header >> 1);
+    if (bytes.size() > (1 << 16)) {
+        fail();
+        return;
+    }
+    get(bytes.data(), bytes.size());
+    v = 0;
+    if (!bytes.empty()) boost::multiprecision::import_bits(v, bytes.begin(), bytes.end(), 8);
+    if (header & 1) v = -v;
+}
+
+}  // namespace P4
@@ -0,0 +1,353 @@
+#ifndef IR_BINARY_READER_H_
+#define IR_BINARY_READER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "ir/binary_writer.h"
+#include "ir/ir.h"
+#include "ir/json_loader.h"
+
+namespace P4 {
+
+namespace Binary {
+
+template <typename T, typename = void>
+struct has_fromBinary : std::false_type {};
+template <typename T>
+struct has_fromBinary<T, std::void_t<decltype(&T::fromBinary)>> : std::true_type {};
+
+}  // namespace Binary
+
+/// Reads what BinaryWriter wrote, see ir/binary_writer.h.  Malformed input does not crash the
+/// reader: it reads zeros and null pointers from then on and converts to false.
+class BinaryReader {
+    std::istream &in;
+    bool sourceInfo = false;
+    bool positions = false;
+    const Util::InputSources *sources = nullptr;
+    std::function<unsigned(unsigned)> mapLine;
+    bool valid = true;
+    std::vector<char> buffer;
+    size_t pos = 0, end = 0;
+    std::vector<IR::Node *> nodes;
+    std::vector<cstring> strings;
+    /// Factories of the node types read so far, by the index of their name in strings.
+    std::vector<BinaryNodeFactoryFn> factories;
+
+    bool refill();
+    bool atEnd() { return pos == end && !refill(); }
+    int get() {
+        if (atEnd()) return -1;
+        return static_cast<unsigned char>(buffer[pos++]);
+    }
+    void get(void *data, size_t size);
+    void fail() { valid = false; }
+
+    /// Index in strings of the string read, or -1 for a null string.
+    int64_t readString();
+    /// @p fallback builds the node if its type is not in binary_unpacker_table, as the
+    /// instances of the container templates may not be.
+    IR::Node *readNode(BinaryNodeFactoryFn fallback);
+    template <typename T>
+    static BinaryNodeFactoryFn factoryOf() {
+        if constexpr (Binary::has_fromBinary<T>::value)
+            return [](BinaryReader &in) -> IR::Node * { return T::fromBinary(in); };
+        else
+            return nullptr;
+    }
+    template <typename C>
+    void readSequence(C &c) {
+        c.clear();
+        auto size = readVarint();
+        for (uint64_t i = 0; i < size && valid; ++i) {
+            typename C::value_type el{};
+            read(el);
+            c.push_back(std::move(el));
+        }
+    }
+    template <typename T, typename C>
+    void readSet(C &c) {
+        c.clear();
+        auto size = readVarint();
+        for (uint64_t i = 0; i < size && valid; ++i) {
+            T el{};
+            read(el);
+            c.insert(std::move(el));
+        }
+    }
+    template <typename K, typename V, typename C>
+    void readMap(C &c) {
+        c.clear();
+        auto size = readVarint();
+        for (uint64_t i = 0; i < size && valid; ++i) {
+            std::pair<K, V> el{};
+            read(el);
+            c.emplace(std::move(el.first), std::move(el.second));
+        }
+    }
+    template <size_t N, class Variant>
+    void readVariant(size_t index, Variant &v) {
+        if constexpr (N < std::variant_size_v<Variant>) {
+            if (index == N)
+                read(v.template emplace<N>());
+            else
+                readVariant<N + 1>(index, v);
+        } else {
+            fail();
+        }
+    }
+
+ public:
+    /// Reads the header; the reader converts to false if it is not a binary IR stream of the
+    /// current version.
+    explicit BinaryReader(std::istream &in);
+    BinaryReader(const BinaryReader &) = delete;
+    BinaryReader &operator=(const BinaryReader &) = delete;
+
+    explicit operator bool() const { return valid; }
+
+    /// For streams written with positions: the positions are read as positions in @p sources,
+    /// with their line numbers translated by @p mapLine if given.  Positions that @p mapLine
+    /// maps to line 0, and all positions if no sources are set, are dropped.
+    void setSources(const Util::InputSources *sources,
+                    std::function<unsigned(unsigned)> mapLine = nullptr);
+    bool hasPositions() const { return positions; }
+    /// Reads a position written by BinaryWriter in positions mode.
+    Util::SourceInfo readPosition();
+
+    uint64_t readVarint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64 && valid; shift += 7) {
+            int c = get();
+            if (c < 0) break;
+            v |= static_cast<uint64_t>(c & 0x7f) << shift;
+            if (!(c & 0x80)) return v;
+        }
+        fail();
+        return 0;
+    }
+
+    void read(bool &v) {
+        int c = get();
+        if (c < 0) fail();
+        v = c > 0;
+    }
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T>> read(T &v) {
+        v = static_cast<T>(readVarint());
+    }
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>> read(T &v) {
+        auto u = readVarint();
+        v = static_cast<T>(static_cast<int64_t>((u >> 1) ^ (~(u & 1) + 1)));
+    }
+    template <typename T>
+    std::enable_if_t<std::is_enum_v<T>> read(T &v) {
+        std::underlying_type_t<T> u{};
+        read(u);
+        v = static_cast<T>(u);
+    }
+    void read(double &v) {
+        uint64_t bits = 0;
+        get(&bits, sizeof(bits));
+        memcpy(&v, &bits, sizeof(v));
+    }
+    void read(big_int &v);
+    void read(cstring &v) {
+        auto index = readString();
+        v = index < 0 ? cstring() : strings[index];
+    }
+    void read(std::string &v) {
+        auto index = readString();
+        v = index < 0 ? std::string() : strings[index].string();
+    }
+    void read(IR::ID &v) {
+        read(v.name);
+        read(v.originalName);
+    }
+    void read(bitvec &v) {
+        cstring text;
+        read(text);
+        if (text) text.c_str() >> v;
+    }
+    void read(LTBitMatrix &v) {
+        cstring text;
+        read(text);
+        if (text) text.c_str() >> v;
+    }
+    void read(match_t &v) {
+        read(v.word0);
+        read(v.word1);
+    }
+    void read(UnparsedConstant *&v) {
+        bool present = false;
+        read(present);
+        v = nullptr;
+        if (!present) return;
+        v = new UnparsedConstant{cstring::empty, 0, 0, false};
+        read(v->text);
+        read(v->skip);
+        read(v->base);
+        read(v->hasWidth);
+    }
+    template <RangeUnit Unit, Endian Order>
+    void read(HalfOpenRange<Unit, Order> &v) {
+        read(v.lo);
+        read(v.hi);
+    }
+    template <RangeUnit Unit, Endian Order>
+    void read(ClosedRange<Unit, Order> &v) {
+        read(v.lo);
+        read(v.hi);
+    }
+
+    template <typename T>
+    void read(safe_vector<T> &v) {
+        readSequence(v);
+    }
+    template <typename T, typename A>
+    void read(std::vector<T, A> &v) {
+        readSequence(v);
+    }
+    template <typename T, size_t N>
+    void read(T (&v)[N]) {
+        for (auto &el : v) read(el);
+    }
+    template <typename T, typename U>
+    void read(std::pair<T, U> &v) {
+        read(v.first);
+        read(v.second);
+    }
+    template <typename T>
+    void read(std::optional<T> &v) {
+        bool present = false;
+        read(present);
+        if (present)
+            read(v.emplace());
+        else
+            v = std::nullopt;
+    }
+    template <class... Types>
+    void read(std::variant<Types...> &v) {
+        readVariant<0>(readVarint(), v);
+    }
+    template <typename T, typename C, typename A>
+    void read(std::set<T, C, A> &v) {
+        readSet<T>(v);
+    }
+    template <typename T, typename C, typename A>
+    void read(ordered_set<T, C, A> &v) {
+        readSet<T>(v);
+    }
+    template <typename K, typename V, typename C, typename A>
+    void read(std::map<K, V, C, A> &v) {
+        readMap<K, V>(v);
+    }
+    template <typename K, typename V, typename C, typename A>
+    void read(std::multimap<K, V, C, A> &v) {
+        readMap<K, V>(v);
+    }
+    template <typename K, typename V, typename C, typename A>
+    void read(ordered_map<K, V, C, A> &v) {
+        readMap<K, V>(v);
+    }
+    template <typename V>
+    void read(string_map<V> &v) {
+        readMap<cstring, V>(v);
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_base_of_v<IR::Node, T>> read(T &v) {
+        auto *node = readNode(factoryOf<T>());
+        if (auto *t = node ? node->template to<T>() : nullptr)
+            v = *t;
+        else
+            fail();
+    }
+    template <typename T>
+    std::enable_if_t<std::is_base_of_v<IR::INode, T>> read(const T *&v) {
+        auto *node = readNode(factoryOf<T>());
+        v = node ? node->template to<T>() : nullptr;
+        if (node && !v) fail();
+    }
+
+    template <typename T>
+    std::enable_if_t<Binary::has_fromBinary<T>::value && !std::is_base_of_v<IR::INode, T>> read(
+        T &v) {
+        if constexpr (std::is_pointer_v<decltype(T::fromBinary(std::declval<BinaryReader &>()))>)
+            v = *T::fromBinary(*this);
+        else
+            v = T::fromBinary(*this);
+    }
+    template <typename T>
+    std::enable_if_t<Binary::has_fromBinary<T>::value && !std::is_base_of_v<IR::INode, T>> read(
+        T *&v) {
+        bool present = false;
+        read(present);
+        v = present ? T::fromBinary(*this) : nullptr;
+    }
+    template <typename T>
+    std::enable_if_t<Binary::has_toJSON<T>::value && !Binary::has_fromBinary<T>::value &&
+                     !std::is_base_of_v<IR::INode, T>>
+    read(T &v) {
+        std::string text;
+        read(text);
+        std::stringstream stream(text);
+        JSONLoader loader(stream);
+        if (loader) loader >> v;
+    }
+
+    /// Reads the next root node.  Gives null at the end of the stream, and if the stream is
+    /// malformed (in which case the reader also converts to false).
+    BinaryReader &operator>>(const IR::Node *&node);
+    template <typename T>
+    BinaryReader &operator>>(T &v) {
+        read(v);
+        return *this;
+    }
+};
+
+template <class T>
+IR::Vector<T>::Vector(BinaryReader &in) : VectorBase(in) {
+    in.read(vec);
+}
+template <class T>
+IR::Vector<T> *IR::Vector<T>::fromBinary(BinaryReader &in) {
+    return new Vector<T>(in);
+}
+template <class T>
+IR::IndexedVector<T>::IndexedVector(BinaryReader &in) : Vector<T>(in) {
+    in.read(declarations);
+}
+template <class T>
+IR::IndexedVector<T> *IR::IndexedVector<T>::fromBinary(BinaryReader &in) {
+    return new IndexedVector<T>(in);
+}
+template <class T, template <class K, class V, class COMP, class ALLOC> class MAP /*= std::map */,
+          class COMP /*= std::less<cstring>*/,
+          class ALLOC /*= std::allocator<std::pair<cstring, const T*>>*/>
+IR::NameMap<T, MAP, COMP, ALLOC>::NameMap(BinaryReader &in) : Node(in) {
+    in.read(symbols);
+}
+template <class T, template <class K, class V, class COMP, class ALLOC> class MAP /*= std::map */,
+          class COMP /*= std::less<cstring>*/,
+          class ALLOC /*= std::allocator<std::pair<cstring, const T*>>*/>
+IR::NameMap<T, MAP, COMP, ALLOC> *IR::NameMap<T, MAP, COMP, ALLOC>::fromBinary(BinaryReader &in) {
+    return new IR::NameMap<T, MAP, COMP, ALLOC>(in);
+}
+
+}  // namespace P4
+
+#endif /* IR_BINARY_READER_H_ */
@@ -0,0 +1,264 @@
+#ifndef IR_BINARY_WRITER_H_
+#define IR_BINARY_WRITER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ir/id.h"
+#include "ir/json_generator.h"
+#include "ir/node.h"
+#include "lib/big_int.h"
+#include "lib/bitrange.h"
+#include "lib/bitvec.h"
+#include "lib/cstring.h"
+#include "lib/ltbitmatrix.h"
+#include "lib/match.h"
+#include "lib/ordered_map.h"
+#include "lib/ordered_set.h"
+#include "lib/safe_vector.h"
+#include "lib/string_map.h"
+
+namespace P4 {
+
+struct UnparsedConstant;
+
+/// Compact binary alternative to JSONGenerator/JSONLoader for IR snapshots.
+///
+/// A stream starts with a short header and then holds any number of root nodes.  Fields are
+/// written in declaration order without names: integers as varints, strings as references into
+/// a string table and nodes as references into a node table.  Both tables are built as the
+/// stream is written -- the first use of a string or node writes it in full and appends it to
+/// its table, later uses refer back to it -- so neither side ever holds more than the tables
+/// and the IR itself.  The per-class methods (toBinary, a constructor from BinaryReader and
+/// fromBinary) are generated from the .def files like the JSON ones.
+///
+/// There is no schema: a stream can only be read by a compiler built from the same .def files.
+namespace Binary {
+
+inline constexpr char magic[4] = {'P', '4', 'I', 'R'};
+inline constexpr uint64_t version = 1;
+
+/// Header flag: each node is followed by its source position.
+inline constexpr uint64_t hasSourceInfo = 1;
+/// Header flag: each node is followed by its position in the preprocessed program instead,
+/// which only a reader given the sources of that program can use (BinaryReader::setSources).
+inline constexpr uint64_t hasPositions = 2;
+
+/// Node and string references: 0 is null, 1 introduces a new entry, n >= 2 refers back to entry
+/// n - 2.
+enum : uint64_t { Null = 0, New = 1, FirstIndex = 2 };
+
+template <typename T, typename = void>
+struct has_toBinary : std::false_type {};
+template <typename T>
+struct has_toBinary<T, std::void_t<decltype(&T::toBinary)>> : std::true_type {};
+
+template <typename T, typename = void>
+struct has_toJSON : std::false_type {};
+template <typename T>
+struct has_toJSON<T, std::void_t<decltype(&T::toJSON)>> : std::true_type {};
+
+}  // namespace Binary
+
+class BinaryWriter {
+    std::ostream &out;
+    bool dumpSourceInfo;
+    bool dumpPositions;
+    std::string buffer;
+    absl::flat_hash_map<const IR::Node *, uint64_t> nodes;
+    /// Interned strings, by address.
+    absl::flat_hash_map<const char *, uint64_t> strings;
+    /// node_type_name() builds the names of template classes on every call.
+    absl::flat_hash_map<std::type_index, cstring> typeNames;
+
+    void put(char c) { buffer.push_back(c); }
+    void put(const void *data, size_t size) {
+        buffer.append(static_cast<const char *>(data), size);
+    }
+    void writeNode(const IR::Node *node);
+    template <typename C>
+    void writeSequence(const C &c) {
+        writeVarint(c.size());
+        for (auto &el : c) write(el);
+    }
+
+ public:
+    explicit BinaryWriter(std::ostream &out, bool dumpSourceInfo = false,
+                          bool dumpPositions = false);
+    ~BinaryWriter() { flush(); }
+    BinaryWriter(const BinaryWriter &) = delete;
+    BinaryWriter &operator=(const BinaryWriter &) = delete;
+
+    /// Appends the tree rooted at @p node.  Nodes written by earlier calls are referred to
+    /// rather than repeated.
+    void emit(const IR::Node *node);
+    /// Passes everything written so far on to the output stream.
+    void flush();
+    /// True if source positions are written as positions in the preprocessed program.
+    bool positions() const { return dumpPositions; }
+
+    void writeVarint(uint64_t v) {
+        while (v >= 0x80) {
+            put(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        put(static_cast<char>(v));
+    }
+
+    void write(bool v) { put(v ? 1 : 0); }
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T>> write(T v) {
+        writeVarint(v);
+    }
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>> write(T v) {
+        // Zigzag encoding, so that small negative numbers stay short.
+        auto s = static_cast<int64_t>(v);
+        writeVarint((static_cast<uint64_t>(s) << 1) ^ static_cast<uint64_t>(s >> 63));
+    }
+    template <typename T>
+    std::enable_if_t<std::is_enum_v<T>> write(T v) {
+        write(static_cast<std::underlying_type_t<T>>(v));
+    }
+    void write(double v) {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        put(&bits, sizeof(bits));
+    }
+    template <typename T>
+    std::enable_if_t<std::is_same_v<T, big_int>> write(const T &v) {
+        std::vector<unsigned char> bytes;
+        if (v != 0)
+            boost::multiprecision::export_bits(big_int(abs(v)), std::back_inserter(bytes), 8);
+        writeVarint(bytes.size() << 1 | (v < 0 ? 1 : 0));
+        put(bytes.data(), bytes.size());
+    }
+    void write(cstring v);
+    void write(const std::string &v) { write(cstring(v)); }
+    void write(const IR::ID &v) {
+        write(v.name);
+        write(v.originalName);
+    }
+    void write(const bitvec &v) {
+        std::stringstream text;
+        text << v;
+        write(text.str());
+    }
+    void write(const LTBitMatrix &v) {
+        std::stringstream text;
+        text << v;
+        write(text.str());
+    }
+    void write(const match_t &v) {
+        write(v.word0);
+        write(v.word1);
+    }
+    void write(const UnparsedConstant *v);
+    template <RangeUnit Unit, Endian Order>
+    void write(const HalfOpenRange<Unit, Order> &v) {
+        write(v.lo);
+        write(v.hi);
+    }
+    template <RangeUnit Unit, Endian Order>
+    void write(const ClosedRange<Unit, Order> &v) {
+        write(v.lo);
+        write(v.hi);
+    }
+
+    template <typename T>
+    void write(const safe_vector<T> &v) {
+        writeSequence(v);
+    }
+    template <typename T, typename A>
+    void write(const std::vector<T, A> &v) {
+        writeSequence(v);
+    }
+    template <typename T, size_t N>
+    void write(const T (&v)[N]) {
+        for (auto &el : v) write(el);
+    }
+    template <typename T, typename U>
+    void write(const std::pair<T, U> &v) {
+        write(v.first);
+        write(v.second);
+    }
+    template <typename T>
+    void write(const std::optional<T> &v) {
+        write(v.has_value());
+        if (v) write(*v);
+    }
+    template <class... Types>
+    void write(const std::variant<Types...> &v) {
+        writeVarint(v.index());
+        std::visit([this](auto &value) { this->write(value); }, v);
+    }
+    template <typename T, typename C, typename A>
+    void write(const std::set<T, C, A> &v) {
+        writeSequence(v);
+    }
+    template <typename T, typename C, typename A>
+    void write(const ordered_set<T, C, A> &v) {
+        writeSequence(v);
+    }
+    template <typename K, typename V, typename C, typename A>
+    void write(const std::map<K, V, C, A> &v) {
+        writeSequence(v);
+    }
+    template <typename K, typename V, typename C, typename A>
+    void write(const std::multimap<K, V, C, A> &v) {
+        writeSequence(v);
+    }
+    template <typename K, typename V, typename C, typename A>
+    void write(const ordered_map<K, V, C, A> &v) {
+        writeSequence(v);
+    }
+    template <typename V>
+    void write(const string_map<V> &v) {
+        writeSequence(v);
+    }
+
+    /// Nodes held by value (inline fields) are written like pointers to them.
+    void write(const IR::Node &v) { writeNode(&v); }
+    template <typename T>
+    std::enable_if_t<std::is_base_of_v<IR::INode, T>> write(const T *v) {
+        writeNode(v ? v->getNode() : nullptr);
+    }
+
+    /// Other classes with a toBinary method, such as the nested classes of the .def files.
+    template <typename T>
+    std::enable_if_t<Binary::has_toBinary<T>::value && !std::is_base_of_v<IR::INode, T>> write(
+        const T &v) {
+        v.toBinary(*this);
+    }
+    template <typename T>
+    std::enable_if_t<Binary::has_toBinary<T>::value && !std::is_base_of_v<IR::INode, T>> write(
+        const T *v) {
+        write(v != nullptr);
+        if (v) v->toBinary(*this);
+    }
+    /// Classes that only know how to write themselves as JSON are embedded as JSON text.
+    template <typename T>
+    std::enable_if_t<Binary::has_toJSON<T>::value && !Binary::has_toBinary<T>::value &&
+                     !std::is_base_of_v<IR::INode, T>>
+    write(const T &v) {
+        std::stringstream text;
+        JSONGenerator(text).emit(v);
+        write(text.str());
+    }
+};
+
+}  // namespace P4
+
+#endif /* IR_BINARY_WRITER_H_ */
@@ -14,6 +14,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 #include <ostream>
 
 #include "absl/container/flat_hash_map.h"
@@ -157,6 +160,10 @@ const IR::Constant *IR::Constant::get(const IR::Type *t, big_int v, Util::Source
     // Constants are interned. Keys in the intern map are pairs of types and values.
     using key_t = std::tuple<int, RTTI::TypeId, bool, big_int>;
     static absl::flat_hash_map<key_t, const Constant *, Util::Hash> CONSTANTS;
+#ifdef MULTITHREAD
+    static std::mutex CONSTANTS_lock;
+    std::lock_guard<std::mutex> guard(CONSTANTS_lock);
+#endif  // MULTITHREAD
 
     auto *&result = CONSTANTS[{tb->width_bits(), t->typeId(), tb->isSigned, v}];
     if (result == nullptr) {
@@ -186,6 +193,10 @@ const IR::StringLiteral *IR::StringLiteral::get(cstring value, const IR::Type *t
     // String literals are interned.
     using key_t = std::pair<cstring, const IR::Type *>;
     static absl::flat_hash_map<key_t, const IR::StringLiteral *, Util::Hash> STRINGS;
+#ifdef MULTITHREAD
+    static std::mutex STRINGS_lock;
+    std::lock_guard<std::mutex> guard(STRINGS_lock);
+#endif  // MULTITHREAD
 
     auto *&result = STRINGS[{value, t}];
     if (result == nullptr) {
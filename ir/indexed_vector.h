@@ -27,6 +27,7 @@ limitations under the License.
 #include "lib/string_map.h"
 
 namespace P4 {
+class BinaryReader;
 class JSONLoader;
 }  // namespace P4
 
@@ -84,6 +85,7 @@ class IndexedVector : public Vector<T> {
         insert(Vector<T>::end(), start, end);
     }
     explicit IndexedVector(JSONLoader &json);
+    explicit IndexedVector(BinaryReader &in);
 
     void clear() {
         IR::Vector<T>::clear();
@@ -221,6 +223,8 @@ class IndexedVector : public Vector<T> {
 
     void toJSON(JSONGenerator &json) const override;
     static IndexedVector<T> *fromJSON(JSONLoader &json);
+    void toBinary(BinaryWriter &out) const override;
+    static IndexedVector<T> *fromBinary(BinaryReader &in);
     void validate() const override {
         if (invalid) return;  // don't crash the compiler because an error happened
         for (auto el : *this) {
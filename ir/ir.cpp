@@ -55,8 +55,13 @@ const cstring IApply::applyMethodName = "apply"_cs;
 const cstring P4Program::main = "main"_cs;
 const cstring Type_Error::error = "error"_cs;
 
+#ifdef MULTITHREAD
+std::atomic<long> IR::Declaration::nextId{0};
+std::atomic<long> IR::This::nextId{0};
+#else
 long IR::Declaration::nextId = 0;
 long IR::This::nextId = 0;
+#endif  // MULTITHREAD
 
 const Type_Method *P4Control::getConstructorMethodType() const {
     return new Type_Method(getTypeParameters(), type, constructorParams, getName());
@@ -18,6 +18,7 @@ limitations under the License.
 #define IR_JSON_LOADER_H_
 
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -58,19 +59,154 @@ class JSONLoader {
     std::unique_ptr<JsonData> json_root;
     const JsonData *json = nullptr;
 
+    /// Loading from a JsonData tree reads fields in any order.  Loading directly from the input
+    /// (when `json` is null and `parser` is set) avoids holding the whole document as a tree:
+    /// the loader then is at a value of the parser, at depth `depth`, and reads it as it goes.
+    /// The generated constructors read the fields of an object in the order the JSONGenerator
+    /// writes them, but a field that was not written (an optional one) is only found missing at
+    /// the end of the object.  So the position of each member that is passed is kept in
+    /// `offsets`, and the parser returns there when the member is read later; if the input can
+    /// not seek, such members are kept in `skipped` instead.  Scalar members are always kept in
+    /// `skipped`, as they are small and often read more than once (Node_ID).
+    std::shared_ptr<JsonPullParser> parser;
+    size_t depth = 0;
+    mutable JsonPullParser::Kind kind = JsonPullParser::End;
+    mutable bool started = false, finished = false;
+    mutable std::unique_ptr<JsonObject> skipped;
+    mutable string_map<JsonPullParser::Mark> offsets;
+
     JSONLoader(const JsonData *json, std::unordered_map<int, IR::Node *> &refs)
         : node_refs(refs), json(json) {}
+    JSONLoader(std::shared_ptr<JsonPullParser> parser, std::unordered_map<int, IR::Node *> &refs)
+        : node_refs(refs), parser(std::move(parser)), depth(this->parser->depth()) {}
+
+    /// Parses the rest of the value into a tree, for the loaders that need one.
+    const JsonData *materialize() const {
+        if (!json && parser && !started) {
+            const_cast<JSONLoader *>(this)->json_root = parser->readValue();
+            const_cast<JSONLoader *>(this)->json = json_root.get();
+            started = finished = true;
+        }
+        return json;
+    }
+
+    /// Looks for member @p field of the object, either in `skipped`, at a position in `offsets`,
+    /// or further on in the input.  Leaves the parser at the member if it is not a scalar.
+    const JsonData *find(std::string_view field, bool &atParser) const {
+        atParser = false;
+        if (skipped) {
+            if (auto it = skipped->find(cstring(field)); it != skipped->end())
+                return it->second.get();
+        }
+        if (!started) {
+            started = true;
+            kind = parser->peek();
+            if (!parser->beginObject()) finished = true;
+        }
+        std::string key;
+        if (auto it = offsets.find(field); it != offsets.end()) {
+            // Go back to the member, and read on in order from there.
+            parser->rewind(it->second);
+            finished = false;
+            parser->nextKey(key);
+            atParser = true;
+            return nullptr;
+        }
+        while (!finished) {
+            parser->finishValue(depth + 1);
+            auto mark = parser->mark();
+            if (!parser->nextKey(key)) {
+                finished = true;
+                break;
+            }
+            auto next = parser->peek();
+            bool scalar = next != JsonPullParser::Object && next != JsonPullParser::Array;
+            if (mark && !scalar) offsets.emplace(cstring(key), *mark);
+            if (key == field && !scalar) {
+                atParser = true;
+                return nullptr;
+            }
+            if (mark && !scalar) {
+                // Skipped without reading it into a tree; find() returns here if it is needed.
+                continue;
+            }
+            if (!skipped) skipped = std::make_unique<JsonObject>();
+            auto &value = (*skipped)[cstring(key)];
+            value = parser->readValue();
+            if (key == field) return value.get();
+        }
+        return nullptr;
+    }
+
+    /// Calls @p fn with a loader for each element of the array.
+    template <typename Fn>
+    void forEachElement(Fn fn) {
+        if (!json && parser && !started && parser->peek() == JsonPullParser::Array) {
+            started = true;
+            kind = JsonPullParser::Array;
+            parser->beginArray();
+            while (parser->finishValue(depth + 1), parser->nextElement()) {
+                JSONLoader element(parser, node_refs);
+                fn(element);
+            }
+            finished = true;
+            return;
+        }
+        for (auto &e : as<JsonVector>()) {
+            JSONLoader element(e.get(), node_refs);
+            fn(element);
+        }
+    }
+
+    /// Calls @p fn with the key and a loader for the value of each member of the object.
+    template <typename Fn>
+    void forEachMember(Fn fn) {
+        if (!json && parser && !started && parser->peek() == JsonPullParser::Object) {
+            started = true;
+            kind = JsonPullParser::Object;
+            parser->beginObject();
+            std::string key;
+            while (parser->finishValue(depth + 1), parser->nextKey(key)) {
+                JSONLoader value(parser, node_refs);
+                fn(cstring(key), value);
+            }
+            finished = true;
+            return;
+        }
+        for (auto &e : as<JsonObject>()) {
+            JSONLoader value(e.second.get(), node_refs);
+            fn(e.first, value);
+        }
+    }
+
+    template <typename T>
+    static constexpr JsonPullParser::Kind kindOf() {
+        if constexpr (std::is_same_v<T, JsonObject>) return JsonPullParser::Object;
+        if constexpr (std::is_same_v<T, JsonVector>) return JsonPullParser::Array;
+        if constexpr (std::is_same_v<T, JsonString>) return JsonPullParser::String;
+        if constexpr (std::is_same_v<T, JsonNumber>) return JsonPullParser::Number;
+        if constexpr (std::is_same_v<T, JsonBoolean>) return JsonPullParser::Boolean;
+        if constexpr (std::is_same_v<T, JsonNull>) return JsonPullParser::Null;
+        return JsonPullParser::Invalid;
+    }
 
  public:
     explicit JSONLoader(std::istream &in)
-        : node_refs(*(new std::unordered_map<int, IR::Node *>())) {
-        in >> json_root;
-        json = json_root.get();
-    }
+        : node_refs(*(new std::unordered_map<int, IR::Node *>())),
+          parser(std::make_shared<JsonPullParser>(in)) {}
 
     JSONLoader(const JSONLoader &unpacker, std::string_view field)
         : node_refs(unpacker.node_refs), json(nullptr) {
         if (!unpacker) return;
+        if (!unpacker.json && unpacker.parser) {
+            bool atParser = false;
+            json = unpacker.find(field, atParser);
+            if (atParser) {
+                parser = unpacker.parser;
+                depth = parser->depth();
+            }
+            return;
+        }
         if (auto *obj = unpacker.json->to<JsonObject>()) {
             if (auto it = obj->find(field); it != obj->end()) {
                 json = it->second.get();
@@ -78,19 +214,29 @@ class JSONLoader {
         }
     }
 
-    explicit operator bool() const { return json != nullptr; }
+    explicit operator bool() const {
+        if (json) return true;
+        if (!parser) return false;
+        return started ? kind != JsonPullParser::End && kind != JsonPullParser::Invalid
+                       : parser->peek() != JsonPullParser::End;
+    }
     template <typename T>
     [[nodiscard]] bool is() const {
+        if (!json && parser) {
+            auto k = started ? kind : parser->peek();
+            if constexpr (std::is_same_v<T, JsonData>) return k != JsonPullParser::End;
+            return k == kindOf<T>();
+        }
         return json && json->is<T>();
     }
     template <typename T>
     [[nodiscard]] const T &as() const {
-        return json->as<T>();
+        return materialize()->as<T>();
     }
 
  private:
     const IR::Node *get_node() {
-        if (!json || !json->is<JsonObject>()) return nullptr;  // invalid json exception?
+        if (!is<JsonObject>()) return nullptr;  // invalid json exception?
         int id;
         auto success = load("Node_ID", id);
         if (!success) {
@@ -120,32 +266,32 @@ class JSONLoader {
 
     template <typename T>
     void unpack_json(safe_vector<T> &v) {
-        T temp;
         v.clear();
-        for (auto &e : as<JsonVector>()) {
-            load(e, temp);
-            v.push_back(temp);
-        }
+        forEachElement([&v](JSONLoader &e) {
+            T temp;
+            e.unpack_json(temp);
+            v.push_back(std::move(temp));
+        });
     }
 
     template <typename T>
     void unpack_json(std::set<T> &v) {
-        T temp;
         v.clear();
-        for (auto &e : as<JsonVector>()) {
-            load(e, temp);
-            v.insert(temp);
-        }
+        forEachElement([&v](JSONLoader &e) {
+            T temp;
+            e.unpack_json(temp);
+            v.insert(std::move(temp));
+        });
     }
 
     template <typename T>
     void unpack_json(ordered_set<T> &v) {
-        T temp;
         v.clear();
-        for (auto &e : as<JsonVector>()) {
-            load(e, temp);
-            v.insert(temp);
-        }
+        forEachElement([&v](JSONLoader &e) {
+            T temp;
+            e.unpack_json(temp);
+            v.insert(std::move(temp));
+        });
     }
 
     template <typename T>
@@ -177,75 +323,78 @@ class JSONLoader {
 
     template <typename K, typename V>
     void unpack_json(std::map<K, V> &v) {
-        std::pair<K, V> temp;
         v.clear();
         if (is<JsonVector>()) {
-            for (auto &e : as<JsonVector>()) {
-                load(e, temp);
-                v.insert(temp);
-            }
+            forEachElement([&v](JSONLoader &e) {
+                std::pair<K, V> temp;
+                e.unpack_json(temp);
+                v.insert(std::move(temp));
+            });
         } else {
-            for (auto &e : as<JsonObject>()) {
-                load(JsonString(e.first), temp.first);
-                load(e.second, temp.second);
-                v.insert(temp);
-            }
+            forEachMember([&v, this](cstring key, JSONLoader &value) {
+                std::pair<K, V> temp;
+                load(JsonString(key), temp.first);
+                value.unpack_json(temp.second);
+                v.insert(std::move(temp));
+            });
         }
     }
     template <typename K, typename V>
     void unpack_json(ordered_map<K, V> &v) {
-        std::pair<K, V> temp;
         v.clear();
         if (is<JsonVector>()) {
-            for (auto &e : as<JsonVector>()) {
-                load(e, temp);
-                v.insert(temp);
-            }
+            forEachElement([&v](JSONLoader &e) {
+                std::pair<K, V> temp;
+                e.unpack_json(temp);
+                v.insert(std::move(temp));
+            });
         } else {
-            for (auto &e : as<JsonObject>()) {
-                load(JsonString(e.first), temp.first);
-                load(e.second, temp.second);
-                v.insert(temp);
-            }
+            forEachMember([&v, this](cstring key, JSONLoader &value) {
+                std::pair<K, V> temp;
+                load(JsonString(key), temp.first);
+                value.unpack_json(temp.second);
+                v.insert(std::move(temp));
+            });
         }
     }
     template <typename V>
     void unpack_json(string_map<V> &v) {
-        std::pair<cstring, V> temp;
         v.clear();
-        for (auto &e : as<JsonObject>()) {
-            temp.first = e.first;
-            load(e.second, temp.second);
-            v.insert(temp);
-        }
+        forEachMember([&v](cstring key, JSONLoader &value) {
+            std::pair<cstring, V> temp;
+            temp.first = key;
+            value.unpack_json(temp.second);
+            v.insert(std::move(temp));
+        });
     }
 
     template <typename K, typename V>
     void unpack_json(std::multimap<K, V> &v) {
-        std::pair<K, V> temp;
         v.clear();
         if (is<JsonVector>()) {
-            for (auto &e : as<JsonVector>()) {
-                load(e, temp);
-                v.insert(temp);
-            }
+            forEachElement([&v](JSONLoader &e) {
+                std::pair<K, V> temp;
+                e.unpack_json(temp);
+                v.insert(std::move(temp));
+            });
         } else {
-            for (auto &e : as<JsonObject>()) {
-                load(JsonString(e.first), temp.first);
-                load(e.second, temp.second);
-                v.insert(temp);
-            }
+            forEachMember([&v, this](cstring key, JSONLoader &value) {
+                std::pair<K, V> temp;
+                load(JsonString(key), temp.first);
+                value.unpack_json(temp.second);
+                v.insert(std::move(temp));
+            });
         }
     }
 
     template <typename T>
     void unpack_json(std::vector<T> &v) {
-        T temp;
         v.clear();
-        for (auto &e : as<JsonVector>()) {
-            load(e, temp);
-            v.push_back(temp);
-        }
+        forEachElement([&v](JSONLoader &e) {
+            T temp;
+            e.unpack_json(temp);
+            v.push_back(std::move(temp));
+        });
     }
 
     template <typename T, typename U>
@@ -311,24 +460,24 @@ class JSONLoader {
             v = cstring();
     }
     void unpack_json(IR::ID &v) {
-        if (!json->is<JsonNull>()) v.name = as<JsonString>();
+        if (!materialize()->is<JsonNull>()) v.name = as<JsonString>();
     }
 
     void unpack_json(LTBitMatrix &m) {
-        if (auto *s = json->to<JsonString>()) s->c_str() >> m;
+        if (auto *s = materialize()->to<JsonString>()) s->c_str() >> m;
     }
 
     void unpack_json(bitvec &v) {
-        if (auto *s = json->to<JsonString>()) s->c_str() >> v;
+        if (auto *s = materialize()->to<JsonString>()) s->c_str() >> v;
     }
 
     template <typename T>
     std::enable_if_t<std::is_enum_v<T>> unpack_json(T &v) {
-        if (auto *s = json->to<JsonString>()) *s >> v;
+        if (auto *s = materialize()->to<JsonString>()) *s >> v;
     }
 
     void unpack_json(match_t &v) {
-        if (auto *s = json->to<JsonString>()) s->c_str() >> v;
+        if (auto *s = materialize()->to<JsonString>()) s->c_str() >> v;
     }
 
     void unpack_json(UnparsedConstant *&v) {
@@ -377,11 +526,11 @@ class JSONLoader {
 
     template <typename T, size_t N>
     void unpack_json(T (&v)[N]) {
-        if (auto *j = json->to<JsonVector>()) {
-            for (size_t i = 0; i < N && i < j->size(); ++i) {
-                load(j->at(i), v[i]);
-            }
-        }
+        if (!is<JsonVector>()) return;
+        size_t i = 0;
+        forEachElement([&v, &i](JSONLoader &e) {
+            if (i < N) e.unpack_json(v[i++]);
+        });
     }
 
  public:
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cctype>
 #include <iostream>
 #include <list>
+#include <string>
 #include <utility>
 
 #include "absl/strings/escaping.h"
@@ -70,103 +71,227 @@ std::ostream &operator<<(std::ostream &out, const JsonData *json) {
     return out;
 }
 
-std::istream &operator>>(std::istream &in, std::unique_ptr<JsonData> &json) {
-    while (in) {
-        char ch;
-        in >> ch;
-        switch (ch) {
-            case '{': {
-                string_map<std::unique_ptr<JsonData>> obj;
-                do {
-                    in >> std::ws >> ch;
-                    if (ch == '}') break;
-                    in.unget();
-
-                    std::unique_ptr<JsonData> key, val;
-                    in >> key >> std::ws >> ch >> std::ws >> val;
-                    obj[key->as<JsonString>()] = std::move(val);
-
-                    in >> std::ws >> ch;
-                } while (in && ch != '}');
-
-                json = std::make_unique<JsonObject>(std::move(obj));
-                return in;
-            }
-            case '[': {
-                std::vector<std::unique_ptr<JsonData>> vec;
-                do {
-                    in >> std::ws >> ch;
-                    if (ch == ']') break;
-                    in.unget();
-
-                    std::unique_ptr<JsonData> elem;
-                    in >> elem;
-                    vec.emplace_back(std::move(elem));
-
-                    in >> std::ws >> ch;
-                } while (in && ch != ']');
-
-                json = std::make_unique<JsonVector>(std::move(vec));
-                return in;
-            }
-            case '"': {
-                std::string s;
-                getline(in, s, '"');
-                while (!s.empty() && s.back() == '\\') {
-                    int bscount = 0;  // odd number of '\' chars mean the quote is escaped
-                    for (auto t = s.rbegin(); t != s.rend() && *t == '\\'; ++t) bscount++;
-                    if ((bscount & 1) == 0) break;
-                    s += '"';
-                    std::string more;
-                    getline(in, more, '"');
-                    s += more;
-                }
-                absl::CUnescape(s, &s);
-                json = std::make_unique<JsonString>(s);
-                return in;
-            }
-            case '-':
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9': {
-                // operator>>(istream, big_int) is broken and throws exceptions if the
-                // number is not followed by whitespace, so we need to manually extract all
-                // the digits into a buffer and convert that to big_int
-                std::string num;
-                do {
-                    num += ch;
-                    in >> ch;
-                } while (isdigit(ch));
-                in.unget();
-                json = std::make_unique<JsonNumber>(big_int(num));
-                return in;
-            }
-            case 't':
-            case 'T':
-                in.ignore(3);
-                json = std::make_unique<JsonBoolean>(true);
-                return in;
-            case 'f':
-            case 'F':
-                in.ignore(4);
-                json = std::make_unique<JsonBoolean>(false);
-                return in;
-            case 'n':
-            case 'N':
-                in.ignore(3);
-                json = std::make_unique<JsonNull>();
-                return in;
-            default:
-                return in;
+JsonPullParser::JsonPullParser(std::istream &in) : in(in.rdbuf()) {
+    frames.push_back({0, true, true});
+}
+
+int JsonPullParser::peekChar() { return in ? in->sgetc() : std::char_traits<char>::eof(); }
+
+int JsonPullParser::getChar() { return in ? in->sbumpc() : std::char_traits<char>::eof(); }
+
+void JsonPullParser::skipSpace() {
+    while (isspace(peekChar())) getChar();
+}
+
+JsonPullParser::Kind JsonPullParser::peek() {
+    skipSpace();
+    int ch = peekChar();
+    switch (ch) {
+        case '{':
+            return Object;
+        case '[':
+            return Array;
+        case '"':
+            return String;
+        case 't':
+        case 'T':
+        case 'f':
+        case 'F':
+            return Boolean;
+        case 'n':
+        case 'N':
+            return Null;
+        case '}':
+        case ']':
+        case std::char_traits<char>::eof():
+            return End;
+        default:
+            return ch == '-' || isdigit(ch) ? Number : Invalid;
+    }
+}
+
+bool JsonPullParser::beginObject() {
+    if (peek() != Object) return false;
+    getChar();
+    startValue();
+    frames.push_back({'}', true, false});
+    return true;
+}
+
+bool JsonPullParser::beginArray() {
+    if (peek() != Array) return false;
+    getChar();
+    startValue();
+    frames.push_back({']', true, false});
+    return true;
+}
+
+bool JsonPullParser::moveNext(char close) {
+    if (frames.size() == 1 || frames.back().close != close) return false;
+    if (frames.back().pending) skipValue();
+    skipSpace();
+    int ch = peekChar();
+    if (!frames.back().first && ch == ',') {
+        getChar();
+        skipSpace();
+        ch = peekChar();
+    }
+    if (ch == close || ch == std::char_traits<char>::eof()) {
+        getChar();
+        frames.pop_back();
+        return false;
+    }
+    frames.back().first = false;
+    frames.back().pending = true;
+    return true;
+}
+
+bool JsonPullParser::nextKey(std::string &key) {
+    if (!moveNext('}')) return false;
+    key = readString();
+    skipSpace();
+    if (peekChar() == ':') getChar();
+    frames.back().pending = true;
+    return true;
+}
+
+bool JsonPullParser::nextElement() { return moveNext(']'); }
+
+std::string JsonPullParser::readString() {
+    std::string s;
+    if (peek() != String) return s;
+    startValue();
+    getChar();
+    for (int ch = getChar(); ch != '"' && ch != std::char_traits<char>::eof(); ch = getChar()) {
+        s += static_cast<char>(ch);
+        // The escaped character may be a quote.
+        if (ch == '\\' && (ch = getChar()) != std::char_traits<char>::eof())
+            s += static_cast<char>(ch);
+    }
+    absl::CUnescape(s, &s);
+    return s;
+}
+
+big_int JsonPullParser::readNumber() {
+    // operator>>(istream, big_int) is broken and throws exceptions if the
+    // number is not followed by whitespace, so we need to manually extract all
+    // the digits into a buffer and convert that to big_int
+    std::string num;
+    if (peek() != Number) return 0;
+    startValue();
+    do {
+        num += static_cast<char>(getChar());
+    } while (isdigit(peekChar()));
+    return num == "-" ? big_int(0) : big_int(num);
+}
+
+bool JsonPullParser::readBoolean() {
+    if (peek() != Boolean) return false;
+    startValue();
+    int ch = getChar();
+    bool value = ch == 't' || ch == 'T';
+    for (int i = value ? 3 : 4; i > 0; --i) getChar();
+    return value;
+}
+
+void JsonPullParser::readNull() {
+    if (peek() != Null) return;
+    startValue();
+    for (int i = 0; i < 4; ++i) getChar();
+}
+
+std::unique_ptr<JsonData> JsonPullParser::readValue() {
+    switch (peek()) {
+        case Object: {
+            string_map<std::unique_ptr<JsonData>> obj;
+            beginObject();
+            std::string key;
+            while (nextKey(key)) obj[cstring(key)] = readValue();
+            return std::make_unique<JsonObject>(std::move(obj));
+        }
+        case Array: {
+            std::vector<std::unique_ptr<JsonData>> vec;
+            beginArray();
+            while (nextElement()) vec.emplace_back(readValue());
+            return std::make_unique<JsonVector>(std::move(vec));
         }
+        case String:
+            return std::make_unique<JsonString>(readString());
+        case Number:
+            return std::make_unique<JsonNumber>(readNumber());
+        case Boolean:
+            return std::make_unique<JsonBoolean>(readBoolean());
+        case Null:
+            readNull();
+            return std::make_unique<JsonNull>();
+        case Invalid:
+            getChar();
+            [[fallthrough]];
+        case End:
+            startValue();
+            return nullptr;
+    }
+    return nullptr;
+}
+
+void JsonPullParser::skipValue() {
+    switch (peek()) {
+        case Object:
+        case Array:
+            if (peek() == Object ? beginObject() : beginArray()) finishValue(depth() - 1);
+            break;
+        case String:
+            readString();
+            break;
+        case Number:
+            readNumber();
+            break;
+        case Boolean:
+            readBoolean();
+            break;
+        case Null:
+            readNull();
+            break;
+        case Invalid:
+            getChar();
+            [[fallthrough]];
+        case End:
+            startValue();
+            break;
+    }
+}
+
+void JsonPullParser::finishValue(size_t depth) {
+    std::string key;
+    while (this->depth() > depth) {
+        if (frames.back().close == '}')
+            while (nextKey(key)) continue;
+        else
+            while (nextElement()) continue;
     }
+    if (frames.back().pending) skipValue();
+}
+
+std::optional<JsonPullParser::Mark> JsonPullParser::mark() {
+    if (!in || frames.back().pending) return std::nullopt;
+    auto pos = in->pubseekoff(0, std::ios::cur, std::ios::in);
+    if (pos == std::streampos(std::streamoff(-1))) return std::nullopt;
+    return Mark{pos, depth(), frames.back().close, frames.back().first};
+}
+
+void JsonPullParser::rewind(const Mark &mark) {
+    in->pubseekpos(mark.pos, std::ios::in);
+    frames.resize(mark.depth + 1);
+    frames.back() = {mark.close, mark.first, false};
+}
+
+std::istream &operator>>(std::istream &in, std::unique_ptr<JsonData> &json) {
+    if (!in) return in;
+    JsonPullParser parser(in);
+    if (auto value = parser.readValue())
+        json = std::move(value);
+    else
+        in.setstate(std::ios::failbit);
     return in;
 }
 
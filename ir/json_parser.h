@@ -2,7 +2,9 @@
 #define IR_JSON_PARSER_H_
 
 #include <iosfwd>
+#include <ios>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -85,6 +87,71 @@ class JsonNull : public JsonData {
     DECLARE_TYPEINFO(JsonNull, JsonData);
 };
 
+/// Pull parser over a JSON text, for reading large documents without building the whole
+/// JsonData tree.  The caller walks the document value by value: containers are entered with
+/// beginObject/beginArray and iterated with nextKey/nextElement, scalars are read with the
+/// read* methods, and anything of no interest is skipped.  Values that are needed as a tree can
+/// still be read with readValue.  Reads only as much of the istream as it has parsed.
+class JsonPullParser {
+ public:
+    enum Kind { End, Object, Array, String, Number, Boolean, Null, Invalid };
+
+    explicit JsonPullParser(std::istream &in);
+
+    /// Kind of the next value.
+    Kind peek();
+    /// Number of containers entered and not yet left.
+    size_t depth() const { return frames.size() - 1; }
+
+    bool beginObject();
+    bool beginArray();
+    /// Moves to the next member of the innermost container, which must be an object, and reads
+    /// its key; false (after leaving the object) when there are no more members.
+    bool nextKey(std::string &key);
+    /// Moves to the next element of the innermost container, which must be an array; false
+    /// (after leaving the array) when there are no more elements.
+    bool nextElement();
+
+    std::string readString();
+    big_int readNumber();
+    bool readBoolean();
+    void readNull();
+    std::unique_ptr<JsonData> readValue();
+    void skipValue();
+    /// Leaves containers until depth() is @p depth, and then skips the current member or
+    /// element of that container if it has not been read.
+    void finishValue(size_t depth);
+
+    /// A position between two members or elements of a container.
+    struct Mark {
+        std::streampos pos;
+        size_t depth;
+        char close;
+        bool first;
+    };
+    /// The current position, which must be between two members or elements of the innermost
+    /// container.  Empty if the input can not seek.
+    std::optional<Mark> mark();
+    /// Returns to @p mark, leaving any containers entered since it was taken.
+    void rewind(const Mark &mark);
+
+ private:
+    struct Frame {
+        char close;
+        bool first;
+        /// A key or an element start has been read, but not the value.
+        bool pending;
+    };
+    std::streambuf *in;
+    std::vector<Frame> frames;
+
+    int peekChar();
+    int getChar();
+    void skipSpace();
+    void startValue() { frames.back().pending = false; }
+    bool moveNext(char close);
+};
+
 std::string getIndent(int l);
 
 std::ostream &operator<<(std::ostream &out, const JsonData *json);
@@ -27,6 +27,7 @@ limitations under the License.
 #include "lib/map.h"
 
 namespace P4 {
+class BinaryReader;
 class JSONLoader;
 }  // namespace P4
 
@@ -55,6 +56,7 @@ class NameMap : public Node {
     NameMap(const NameMap &) = default;
     NameMap(NameMap &&) = default;
     explicit NameMap(JSONLoader &);
+    explicit NameMap(BinaryReader &);
     NameMap &operator=(const NameMap &) = default;
     NameMap &operator=(NameMap &&) = default;
     typedef typename map_t::value_type value_type;
@@ -150,6 +152,8 @@ class NameMap : public Node {
     void visit_children(Visitor &v, const char *) const override;
     void toJSON(JSONGenerator &json) const override;
     static NameMap<T, MAP, COMP, ALLOC> *fromJSON(JSONLoader &json);
+    void toBinary(BinaryWriter &out) const override;
+    static NameMap<T, MAP, COMP, ALLOC> *fromBinary(BinaryReader &in);
 
     Util::Enumerator<const T *> *valueEnumerator() const {
         return Util::enumerate(Values(symbols));
@@ -23,6 +23,8 @@ limitations under the License.
 // use in combination with "raise" below
 // #include <csignal>
 
+#include "ir/binary_reader.h"
+#include "ir/binary_writer.h"
 #include "ir/declaration.h"
 #include "ir/ir.h"
 #include "ir/json_generator.h"
@@ -47,7 +49,11 @@ void IR::Node::traceCreation() const {
     LOG5("Created node " << id);
 }
 
+#ifdef MULTITHREAD
+std::atomic<int> IR::Node::currentId{0};
+#else
 int IR::Node::currentId = 0;
+#endif  // MULTITHREAD
 
 void IR::Node::toJSON(JSONGenerator &json) const {
     json.emit("Node_ID", id);
@@ -58,8 +64,19 @@ IR::Node::Node(JSONLoader &json) : id(-1) {
     json.load("Node_ID", id);
     if (id < 0)
         id = currentId++;
-    else if (id >= currentId)
-        currentId = id + 1;
+    else
+        raiseNextId(currentId, id);
+    clone_id = id;
+}
+
+void IR::Node::toBinary(BinaryWriter &out) const { out.write(id); }
+
+IR::Node::Node(BinaryReader &in) : id(-1) {
+    in.read(id);
+    if (id < 0)
+        id = currentId++;
+    else
+        raiseNextId(currentId, id);
     clone_id = id;
 }
 
@@ -113,7 +130,7 @@ Util::JsonObject *IR::Node::sourceInfoJsonObj() const {
     unsigned lineNumber, columnNumber;
     cstring fName = prepareSourceInfoForJSON(si, &lineNumber, &columnNumber);
     if (fName == nullptr) {
-        if (si.line == -1) {
+        if (si.line() == -1) {
             // -1 is default value for objects when SourceInfo
             // was not read from jsonFile using "--fromJSON" flag
             return nullptr;
@@ -121,10 +138,10 @@ Util::JsonObject *IR::Node::sourceInfoJsonObj() const {
             // Added source_info for jsonObject when "--fromJSON" flag is used
             // which parameters are saved in srcInfo fileds(filename, line, column and srcBrief)
             auto json1 = new Util::JsonObject();
-            json1->emplace("filename", srcInfo.filename);
-            json1->emplace("line", srcInfo.line);
-            json1->emplace("column", srcInfo.column);
-            json1->emplace("source_fragment", srcInfo.srcBrief);
+            json1->emplace("filename", srcInfo.filename());
+            json1->emplace("line", srcInfo.line());
+            json1->emplace("column", srcInfo.column());
+            json1->emplace("source_fragment", srcInfo.srcBrief());
             return json1;
         }
     } else {
@@ -156,11 +173,62 @@ void IR::Node::sourceInfoToJSON(JSONGenerator &json) const {
 
 void IR::Node::sourceInfoFromJSON(JSONLoader &json) {
     if (auto si = JSONLoader(json, "Source_Info")) {
-        si.load("filename", srcInfo.filename);
-        si.load("line", srcInfo.line);
-        si.load("column", srcInfo.column);
-        si.load("source_fragment", srcInfo.srcBrief);
+        cstring filename = cstring::empty, srcBrief = cstring::empty;
+        int line = -1, column = -1;
+        si.load("filename", filename);
+        si.load("line", line);
+        si.load("column", column);
+        si.load("source_fragment", srcBrief);
+        srcInfo = Util::SourceInfo(filename, line, column, srcBrief);
+    }
+}
+
+void IR::Node::sourceInfoToBinary(BinaryWriter &out) const {
+    if (out.positions()) {
+        const auto &start = srcInfo.getStart();
+        const auto &end = srcInfo.getEnd();
+        out.write(start.getLineNumber());
+        out.write(start.getColumnNumber());
+        out.write(end.getLineNumber());
+        out.write(end.getColumnNumber());
+        return;
+    }
+    Util::SourceInfo si = srcInfo;
+    unsigned lineNumber, columnNumber;
+    cstring fName = prepareSourceInfoForJSON(si, &lineNumber, &columnNumber);
+    if (fName != nullptr) {
+        out.write(true);
+        out.write(fName);
+        out.write(static_cast<int>(lineNumber));
+        out.write(static_cast<int>(columnNumber));
+        out.write(si.toBriefSourceFragment());
+    } else if (srcInfo.line() != -1) {
+        // Read from a snapshot, without the program source.
+        out.write(true);
+        out.write(srcInfo.filename());
+        out.write(srcInfo.line());
+        out.write(srcInfo.column());
+        out.write(srcInfo.srcBrief());
+    } else {
+        out.write(false);
+    }
+}
+
+void IR::Node::sourceInfoFromBinary(BinaryReader &in) {
+    if (in.hasPositions()) {
+        srcInfo = in.readPosition();
+        return;
     }
+    bool present = false;
+    in.read(present);
+    if (!present) return;
+    cstring filename, srcBrief;
+    int line = -1, column = -1;
+    in.read(filename);
+    in.read(line);
+    in.read(column);
+    in.read(srcBrief);
+    srcInfo = Util::SourceInfo(filename, line, column, srcBrief);
 }
 
 IRNODE_DEFINE_APPLY_OVERLOAD(Node, , )
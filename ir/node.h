@@ -18,6 +18,9 @@ limitations under the License.
 #define IR_NODE_H_
 
 #include <iosfwd>
+#ifdef MULTITHREAD
+#include <atomic>
+#endif  // MULTITHREAD
 
 #include "ir-tree-macros.h"
 #include "ir/gen-tree-macro.h"
@@ -34,6 +37,8 @@ class Modifier;
 class Transform;
 class JSONGenerator;
 class JSONLoader;
+class BinaryWriter;
+class BinaryReader;
 }  // namespace P4
 
 namespace P4::Util {
@@ -62,6 +67,19 @@ struct has_static_type_name<T, std::void_t<decltype(T::static_type_name())>> : s
 template <class T>
 inline constexpr bool has_static_type_name_v = has_static_type_name<T>::value;
 
+/// Raises @p next, the counter new nodes or declarations take their ids from, past @p id,
+/// an id read from a serialized program, so that no object created later gets the same id.
+template <class Counter, class Id>
+void raiseNextId(Counter &next, Id id) {
+#ifdef MULTITHREAD
+    auto current = next.load();
+    while (id >= current && !next.compare_exchange_weak(current, id + 1)) {
+    }
+#else
+    if (id >= next) next = id + 1;
+#endif  // MULTITHREAD
+}
+
 // node interface
 class INode : public Util::IHasSourceInfo, public IHasDbPrint, public ICastable {
  public:
@@ -109,7 +127,12 @@ class Node : public virtual INode {
     Node &operator=(Node &&) = default;
 
  protected:
+#ifdef MULTITHREAD
+    // nodes may be created concurrently by passes run on PassManager worker threads
+    static std::atomic<int> currentId;
+#else
     static int currentId;
+#endif  // MULTITHREAD
     void traceVisit(const char *visitor) const;
     friend class ::P4::Visitor;
     friend class ::P4::Inspector;
@@ -149,6 +172,10 @@ class Node : public virtual INode {
     void toJSON(JSONGenerator &json) const override;
     void sourceInfoToJSON(JSONGenerator &json) const;
     void sourceInfoFromJSON(JSONLoader &json);
+    explicit Node(BinaryReader &in);
+    virtual void toBinary(BinaryWriter &out) const;
+    void sourceInfoToBinary(BinaryWriter &out) const;
+    void sourceInfoFromBinary(BinaryReader &in);
     Util::JsonObject *sourceInfoJsonObj() const;
     /* operator== does a 'shallow' comparison, comparing two Node subclass objects for equality,
      * and comparing pointers in the Node directly for equality */
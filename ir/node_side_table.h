@@ -0,0 +1,146 @@
+#ifndef IR_NODE_SIDE_TABLE_H_
+#define IR_NODE_SIDE_TABLE_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ir/node.h"
+#include "lib/hash.h"
+
+namespace P4 {
+
+/// A map from IR nodes to values of type T, kept in pages of dense arrays indexed by
+/// IR::Node::id instead of in a hash table keyed by the address of the node.  A lookup is a
+/// shift, two indexed loads and a comparison.
+///
+/// Each slot also holds its node, so that another node with the same id, as read from an IR
+/// dump, is never taken for the one in the table; such nodes are kept in a hash table on the
+/// side.  A page is allocated when the first node in its range of ids is inserted and freed
+/// when its last node is erased.  Passes create the nodes they change together, so the ids of
+/// the nodes of a program are clustered and few pages are mostly empty.  Small maps that are
+/// created often are better left hashed.
+///
+/// Iteration with forEach() is in the order of node ids, which unlike the order of addresses
+/// is the same from one run to the next, followed by the nodes that share an id.
+template <class T, unsigned PageBits = 8>
+class NodeSideTable {
+    static constexpr size_t pageSize = size_t(1) << PageBits;
+    struct Slot {
+        const IR::Node *node = nullptr;
+        T value{};
+    };
+    struct Page {
+        size_t used = 0;
+        Slot slots[pageSize];
+    };
+    std::vector<std::unique_ptr<Page>> pages;
+    /// Nodes whose slot holds another node with the same id.
+    absl::flat_hash_map<const IR::Node *, T, Util::Hash> shared;
+    size_t count_ = 0;
+
+    Slot *slot(const IR::Node *node) const {
+        size_t page = static_cast<size_t>(node->id) >> PageBits;
+        if (page >= pages.size() || !pages[page]) return nullptr;
+        Slot &slot = pages[page]->slots[node->id & (pageSize - 1)];
+        return slot.node == node ? &slot : nullptr;
+    }
+    const T *findShared(const IR::Node *node) const {
+        if (shared.empty()) return nullptr;
+        auto it = shared.find(node);
+        return it != shared.end() ? &it->second : nullptr;
+    }
+
+ public:
+    NodeSideTable() = default;
+    NodeSideTable(const NodeSideTable &other) { *this = other; }
+    NodeSideTable(NodeSideTable &&) = default;
+    NodeSideTable &operator=(const NodeSideTable &other) {
+        if (this == &other) return *this;
+        pages.clear();
+        pages.resize(other.pages.size());
+        for (size_t i = 0; i < other.pages.size(); ++i)
+            if (other.pages[i]) pages[i] = std::make_unique<Page>(*other.pages[i]);
+        shared = other.shared;
+        count_ = other.count_;
+        return *this;
+    }
+    NodeSideTable &operator=(NodeSideTable &&) = default;
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    size_t count(const IR::Node *node) const { return find(node) != nullptr; }
+    /// The number of pages allocated, of pageSize slots each.
+    size_t pagesAllocated() const {
+        size_t result = 0;
+        for (auto &page : pages) result += page != nullptr;
+        return result;
+    }
+
+    /// The value of @p node, or nullptr if it has none.
+    const T *find(const IR::Node *node) const {
+        auto *s = slot(node);
+        return s ? &s->value : findShared(node);
+    }
+    T *find(const IR::Node *node) {
+        return const_cast<T *>(static_cast<const NodeSideTable *>(this)->find(node));
+    }
+
+    /// Inserts @p value for @p node unless it has a value already.
+    /// @return the value of @p node, and true if it was inserted.
+    std::pair<T *, bool> emplace(const IR::Node *node, T value) {
+        if (auto *s = slot(node)) return {&s->value, false};
+        if (auto *found = findShared(node)) return {const_cast<T *>(found), false};
+        ++count_;
+        size_t page = static_cast<size_t>(node->id) >> PageBits;
+        if (page >= pages.size()) pages.resize(page + 1);
+        if (!pages[page]) pages[page] = std::make_unique<Page>();
+        Slot &slot = pages[page]->slots[node->id & (pageSize - 1)];
+        if (slot.node != nullptr) {
+            auto it = shared.emplace(node, std::move(value)).first;
+            return {&it->second, true};
+        }
+        ++pages[page]->used;
+        slot.node = node;
+        slot.value = std::move(value);
+        return {&slot.value, true};
+    }
+    T &operator[](const IR::Node *node) { return *emplace(node, T{}).first; }
+
+    /// @return the number of values erased, 0 or 1.
+    size_t erase(const IR::Node *node) {
+        auto *s = slot(node);
+        if (s == nullptr) {
+            auto erased = shared.erase(node);
+            count_ -= erased;
+            return erased;
+        }
+        *s = Slot();
+        --count_;
+        auto &page = pages[static_cast<size_t>(node->id) >> PageBits];
+        if (--page->used == 0) page.reset();
+        return 1;
+    }
+    void clear() {
+        pages.clear();
+        shared.clear();
+        count_ = 0;
+    }
+
+    /// Calls @p f with each node and its value, in the order of node ids.
+    template <class F>
+    void forEach(F &&f) const {
+        for (auto &page : pages) {
+            if (!page) continue;
+            for (auto &slot : page->slots)
+                if (slot.node != nullptr) f(slot.node, slot.value);
+        }
+        for (auto &[node, value] : shared) f(node, value);
+    }
+};
+
+}  // namespace P4
+
+#endif /* IR_NODE_SIDE_TABLE_H_ */
@@ -18,13 +18,23 @@ limitations under the License.
 
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
+#ifdef MULTITHREAD
+#include <pthread.h>
+
+#include <atomic>
+#include <exception>
+#endif  // MULTITHREAD
 
 #include "ir/dump.h"
+#include "ir/ir.h"
 #include "ir/node.h"
+#include "ir/pass_profile.h"
 #include "ir/visitor.h"
 #include "lib/error.h"
 #include "lib/gc.h"
@@ -71,6 +81,10 @@ const IR::Node *PassManager::apply_visitor(const IR::Node *program, const char *
     early_exit_flag = false;
     unsigned initial_error_count = ::P4::errorCount();
     BUG_CHECK(running, "not calling apply properly");
+    // The passes of a manager that no PassManager runs are profiled under its name.
+    std::optional<PassProfile::Scope> profileManager;
+    if (PassProfile::isEnabled() && !PassProfile::insidePass())
+        profileManager.emplace(name(), program);
     for (auto it = passes.begin(); it != passes.end();) {
         Visitor *v = *it;
         if (auto b = dynamic_cast<Backtrack *>(v)) {
@@ -81,7 +95,15 @@ const IR::Node *PassManager::apply_visitor(const IR::Node *program, const char *
         try {
             try {
                 LOG1(log_indent << name() << " invoking " << v->name());
-                program = program->apply(**it, getChildContext());
+                PassProfile::Scope profile(v->name(), program);
+#ifdef MULTITHREAD
+                if (jobs > 1 && dynamic_cast<DeclarationLocal *>(v) &&
+                    program->is<IR::P4Program>())
+                    program = applyPerDeclaration(*v, program);
+                else
+#endif  // MULTITHREAD
+                    program = program->apply(**it, getChildContext());
+                profile.finish(program);
                 if (LOGGING(3)) {
                     size_t maxmem, mem = gc_mem_inuse(&maxmem);  // triggers gc
                     LOG3(log_indent << "heap after " << v->name() << ": in use " << n4(mem)
@@ -117,10 +139,109 @@ const IR::Node *PassManager::apply_visitor(const IR::Node *program, const char *
         seqNo++;
         it++;
     }
+    if (profileManager) profileManager->finish(program);
     running = false;
     return program;
 }
 
+#ifdef MULTITHREAD
+namespace {
+
+/// Applies clones of a DeclarationLocal pass to the top-level objects of a P4Program on a
+/// number of worker threads.  Objects are handed out through a shared counter and every
+/// result is stored in the slot of the object it was computed from, so the stitched program
+/// does not depend on the scheduling.  Exceptions are rethrown on the calling thread, the one
+/// for the first object in program order winning, which is the one a serial run would see.
+class DeclarationWorkers {
+    const Visitor &pass;
+    const IR::Vector<IR::Node> &objects;
+    Visitor_Context context;
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> errors;
+
+    static void *work(void *arg);
+
+ public:
+    std::vector<const IR::Node *> results;
+
+    DeclarationWorkers(const Visitor &pass, const IR::P4Program *program,
+                       const Visitor_Context *parent)
+        : pass(pass), objects(program->objects), errors(objects.size()), results(objects.size()) {
+        context.parent = parent;
+        context.node = context.original = program;
+        context.child_name = "objects";
+        context.depth = parent ? parent->depth + 1 : 1;
+    }
+    void run(unsigned jobs);
+};
+
+void *DeclarationWorkers::work(void *arg) {
+    auto *self = static_cast<DeclarationWorkers *>(arg);
+    gc_register_thread();
+    Visitor *visitor = self->pass.clone();
+    BUG_CHECK(visitor->check_clone(&self->pass), "Incorrect clone of %s", self->pass.name());
+    // Visitors update the child index of their parent context, so each worker needs its own.
+    Visitor_Context context = self->context;
+    for (size_t i = self->next++; i < self->objects.size(); i = self->next++) {
+        try {
+            context.child_index = i;
+            self->results[i] = self->objects.at(i)->apply(*visitor, &context);
+        } catch (...) {
+            self->errors[i] = std::current_exception();
+        }
+    }
+    gc_unregister_thread();
+    return nullptr;
+}
+
+void DeclarationWorkers::run(unsigned jobs) {
+    std::vector<pthread_t> workers;
+    for (unsigned i = 0; i < jobs && i < objects.size(); ++i) {
+        pthread_t tid;
+        pthread_attr_t attr;
+        int err;
+        // IR traversals recurse deeply; give workers a stack that is not the (small) default.
+        size_t stack_size = 1024 * 1024 * 64;  // 64MB
+        err = pthread_attr_init(&attr);
+        BUG_CHECK(!err, "Pthread Attribute initialization fail with error: %d", err);
+        err = pthread_attr_setstacksize(&attr, stack_size);
+        BUG_CHECK(!err, "Pthread Attribute Set Stack Size fail with error: %d", err);
+        err = pthread_create(&tid, &attr, work, this);
+        BUG_CHECK(!err, "Pthread Creation fail with error: %d", err);
+        err = pthread_attr_destroy(&attr);
+        BUG_CHECK(!err, "Pthread Attribute destroy fail with error: %d", err);
+        workers.push_back(tid);
+    }
+    for (auto tid : workers) pthread_join(tid, nullptr);
+    for (auto &error : errors)
+        if (error) std::rethrow_exception(error);
+}
+
+}  // namespace
+
+const IR::Node *PassManager::applyPerDeclaration(Visitor &v, const IR::Node *program) {
+    auto *p4program = program->checkedTo<IR::P4Program>();
+    DeclarationWorkers workers(v, p4program, getChildContext());
+    // The collector only lets threads register themselves once a registered thread allowed it.
+    gc_allow_register_threads();
+    LOG2("running " << v.name() << " over " << p4program->objects.size() << " objects on "
+                    << jobs << " threads");
+    workers.run(jobs);
+
+    bool changed = false;
+    IR::Vector<IR::Node> objects;
+    for (size_t i = 0; i < workers.results.size(); ++i) {
+        auto *result = workers.results[i];
+        if (result != p4program->objects.at(i)) changed = true;
+        objects.pushBackOrAppend(result);
+    }
+    if (!changed) return program;
+    auto *rv = p4program->clone();
+    rv->objects = objects;
+    return rv;
+}
+#endif  // MULTITHREAD
+
 bool PassManager::backtrack(trigger &trig) {
     for (Visitor *v : passes)
         if (auto *bt = dynamic_cast<Backtrack *>(v))
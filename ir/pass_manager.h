@@ -37,9 +37,22 @@ typedef std::function<void(const char *manager, unsigned seqNo, const char *pass
                            const IR::Node *node)>
     DebugHook;
 
+/// Marker for passes whose effect on a P4Program is confined to each top-level declaration:
+/// the pass does not look at the P4Program node itself, does not depend on other top-level
+/// objects and keeps no state across its applications.  A PassManager with parallel jobs
+/// enabled may apply clones of such a pass to the declarations concurrently, so the pass
+/// must also implement clone().
+class DeclarationLocal : virtual public Visitor {};
+
 class PassManager : virtual public Visitor, virtual public Backtrack {
     bool early_exit_flag = false;
     mutable int never_backtracks_cache = -1;
+    // number of worker threads used for DeclarationLocal passes
+    unsigned jobs = 1;
+
+#ifdef MULTITHREAD
+    const IR::Node *applyPerDeclaration(Visitor &v, const IR::Node *program);
+#endif  // MULTITHREAD
 
  protected:
     safe_vector<DebugHook> debugHooks;  // called after each pass
@@ -120,6 +133,17 @@ class PassManager : virtual public Visitor, virtual public Backtrack {
                 if (auto child = dynamic_cast<PassManager *>(pass))
                     child->addDebugHooks(hooks, recursive);
     }
+    /// Run DeclarationLocal passes on @jobs worker threads, one top-level declaration at a
+    /// time.  Only effective in MULTITHREAD builds; other passes always run on the calling
+    /// thread.
+    void setParallelJobs(unsigned jobs, bool recursive = false) {
+        this->jobs = jobs;
+        if (recursive)
+            for (auto pass : passes)
+                if (auto child = dynamic_cast<PassManager *>(pass))
+                    child->setParallelJobs(jobs, recursive);
+    }
+    unsigned parallelJobs() const { return jobs; }
     void early_exit() { early_exit_flag = true; }
     PassManager *clone() const override { return new PassManager(*this); }
 };
@@ -0,0 +1,209 @@
+#include "ir/pass_profile.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#include "ir/visitor.h"
+#include "lib/gc.h"
+#include "lib/json.h"
+
+namespace P4 {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ProfileState {
+    bool enabled = false;
+    bool writeAtExit = false;
+    std::filesystem::path file;
+    Clock::time_point origin;
+    std::vector<PassProfile::Record> records;
+    /// Indices in records of the passes currently running, outermost first.
+    std::vector<size_t> running;
+    /// Passes that do not change the program are common; do not count it again.
+    const IR::Node *counted = nullptr;
+    size_t count = 0;
+};
+
+ProfileState &state() {
+    // Never destroyed: the profile is written by an exit handler.
+    static auto *state = new ProfileState;
+    return *state;
+}
+
+class CountNodes : public Inspector {
+ public:
+    size_t count = 0;
+    bool preorder(const IR::Node *) override {
+        ++count;
+        return true;
+    }
+};
+
+size_t countNodes(const IR::Node *program) {
+    auto &s = state();
+    if (program == nullptr) return 0;
+    if (program != s.counted) {
+        CountNodes counter;
+        program->apply(counter);
+        s.counted = program;
+        s.count = counter.count;
+    }
+    return s.count;
+}
+
+uint64_t bytesAllocated() { return gc_bytes_allocated(); }
+
+uint64_t microseconds(Clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+void writeAtExit() {
+    auto &s = state();
+    if (!s.enabled || s.file.empty()) return;
+    std::ofstream out(s.file);
+    if (!out) {
+        std::cerr << s.file << ": cannot write pass profile" << std::endl;
+        return;
+    }
+    PassProfile::write(out);
+}
+
+}  // namespace
+
+void PassProfile::enable(std::filesystem::path file) {
+    auto &s = state();
+    s.enabled = true;
+    s.file = std::move(file);
+    s.origin = Clock::now();
+    s.records.clear();
+    s.running.clear();
+    s.counted = nullptr;
+    if (!s.writeAtExit) {
+        s.writeAtExit = true;
+        std::atexit(writeAtExit);
+    }
+}
+
+void PassProfile::disable() {
+    auto &s = state();
+    s.enabled = false;
+    s.records.clear();
+    s.running.clear();
+    s.counted = nullptr;
+}
+
+bool PassProfile::isEnabled() { return state().enabled; }
+
+bool PassProfile::insidePass() { return !state().running.empty(); }
+
+const std::vector<PassProfile::Record> &PassProfile::records() { return state().records; }
+
+void PassProfile::nodesTyped(uint64_t count) {
+    auto &s = state();
+    if (!s.enabled) return;
+    for (auto index : s.running) s.records[index].nodesTyped += count;
+}
+
+PassProfile::Scope::Scope(const char *pass, const IR::Node *program)
+    : index(0), active(state().enabled) {
+    if (!active) return;
+    auto &s = state();
+    Record record;
+    record.pass = pass;
+    record.path = s.running.empty() ? pass : s.records[s.running.back()].path + "." + pass;
+    record.depth = s.running.size();
+    // Counting nodes takes time that is not the pass's own.
+    record.nodesBefore = countNodes(program);
+    record.allocatedBytes = bytesAllocated();
+    record.nodesCloned = Transform::nodesCloned();
+    record.clonesAvoided = Transform::clonesAvoided();
+    record.start = microseconds(Clock::now() - s.origin);
+    index = s.records.size();
+    s.records.push_back(std::move(record));
+    s.running.push_back(index);
+}
+
+void PassProfile::Scope::finish(const IR::Node *program) {
+    if (!active) return;
+    active = false;
+    auto &s = state();
+    // Disabled while the pass ran.
+    if (!s.enabled || index >= s.records.size()) return;
+    auto &record = s.records[index];
+    record.duration = microseconds(Clock::now() - s.origin) - record.start;
+    record.allocatedBytes = bytesAllocated() - record.allocatedBytes;
+    record.nodesCloned = Transform::nodesCloned() - record.nodesCloned;
+    record.clonesAvoided = Transform::clonesAvoided() - record.clonesAvoided;
+    record.nodesAfter = countNodes(program);
+    if (!s.running.empty() && s.running.back() == index) s.running.pop_back();
+}
+
+PassProfile::Scope::~Scope() {
+    // Passes that throw, e.g. to backtrack, end without a result.
+    finish(nullptr);
+}
+
+void PassProfile::write(std::ostream &out) {
+    struct Totals {
+        uint64_t calls = 0, microseconds = 0, allocatedBytes = 0, nodesCloned = 0,
+                 clonesAvoided = 0, nodesTyped = 0;
+    };
+    std::map<std::string, Totals> totals;
+
+    auto *events = new Util::JsonArray();
+    for (const auto &record : state().records) {
+        auto *args = new Util::JsonObject();
+        args->emplace("path", record.path);
+        args->emplace("allocatedBytes", record.allocatedBytes);
+        args->emplace("nodesBefore", record.nodesBefore);
+        args->emplace("nodesAfter", record.nodesAfter);
+        args->emplace("nodesCloned", record.nodesCloned);
+        args->emplace("clonesAvoided", record.clonesAvoided);
+        args->emplace("nodesTyped", record.nodesTyped);
+        auto *event = new Util::JsonObject();
+        event->emplace("name", record.pass);
+        event->emplace("cat", "pass");
+        event->emplace("ph", "X");
+        event->emplace("ts", record.start);
+        event->emplace("dur", record.duration);
+        event->emplace("pid", 1);
+        event->emplace("tid", 1);
+        event->emplace("args", args);
+        events->append(event);
+
+        auto &total = totals[record.path];
+        ++total.calls;
+        total.microseconds += record.duration;
+        total.allocatedBytes += record.allocatedBytes;
+        total.nodesCloned += record.nodesCloned;
+        total.clonesAvoided += record.clonesAvoided;
+        total.nodesTyped += record.nodesTyped;
+    }
+
+    auto *summary = new Util::JsonArray();
+    for (const auto &[path, total] : totals) {
+        auto *entry = new Util::JsonObject();
+        entry->emplace("path", path);
+        entry->emplace("calls", total.calls);
+        entry->emplace("microseconds", total.microseconds);
+        entry->emplace("allocatedBytes", total.allocatedBytes);
+        entry->emplace("nodesCloned", total.nodesCloned);
+        entry->emplace("clonesAvoided", total.clonesAvoided);
+        entry->emplace("nodesTyped", total.nodesTyped);
+        summary->append(entry);
+    }
+
+    Util::JsonObject profile;
+    profile.emplace("traceEvents", events);
+    profile.emplace("displayTimeUnit", "ms");
+    profile.emplace("passSummary", summary);
+    profile.serialize(out);
+    out << std::endl;
+}
+
+}  // namespace P4
@@ -0,0 +1,74 @@
+#ifndef IR_PASS_PROFILE_H_
+#define IR_PASS_PROFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "ir/node.h"
+
+namespace P4 {
+
+/// Per-pass profile of a compilation, enabled with --pass-profile.
+///
+/// While enabled, every PassManager records each pass it runs: the wall time, the bytes
+/// allocated for it from the collected heap, the number of IR nodes in the program before and
+/// after, the number of nodes cloned by Transforms or left uncloned by those in cloneOnWrite
+/// mode, and the number of nodes given a type by type inference.  Passes of nested PassManagers
+/// are recorded too, so the record of a manager includes those of its passes.
+///
+/// The profile is written at exit as a Chrome trace (chrome://tracing, Perfetto) with the
+/// counters in the arguments of each event.  Its top-level "passSummary" array totals the
+/// records per pass, for scripts tracking compile times from one release to the next.
+class PassProfile {
+ public:
+    struct Record {
+        std::string pass;
+        /// Names of the enclosing PassManagers and of the pass, separated by '.'.
+        std::string path;
+        unsigned depth = 0;
+        /// Microseconds since profiling was enabled, and spent in the pass.
+        uint64_t start = 0, duration = 0;
+        uint64_t allocatedBytes = 0;
+        uint64_t nodesCloned = 0;
+        /// Nodes left uncloned by Transforms in cloneOnWrite mode.
+        uint64_t clonesAvoided = 0;
+        uint64_t nodesTyped = 0;
+        size_t nodesBefore = 0, nodesAfter = 0;
+    };
+
+    /// Starts recording.  The profile is written to @p file at exit, unless it is empty.
+    static void enable(std::filesystem::path file);
+    /// Stops recording and drops the records.
+    static void disable();
+    static bool isEnabled();
+    /// True while some pass is being measured.
+    static bool insidePass();
+
+    static const std::vector<Record> &records();
+    /// Adds @p count nodes typed to the passes running.
+    static void nodesTyped(uint64_t count);
+    static void write(std::ostream &out);
+
+    /// Measures one application of a pass by a PassManager, from construction to finish().
+    /// Does nothing unless profiling is enabled.
+    class Scope {
+        size_t index;
+        bool active;
+
+     public:
+        Scope(const char *pass, const IR::Node *program);
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope();
+        /// @p program is the result of the pass, or null if it did not produce one.
+        void finish(const IR::Node *program);
+    };
+};
+
+}  // namespace P4
+
+#endif /* IR_PASS_PROFILE_H_ */
@@ -16,6 +16,9 @@ limitations under the License.
 
 #include <cstddef>
 #include <map>
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 #include <utility>
 
 #include "frontends/common/parser_options.h"
@@ -49,9 +52,15 @@ const IR::ID IR::Type_Table::hit = ID("hit");
 const IR::ID IR::Type_Table::miss = ID("miss");
 const IR::ID IR::Type_Table::action_run = ID("action_run");
 
+#ifdef MULTITHREAD
+std::atomic<long> Type_Declaration::nextId{0};
+std::atomic<long> Type_InfInt::nextId{0};
+std::atomic<long> Type_Any::nextId{0};
+#else
 long Type_Declaration::nextId = 0;
 long Type_InfInt::nextId = 0;
 long Type_Any::nextId = 0;
+#endif  // MULTITHREAD
 
 const Type *Type_Stack::at(size_t) const { return elementType; }
 
@@ -59,6 +68,10 @@ const Type_Bits *Type_Bits::get(int width, bool isSigned) {
     // map (width, signed) to type
     using bit_type_key = std::pair<int, bool>;
     static std::map<bit_type_key, const IR::Type_Bits *> *type_map = nullptr;
+#ifdef MULTITHREAD
+    static std::mutex type_map_lock;
+    std::lock_guard<std::mutex> guard(type_map_lock);
+#endif  // MULTITHREAD
     if (type_map == nullptr) type_map = new std::map<bit_type_key, const IR::Type_Bits *>();
     auto &result = (*type_map)[std::make_pair(width, isSigned)];
     if (!result) result = new Type_Bits(width, isSigned);
@@ -88,8 +101,8 @@ const Type_Bits *Type_Bits::get(const Util::SourceInfo &si, const IR::Expression
 }
 
 const Type_Unknown *Type_Unknown::get() {
-    static const Type_Unknown *singleton = nullptr;
-    if (!singleton) singleton = (new Type_Unknown());
+    // Initialized once, also when first requested by concurrent threads.
+    static const Type_Unknown *singleton = new Type_Unknown();
     return singleton;
 }
 
@@ -99,8 +112,8 @@ const Type_Unknown *Type_Unknown::get(const Util::SourceInfo &si) {
 }
 
 const Type_Boolean *Type_Boolean::get() {
-    static const Type_Boolean *singleton = nullptr;
-    if (!singleton) singleton = (new Type_Boolean());
+    // Initialized once, also when first requested by concurrent threads.
+    static const Type_Boolean *singleton = new Type_Boolean();
     return singleton;
 }
 
@@ -110,8 +123,8 @@ const Type_Boolean *Type_Boolean::get(const Util::SourceInfo &si) {
 }
 
 const Type_String *Type_String::get() {
-    static const Type_String *singleton = nullptr;
-    if (!singleton) singleton = (new Type_String());
+    // Initialized once, also when first requested by concurrent threads.
+    static const Type_String *singleton = new Type_String();
     return singleton;
 }
 
@@ -134,9 +147,20 @@ const Type_Varbits *Type_Varbits::get(const Util::SourceInfo &si, int sz) {
     return result;
 }
 
-const Type_Varbits *Type_Varbits::get(int sz) { return new Type_Varbits(sz); }
+const Type_Varbits *Type_Varbits::get(int sz) {
+    // Interned like Type_Bits, so that canonical types can be compared by address.
+    static std::map<int, const IR::Type_Varbits *> *type_map = nullptr;
+#ifdef MULTITHREAD
+    static std::mutex type_map_lock;
+    std::lock_guard<std::mutex> guard(type_map_lock);
+#endif  // MULTITHREAD
+    if (type_map == nullptr) type_map = new std::map<int, const IR::Type_Varbits *>();
+    auto &result = (*type_map)[sz];
+    if (!result) result = new Type_Varbits(sz);
+    return result;
+}
 
-const Type_Varbits *Type_Varbits::get() { return new Type_Varbits(0); }
+const Type_Varbits *Type_Varbits::get() { return get(0); }
 
 const Type_InfInt *Type_InfInt::get() {
     // We do not cache types with declaration IDs (yet).
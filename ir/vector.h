@@ -24,6 +24,7 @@ limitations under the License.
 #include "lib/safe_vector.h"
 
 namespace P4 {
+class BinaryReader;
 class JSONLoader;
 }  // namespace P4
 
@@ -49,6 +50,7 @@ class VectorBase : public Node {
 
  protected:
     explicit VectorBase(JSONLoader &json) : Node(json) {}
+    explicit VectorBase(BinaryReader &in) : Node(in) {}
 
     DECLARE_TYPEINFO_WITH_TYPEID(VectorBase, NodeKind::VectorBase, Node);
 };
@@ -65,6 +67,7 @@ class Vector : public VectorBase {
     Vector(const Vector &) = default;
     Vector(Vector &&) = default;
     explicit Vector(JSONLoader &json);
+    explicit Vector(BinaryReader &in);
     Vector &operator=(const Vector &) = default;
     Vector &operator=(Vector &&) = default;
     explicit Vector(const T *a) { vec.emplace_back(a); }
@@ -75,6 +78,7 @@ class Vector : public VectorBase {
     Vector(Util::Enumerator<const T *> *e)  // NOLINT(runtime/explicit)
         : vec(e->begin(), e->end()) {}
     static Vector<T> *fromJSON(JSONLoader &json);
+    static Vector<T> *fromBinary(BinaryReader &in);
 
     using iterator = typename safe_vector<const T *>::iterator;
     using const_iterator = typename safe_vector<const T *>::const_iterator;
@@ -192,6 +196,7 @@ class Vector : public VectorBase {
     virtual void parallel_visit_children(Visitor &v, const char *name = nullptr);
     virtual void parallel_visit_children(Visitor &v, const char *name = nullptr) const;
     void toJSON(JSONGenerator &json) const override;
+    void toBinary(BinaryWriter &out) const override;
     Util::Enumerator<const T *> *getEnumerator() const { return Util::enumerate(vec); }
     template <typename S>
     Util::Enumerator<const S *> *only() const {
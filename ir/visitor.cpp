@@ -20,6 +20,13 @@ limitations under the License.
 #include <stdlib.h>
 #include <time.h>
 
+#include <optional>
+#include <vector>
+
+#ifdef MULTITHREAD
+#include <atomic>
+#endif  // MULTITHREAD
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -378,7 +385,19 @@ Visitor::profile_t Transform::init_apply(const IR::Node *root) {
 void Visitor::end_apply() {}
 void Visitor::end_apply(const IR::Node *) {}
 
+#ifdef MULTITHREAD
+static std::atomic<uint64_t> transform_clones{0}, transform_clones_avoided{0};
+#else
+static uint64_t transform_clones = 0, transform_clones_avoided = 0;
+#endif  // MULTITHREAD
+uint64_t Transform::nodesCloned() { return transform_clones; }
+uint64_t Transform::clonesAvoided() { return transform_clones_avoided; }
+
+#ifdef MULTITHREAD
+static thread_local indent_t profile_indent;
+#else
 static indent_t profile_indent;
+#endif  // MULTITHREAD
 static absl::Time first_start = absl::InfinitePast();
 
 Visitor::profile_t::profile_t(Visitor &v_) : v(v_) {
@@ -535,8 +554,42 @@ const IR::Node *Inspector::apply_visitor(const IR::Node *n, const char *name) {
     return n;
 }
 
+/** The children of a node visited by a cloneOnWrite Transform without cloning it.
+ *  Their results are recorded so that, if one of them changed, they can be stored into the
+ *  clone made then without visiting them again. */
+struct Transform::Probe {
+    const Context *parent;
+    std::vector<const IR::Node *> results;
+    bool changed = false;
+    bool replay = false;
+    size_t next = 0;
+
+    Probe(Transform &self, const Context *parent)
+        : parent(parent), self(self), saved(std::exchange(self.probe, this)) {}
+    ~Probe() { self.probe = saved; }
+
+ private:
+    Transform &self;
+    Probe *saved;
+};
+
 const IR::Node *Transform::apply_visitor(const IR::Node *n, const char *name) {
     if (ctxt) ctxt->child_name = name;
+    Probe *record = nullptr;
+    if (probe && ctxt == probe->parent) {
+        if (probe->replay) {
+            if (probe->next < probe->results.size()) {
+                ctxt->child_index++;
+                return probe->results[probe->next++];
+            }
+        } else if (probe->changed) {
+            // The parent will be cloned, and its remaining children visited then
+            return n;
+        } else {
+            record = probe;
+        }
+    }
+    const IR::Node *orig = n;
     if (n) {
         PushContext local(ctxt, n);
         switch (visited->try_start(n, visitDagOnce)) {
@@ -550,16 +603,33 @@ const IR::Node *Transform::apply_visitor(const IR::Node *n, const char *name) {
                 n = visited->result(n);
                 break;
             default: {  // New or Revisit
+                std::optional<Probe> lazy;
+                if (cloneOnWrite && !forceClone && passesThrough(n)) {
+                    lazy.emplace(*this, &local.current);
+                    n->visit_children(*this, name);
+                    if (!lazy->changed) {
+                        ++transform_clones_avoided;
+                        visited->finish(n, n);
+                        break;
+                    }
+                    lazy->replay = true;
+                    local.current.child_index = 0;
+                }
                 auto *copy = n->clone();
+                ++transform_clones;
                 local.current.node = copy;
-                if (!dontForwardChildrenBeforePreorder) {
+                // Replayed children must be stored in the same slots they were visited from.
+                if (!dontForwardChildrenBeforePreorder && !lazy) {
                     ForwardChildren forward_children(*visited);
                     copy->visit_children(forward_children, name);
                 }
                 bool save_prune_flag = prune_flag;
                 prune_flag = false;
                 bool extra_clone = false;
+                bool learn = cloneOnWrite && !lazy && !passThrough.count(n->typeId());
+                defaultChain = n->typeId();
                 const IR::Node *preorder_result = copy->apply_visitor_preorder(*this);
+                bool default_preorder = defaultChain == defaultChainDone;
                 assert(preorder_result != n);  // should never happen
                 const IR::Node *final_result = preorder_result;
                 if (preorder_result != copy) {
@@ -578,11 +648,17 @@ const IR::Node *Transform::apply_visitor(const IR::Node *n, const char *name) {
                         // Sanity check for IR loops
                         if (status == VisitStatus::Busy) BUG("IR loop detected ");
                         local.current.node = copy = preorder_result->clone();
+                        ++transform_clones;
                     }
                 }
                 if (!prune_flag) {
                     copy->visit_children(*this, name);
+                    defaultChain = copy->typeId();
                     final_result = copy->apply_visitor_postorder(*this);
+                    // Both functions are only known to be defaults when neither was skipped.
+                    if (learn && !extra_clone)
+                        passThrough[n->typeId()] =
+                            default_preorder && defaultChain == defaultChainDone;
                 }
                 prune_flag = save_prune_flag;
                 if (final_result == copy && final_result != preorder_result &&
@@ -595,10 +671,20 @@ const IR::Node *Transform::apply_visitor(const IR::Node *n, const char *name) {
             }
         }
     }
+    // Visits from within a preorder or postorder break the chain of defaults.
+    defaultChain = RTTI::InvalidTypeId;
     if (ctxt)
         ctxt->child_index++;
     else
         visited.reset();
+    if (record) {
+        record->results.push_back(n);
+        // The parent is not cloned yet, so its const visit must see the child unchanged.
+        if (n != orig) {
+            record->changed = true;
+            return orig;
+        }
+    }
     return n;
 }
 
@@ -627,9 +713,11 @@ bool Transform::visit_in_progress(const IR::Node *n) const { return visited->bus
         loop_revisit(static_cast<const IR::BASE *>(n));                                            \
     }                                                                                              \
     const IR::Node *Transform::preorder(IR::CLASS *n) {                                            \
+        followDefault(IR::CLASS::TypeInfo::id(), IR::BASE::TypeInfo::id());                        \
         return preorder(static_cast<IR::BASE *>(n));                                               \
     }                                                                                              \
     const IR::Node *Transform::postorder(IR::CLASS *n) {                                           \
+        followDefault(IR::CLASS::TypeInfo::id(), IR::BASE::TypeInfo::id());                        \
         return postorder(static_cast<IR::BASE *>(n));                                              \
     }                                                                                              \
     void Transform::revisit(const IR::CLASS *o, const IR::Node *n) {                               \
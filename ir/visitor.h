@@ -440,11 +440,39 @@ class Transform : public virtual Visitor {
     void visitor_const_error() override;
     bool check_clone(const Visitor *) override;
 
+    // State for cloneOnWrite.  The default preorder/postorder functions each check that they
+    // were called by the default for the class derived from theirs, so a chain of them that
+    // reaches IR::Node shows that this Transform has no function for the type of the node.
+    struct Probe;
+    Probe *probe = nullptr;  // innermost node whose children are visited without cloning it
+    static constexpr RTTI::TypeId defaultChainDone = ~RTTI::TypeId(0);
+    RTTI::TypeId defaultChain = RTTI::InvalidTypeId;
+    std::unordered_map<RTTI::TypeId, bool> passThrough;  // node types with only defaults
+    void followDefault(RTTI::TypeId cls, RTTI::TypeId base) {
+        defaultChain = defaultChain == cls ? base : RTTI::InvalidTypeId;
+    }
+    bool passesThrough(const IR::Node *n) const {
+        auto it = passThrough.find(n->typeId());
+        return it != passThrough.end() && it->second;
+    }
+
  public:
     profile_t init_apply(const IR::Node *root) override;
     const IR::Node *apply_visitor(const IR::Node *, const char *name = 0) override;
-    virtual const IR::Node *preorder(IR::Node *n) { return n; }
-    virtual const IR::Node *postorder(IR::Node *n) { return n; }
+    // The default preorder/postorder functions below, and those IRNODE_ALL_SUBCLASSES declares,
+    // tell cloneOnWrite which node types a Transform handles.  A Transform in cloneOnWrite mode,
+    // or one derived from it, must not call them from its own preorder/postorder (e.g. `return
+    // Transform::postorder(e);`): the types they handle would then be taken for types the
+    // Transform has no function for, and its functions would be skipped for every later node
+    // of those types whose children do not change.  Return the node instead.
+    virtual const IR::Node *preorder(IR::Node *n) {
+        followDefault(IR::Node::TypeInfo::id(), defaultChainDone);
+        return n;
+    }
+    virtual const IR::Node *postorder(IR::Node *n) {
+        followDefault(IR::Node::TypeInfo::id(), defaultChainDone);
+        return n;
+    }
     virtual void revisit(const IR::Node *, const IR::Node *) {}
     virtual void loop_revisit(const IR::Node *) { BUG("IR loop detected"); }
 #define DECLARE_VISIT_FUNCTIONS(CLASS, BASE)                   \
@@ -460,6 +488,10 @@ class Transform : public virtual Visitor {
     void visitAgain() const override;
     // can only be called usefully from a 'preorder' function (directly or indirectly)
     void prune() { prune_flag = true; }
+    /// Number of nodes cloned by all Transforms so far, for profiling.
+    static uint64_t nodesCloned();
+    /// Number of nodes left uncloned by Transforms in cloneOnWrite mode so far.
+    static uint64_t clonesAvoided();
 
  protected:
     const IR::Node *transform_child(const IR::Node *child) {
@@ -468,6 +500,11 @@ class Transform : public virtual Visitor {
         return rv;
     }
     bool forceClone = false;  // force clone whole tree even if unchanged
+    // if cloneOnWrite is 'true', nodes of types for which this Transform has no preorder or
+    // postorder are only cloned when one of their children changes.  The children of such a
+    // node see the original rather than a copy as their parent in the context.  See the
+    // default preorder/postorder above for what overriding functions must not call.
+    bool cloneOnWrite = false;
 };
 
 // turn this on for extra info tracking control joinFlows for debugging
@@ -0,0 +1,156 @@
+#ifndef LIB_COW_MAP_H_
+#define LIB_COW_MAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "hvec_map.h"
+
+namespace P4 {
+
+/// A map whose copies share their entries until they change them.  A copy costs a pointer
+/// copy; the first change to a copy copies the table of the map, which holds pointers to the
+/// values, and the first change to a value copies that value only.
+///
+/// This is meant for the state of flow-sensitive visitors (ControlFlowVisitor), which clone
+/// themselves at every branch and merge the clones where the branches join: each branch
+/// copies only the entries it changes, and merging two entries that were not changed by
+/// either branch can be skipped, as they are the same object (see same()).
+///
+/// Values are reached through a const interface, and only operator[] gives a reference that
+/// can be changed, which copies the value first if it is shared.  Iteration is in insertion
+/// order, as for hvec_map.  Copies can be used by different threads, as long as each map is
+/// only used by one thread at a time.
+///
+/// As in persistent_map, a map only changes in place the table and the values it created
+/// since it was last copied: each is tagged with the owner of the map that created it, and
+/// copying a map gives both maps new owners.  Whether the table or a value is shared is never
+/// read from its reference count, which another thread releasing its copy could change at any
+/// time.
+template <class KEY, class VAL, class HASH = std::hash<KEY>>
+class cow_map {
+    /// A value, with the owner of the map that created it.
+    struct entry {
+        VAL value;
+        uint64_t owner;
+        explicit entry(uint64_t owner) : value(), owner(owner) {}
+        entry(const VAL &value, uint64_t owner) : value(value), owner(owner) {}
+    };
+    using entries_t = hvec_map<KEY, std::shared_ptr<entry>, HASH>;
+    /// The entries, with the owner of the map that created them.
+    struct table_t {
+        entries_t entries;
+        uint64_t owner;
+        explicit table_t(uint64_t owner) : entries(), owner(owner) {}
+        table_t(const entries_t &entries, uint64_t owner) : entries(entries), owner(owner) {}
+    };
+    std::shared_ptr<table_t> table;
+    /// Changed when the map is copied, including by a copy from another thread, hence atomic.
+    mutable std::atomic<uint64_t> owner{newOwner()};
+
+    static uint64_t newOwner() {
+        static std::atomic<uint64_t> owners{0};
+        return owners.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /// The entries, copied first if this map did not create them since it was last copied.
+    entries_t &own() {
+        uint64_t self = owner.load(std::memory_order_relaxed);
+        if (!table)
+            table = std::make_shared<table_t>(self);
+        else if (table->owner != self)
+            table = std::make_shared<table_t>(table->entries, self);
+        return table->entries;
+    }
+
+ public:
+    cow_map() = default;
+    cow_map(const cow_map &other) : table(other.table) {
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+    }
+    cow_map(cow_map &&other) : table(std::move(other.table)) {
+        // This map may now change the table and the values that the other map created.
+        owner.store(other.owner.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+    }
+    cow_map &operator=(const cow_map &other) {
+        if (this == &other) return *this;
+        table = other.table;
+        owner.store(newOwner(), std::memory_order_relaxed);
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+        return *this;
+    }
+    cow_map &operator=(cow_map &&other) {
+        if (this == &other) return *this;
+        table = std::move(other.table);
+        owner.store(other.owner.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    size_t size() const { return table ? table->entries.size() : 0; }
+    bool empty() const { return size() == 0; }
+    size_t count(const KEY &key) const { return find(key) != nullptr; }
+
+    /// The value of @p key, or nullptr if it has none.
+    const VAL *find(const KEY &key) const {
+        if (!table) return nullptr;
+        auto it = table->entries.find(key);
+        return it == table->entries.end() ? nullptr : &it->second->value;
+    }
+
+    /// The value of @p key, inserted if it has none, which can be changed.
+    VAL &operator[](const KEY &key) {
+        auto &slot = own()[key];
+        uint64_t self = owner.load(std::memory_order_relaxed);
+        if (!slot)
+            slot = std::make_shared<entry>(self);
+        else if (slot->owner != self)
+            slot = std::make_shared<entry>(slot->value, self);
+        return slot->value;
+    }
+
+    /// True if the value of @p key in this map and in @p other is the same object, as it is
+    /// if neither map changed it since one was copied from the other.
+    bool same(const cow_map &other, const KEY &key) const {
+        if (!table || !other.table) return false;
+        if (table == other.table) return table->entries.count(key) != 0;
+        auto a = table->entries.find(key), b = other.table->entries.find(key);
+        return a != table->entries.end() && b != other.table->entries.end() &&
+               a->second == b->second;
+    }
+
+    size_t erase(const KEY &key) {
+        return table && table->entries.count(key) ? own().erase(key) : 0;
+    }
+    void clear() { table.reset(); }
+
+    /// Calls @p f with each key and its value, in insertion order.
+    template <class F>
+    void forEach(F &&f) const {
+        if (!table) return;
+        for (auto &[key, slot] : table->entries) f(key, std::as_const(slot->value));
+    }
+
+    /// True if the maps have the same keys with equal values.
+    bool operator==(const cow_map &other) const {
+        if (table == other.table) return true;
+        if (size() != other.size()) return false;
+        if (empty()) return true;
+        for (auto &[key, slot] : table->entries) {
+            auto it = other.table->entries.find(key);
+            if (it == other.table->entries.end()) return false;
+            if (it->second != slot && !(it->second->value == slot->value)) return false;
+        }
+        return true;
+    }
+    bool operator!=(const cow_map &other) const { return !(*this == other); }
+};
+
+}  // namespace P4
+
+#endif /* LIB_COW_MAP_H_ */
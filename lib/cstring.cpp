@@ -34,10 +34,15 @@ limitations under the License.
 #include <functional>
 #include <iomanip>
 #include <ios>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <unordered_set>
+#ifdef MULTITHREAD
+#include <atomic>
+#include <mutex>
+#endif  // MULTITHREAD
 
 #include "hash.h"
 
@@ -152,48 +157,114 @@ class table_entry {
     }
 };
 
+// A key that carries its already computed hash, so the hash used to pick the shard is not
+// computed again by the shard's own table.
+struct hashed_view {
+    std::string_view string;
+    size_t hash;
+
+    explicit hashed_view(std::string_view string)
+        : string(string), hash(Util::hash(string.data(), string.length())) {}
+};
+
+inline bool operator==(const table_entry &entry, const hashed_view &key) {
+    return entry == key.string;
+}
+
+inline bool operator==(const hashed_view &key, const table_entry &entry) {
+    return entry == key.string;
+}
+
 // We'd make Util::Hash to be transparent instead. However, this would enable
 // transparent hashing globally and in some cases in very undesired manner. So
 // for now aim for more fine-grained approach.
 struct TableEntryHash {
     using is_transparent = void;
 
-    // IMPORTANT: These two hashes MUST match in order for heterogenous
+    // IMPORTANT: These hashes MUST match in order for heterogenous
     // lookup to work properly
     size_t operator()(const table_entry &entry) const {
         return Util::hash(entry.string(), entry.length());
     }
 
-    size_t operator()(std::string_view entry) const {
-        return Util::hash(entry.data(), entry.length());
-    }
+    size_t operator()(const hashed_view &key) const { return key.hash; }
 };
 
-auto &cache() {
+// The cache is split in shards picked by the top bits of the string hash, each with its own
+// lock, so that threads interning different strings rarely contend.  Without MULTITHREAD
+// there is a single shard and no locking at all.
+#ifdef MULTITHREAD
+constexpr unsigned cache_shard_bits = 6;
+#else
+constexpr unsigned cache_shard_bits = 0;
+#endif  // MULTITHREAD
+
+struct alignas(64) cache_shard {
     // We need node_hash_set due to SSO: we return address of embedded string
     // that should be stable
-    static absl::node_hash_set<table_entry, TableEntryHash, std::equal_to<>> g_cache;
+    absl::node_hash_set<table_entry, TableEntryHash, std::equal_to<>> entries;
+#ifdef MULTITHREAD
+    std::mutex lock;
+    // Kept outside of the table so that cache_size never has to take the lock: it is called
+    // from the GC start callback, possibly while this thread holds it.
+    std::atomic<size_t> count{0}, bytes{0};
+#else
+    size_t count = 0, bytes = 0;
+#endif  // MULTITHREAD
+};
+
+cache_shard *cache() {
+    static cache_shard g_cache[size_t(1) << cache_shard_bits];
 
     return g_cache;
 }
 
+cache_shard &shard_for(const hashed_view &key) {
+    if constexpr (cache_shard_bits == 0) {
+        return cache()[0];
+    } else {
+        return cache()[key.hash >> (std::numeric_limits<size_t>::digits - cache_shard_bits)];
+    }
+}
+
+#ifdef MULTITHREAD
+#define LOCK_SHARD(SHARD) std::lock_guard<std::mutex> shard_guard((SHARD).lock)
+#else
+#define LOCK_SHARD(SHARD)
+#endif  // MULTITHREAD
+
 const char *save_to_cache(const char *string, std::size_t length, table_entry_flags flags) {
     // Checks if string is already cached and if not, calls ctor to construct in
     // place.  As a result, only a single lookup is performed regardless whether
     // entry is in cache or not.
-    return cache()
-        .lazy_emplace(table_entry(string, length, table_entry_flags::no_need_copy),
-                      [string, length, flags](const auto &ctor) { ctor(string, length, flags); })
+    hashed_view key({string, length});
+    auto &shard = shard_for(key);
+    LOCK_SHARD(shard);
+    return shard.entries
+        .lazy_emplace(key,
+                      [string, length, flags, &shard](const auto &ctor) {
+                          ctor(string, length, flags);
+                          shard.count += 1;
+                          shard.bytes += sizeof(table_entry) + length;
+                      })
         ->string();
 }
 
 }  // namespace
 
-bool cstring::is_cached(std::string_view s) { return cache().contains(s); }
+bool cstring::is_cached(std::string_view s) {
+    hashed_view key(s);
+    auto &shard = shard_for(key);
+    LOCK_SHARD(shard);
+    return shard.entries.contains(key);
+}
 
 cstring cstring::get_cached(std::string_view s) {
-    auto entry = cache().find(s);
-    if (entry == cache().end()) return nullptr;
+    hashed_view key(s);
+    auto &shard = shard_for(key);
+    LOCK_SHARD(shard);
+    auto entry = shard.entries.find(key);
+    if (entry == shard.entries.end()) return nullptr;
 
     cstring res;
     res.str = entry->string();
@@ -216,8 +287,11 @@ void cstring::construct_from_literal(const char *string, std::size_t length) {
 
 size_t cstring::cache_size(size_t &count) {
     size_t rv = 0;
-    count = cache().size();
-    for (auto &s : cache()) rv += sizeof(s) + s.length();
+    count = 0;
+    for (size_t i = 0; i < (size_t(1) << cache_shard_bits); ++i) {
+        count += cache()[i].count;
+        rv += cache()[i].bytes;
+    }
     return rv;
 }
 
@@ -54,8 +54,9 @@ limitations under the License.
  *     std::string.
  *   - Interned strings can never be freed, so they'll stick around for the
  *     lifetime of the program.
- *   - The string interning cstring performs is currently not threadsafe, so you
- *     can't safely use cstrings off the main thread.
+ *   - The string interning cstring performs is only threadsafe in builds with
+ *     MULTITHREAD enabled; otherwise you can't safely use cstrings off the main
+ *     thread.
  *
  * Given these tradeoffs, the general rule of thumb to follow is that you should
  * try to convert strings to cstrings early and keep them in that form. That
@@ -22,6 +22,9 @@ limitations under the License.
 #include <set>
 #include <type_traits>
 #include <unordered_map>
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 
 #include <boost/format.hpp>
 
@@ -75,10 +78,23 @@ class ErrorReporter {
     /// list of seen errors, and return false.
     bool error_reported(int err, const Util::SourceInfo source) {
         if (!source.isValid()) return false;
+#ifdef MULTITHREAD
+        std::lock_guard<std::recursive_mutex> guard(diagnoseLock());
+#endif  // MULTITHREAD
         auto p = errorTracker.emplace(err, source);
         return !p.second;  // if insertion took place, then we have not seen the error.
     }
 
+#ifdef MULTITHREAD
+    /// Diagnostics may be issued from PassManager worker threads.  The lock is shared by all
+    /// reporters, as they are copied along with the compile context that owns them.  It is
+    /// recursive, as each overload of diagnose() holds it while forwarding to the next one.
+    static std::recursive_mutex &diagnoseLock() {
+        static std::recursive_mutex lock;
+        return lock;
+    }
+#endif  // MULTITHREAD
+
     /// retrieve the format from the error catalog
     cstring get_error_name(int errorCode) { return ErrorCatalog::getCatalog().getName(errorCode); }
 
@@ -113,6 +129,9 @@ class ErrorReporter {
     template <class T, typename = decltype(std::declval<T>()->getSourceInfo()), typename... Args>
     void diagnose(DiagnosticAction action, const int errorCode, const char *format,
                   const char *suffix, T node, Args &&...args) {
+#ifdef MULTITHREAD
+        std::lock_guard<std::recursive_mutex> guard(diagnoseLock());
+#endif  // MULTITHREAD
         if (!node || error_reported(errorCode, node->getSourceInfo())) return;
 
         if (cstring name = get_error_name(errorCode))
@@ -125,6 +144,9 @@ class ErrorReporter {
     template <typename... Args>
     void diagnose(DiagnosticAction action, const int errorCode, const char *format,
                   const char *suffix, Args &&...args) {
+#ifdef MULTITHREAD
+        std::lock_guard<std::recursive_mutex> guard(diagnoseLock());
+#endif  // MULTITHREAD
         if (cstring name = get_error_name(errorCode))
             diagnose(getDiagnosticAction(errorCode, name, action), name.c_str(), format, suffix,
                      std::forward<Args>(args)...);
@@ -138,6 +160,9 @@ class ErrorReporter {
     void diagnose(DiagnosticAction action, const char *diagnosticName, const char *format,
                   const char *suffix, Args &&...args) {
         if (action == DiagnosticAction::Ignore) return;
+#ifdef MULTITHREAD
+        std::lock_guard<std::recursive_mutex> guard(diagnoseLock());
+#endif  // MULTITHREAD
 
         ErrorMessage::MessageType msgType = ErrorMessage::MessageType::None;
         if (action == DiagnosticAction::Info) {
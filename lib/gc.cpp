@@ -58,7 +58,11 @@ static char emergency_pool[16 * 1024];
 static char *emergency_ptr;
 
 static alloc_trace_cb_t trace_cb;
+#ifdef MULTITHREAD
+static thread_local bool tracing = false;
+#else
 static bool tracing = false;
+#endif  // MULTITHREAD
 #define TRACE_ALLOC(size)                                  \
     if (trace_cb.fn && !tracing) {                         \
         void *buffer[ALLOC_TRACE_DEPTH];                   \
@@ -321,6 +325,27 @@ void setup_gc_logging() {
 #endif /* HAVE_LIBGC */
 }
 
+void gc_allow_register_threads() {
+#if HAVE_LIBGC && defined(MULTITHREAD)
+    maybe_initialize_gc();
+    GC_allow_register_threads();
+#endif
+}
+
+void gc_register_thread() {
+#if HAVE_LIBGC && defined(MULTITHREAD)
+    GC_stack_base sb;
+    GC_get_stack_base(&sb);
+    GC_register_my_thread(&sb);
+#endif
+}
+
+void gc_unregister_thread() {
+#if HAVE_LIBGC && defined(MULTITHREAD)
+    GC_unregister_my_thread();
+#endif
+}
+
 size_t gc_mem_inuse(size_t *max) {
 #if HAVE_LIBGC
     GC_word heapsize, heapfree;
@@ -333,3 +358,11 @@ size_t gc_mem_inuse(size_t *max) {
     return 0;
 #endif
 }
+
+size_t gc_bytes_allocated() {
+#if HAVE_LIBGC
+    return GC_get_total_bytes();
+#else
+    return 0;
+#endif
+}
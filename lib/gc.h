@@ -23,6 +23,17 @@ limitations under the License.
 
 void setup_gc_logging();
 size_t gc_mem_inuse(size_t *max = 0);  // trigger GC, return inuse after
+// Total bytes allocated from the collected heap so far; 0 without the garbage collector.
+size_t gc_bytes_allocated();
+
+// Threads other than the main one that allocate from the collected heap must be made known
+// to the collector for the duration of their work, so that their stacks are scanned.
+// gc_allow_register_threads() must be called by a registered thread, i.e. the thread that
+// creates the workers, before the first of them calls gc_register_thread().
+// All are no-ops unless built with MULTITHREAD and the garbage collector.
+void gc_allow_register_threads();
+void gc_register_thread();
+void gc_unregister_thread();
 
 struct alloc_trace_cb_t {
     void (*fn)(void *arg, void **pc, size_t sz);
@@ -18,6 +18,7 @@ limitations under the License.
 #define LIB_HVEC_MAP_H_
 
 #include <initializer_list>
+#include <iterator>
 #include <tuple>
 #include <vector>
 
@@ -95,8 +96,8 @@ class hvec_map : hash_vector_base {
      public:
         using value_type = VT;
         using difference_type = ssize_t;
-        using pointer = typename HVM::pointer;
-        using reference = typename HVM::reference;
+        using pointer = VT *;
+        using reference = VT &;
         using iterator_category = std::bidirectional_iterator_tag;
         _iter(const _iter &) = default;
         _iter &operator=(const _iter &a) {
@@ -144,6 +145,14 @@ class hvec_map : hash_vector_base {
     const_iterator end() const { return const_iterator(*this, data.size()); }
     const_iterator cbegin() const { return const_iterator(*this, erased.ffz()); }
     const_iterator cend() const { return const_iterator(*this, data.size()); }
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator crend() const { return const_reverse_iterator(begin()); }
 
     bool empty() const { return inuse == 0; }
     size_t size() const { return inuse; }
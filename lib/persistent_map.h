@@ -0,0 +1,250 @@
+#ifndef LIB_PERSISTENT_MAP_H_
+#define LIB_PERSISTENT_MAP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace P4 {
+
+/// An ordered map whose copies share their structure.  The map is a balanced (AVL) search tree,
+/// and a copy costs a pointer copy.  A change to a map copies only the nodes on the path from
+/// the root to the changed entry that are shared with another map, so that a copy that is
+/// changed in a few places costs O(log n) per change, instead of the O(n) of copying a
+/// std::map or flat_map.  Nodes that are not shared are changed in place.
+///
+/// This is meant for states that are copied at every branch of an exploration and changed a
+/// little in each branch, such as the symbolic environment of P4Testgen.
+///
+/// Iteration is in key order, as for std::map, and only through const iterators; find() gives
+/// a pointer to a value, as for cow_map, and operator[] the only reference to a value that can
+/// be changed.  Entries can not be erased.  Copies can be used by different threads, as long as
+/// each map is only used by one thread at a time.
+///
+/// A map only changes in place the nodes it created since it was last copied: each node is
+/// tagged with the owner of the map that created it, and copying a map gives both maps new
+/// owners.  Whether a node is shared is never read from its reference count, which another
+/// thread releasing its copy could change at any time.
+template <class KEY, class VAL, class COMP = std::less<KEY>>
+class persistent_map {
+ public:
+    using key_type = KEY;
+    using mapped_type = VAL;
+    using value_type = std::pair<const KEY, VAL>;
+    using size_type = size_t;
+
+ private:
+    struct node {
+        value_type value;
+        std::shared_ptr<node> left, right;
+        int height = 1;
+        /// The owner of the map that created the node.
+        uint64_t owner;
+
+        node(const KEY &key, uint64_t owner) : value(key, VAL()), owner(owner) {}
+    };
+    using node_ptr = std::shared_ptr<node>;
+
+    node_ptr root;
+    size_t entries = 0;
+    COMP comp;
+    /// Changed when the map is copied, including by a copy from another thread, hence atomic.
+    mutable std::atomic<uint64_t> owner{newOwner()};
+
+    static uint64_t newOwner() {
+        static std::atomic<uint64_t> owners{0};
+        return owners.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static int height(const node_ptr &n) { return n ? n->height : 0; }
+    static void update(node &n) { n.height = 1 + std::max(height(n.left), height(n.right)); }
+
+    /// Makes the node in @p slot one that no other map shares, copying it if this map did not
+    /// create it since it was last copied.
+    void own(node_ptr &slot) {
+        uint64_t self = owner.load(std::memory_order_relaxed);
+        if (slot->owner == self) return;
+        slot = std::make_shared<node>(*slot);
+        slot->owner = self;
+    }
+
+    static void rotateRight(node_ptr &slot) {
+        node_ptr left = slot->left;
+        slot->left = left->right;
+        update(*slot);
+        left->right = std::move(slot);
+        update(*left);
+        slot = std::move(left);
+    }
+
+    static void rotateLeft(node_ptr &slot) {
+        node_ptr right = slot->right;
+        slot->right = right->left;
+        update(*slot);
+        right->left = std::move(slot);
+        update(*right);
+        slot = std::move(right);
+    }
+
+    /// Restores the balance of the node in @p slot after an insertion below it.  Only nodes on
+    /// the path of the insertion, which are owned, are rotated.
+    static void rebalance(node_ptr &slot) {
+        int balance = height(slot->left) - height(slot->right);
+        if (balance > 1) {
+            if (height(slot->left->left) < height(slot->left->right)) rotateLeft(slot->left);
+            rotateRight(slot);
+        } else if (balance < -1) {
+            if (height(slot->right->right) < height(slot->right->left)) rotateRight(slot->right);
+            rotateLeft(slot);
+        } else {
+            update(*slot);
+        }
+    }
+
+    /// The value of @p key in the subtree in @p slot, inserted if it has none, in a node owned
+    /// by this map.  Sets @p inserted if the key was inserted.
+    VAL &lookup(node_ptr &slot, const KEY &key, bool &inserted) {
+        if (!slot) {
+            slot = std::make_shared<node>(key, owner.load(std::memory_order_relaxed));
+            inserted = true;
+            return slot->value.second;
+        }
+        own(slot);
+        VAL *result;
+        if (comp(key, slot->value.first))
+            result = &lookup(slot->left, key, inserted);
+        else if (comp(slot->value.first, key))
+            result = &lookup(slot->right, key, inserted);
+        else
+            return slot->value.second;
+        // Rotations move nodes without copying them, so the reference to the value stays valid.
+        if (inserted) rebalance(slot);
+        return *result;
+    }
+
+ public:
+    persistent_map() = default;
+    persistent_map(const persistent_map &other)
+        : root(other.root), entries(other.entries), comp(other.comp) {
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+    }
+    persistent_map(persistent_map &&other)
+        : root(std::move(other.root)), entries(other.entries), comp(std::move(other.comp)) {
+        other.entries = 0;
+        // This map may now change the nodes that the other map created.
+        owner.store(other.owner.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+    }
+    persistent_map &operator=(const persistent_map &other) {
+        if (this == &other) return *this;
+        root = other.root;
+        entries = other.entries;
+        comp = other.comp;
+        owner.store(newOwner(), std::memory_order_relaxed);
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+        return *this;
+    }
+    persistent_map &operator=(persistent_map &&other) {
+        if (this == &other) return *this;
+        root = std::move(other.root);
+        entries = other.entries;
+        comp = std::move(other.comp);
+        other.entries = 0;
+        owner.store(other.owner.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.owner.store(newOwner(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    size_t size() const { return entries; }
+    bool empty() const { return entries == 0; }
+    size_t count(const KEY &key) const { return find(key) != nullptr; }
+
+    /// The value of @p key, or nullptr if it has none.
+    const VAL *find(const KEY &key) const {
+        for (const node *n = root.get(); n;) {
+            if (comp(key, n->value.first))
+                n = n->left.get();
+            else if (comp(n->value.first, key))
+                n = n->right.get();
+            else
+                return &n->value.second;
+        }
+        return nullptr;
+    }
+
+    class const_iterator {
+        friend class persistent_map;
+        /// The nodes whose entries are still to be visited; the current one is on top.
+        std::vector<const node *> path;
+
+        void descend(const node *n) {
+            for (; n; n = n->left.get()) path.push_back(n);
+        }
+
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = persistent_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        const_iterator() = default;
+        reference operator*() const { return path.back()->value; }
+        pointer operator->() const { return &path.back()->value; }
+        const_iterator &operator++() {
+            const node *n = path.back();
+            path.pop_back();
+            descend(n->right.get());
+            return *this;
+        }
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+        bool operator==(const const_iterator &other) const {
+            if (path.empty() || other.path.empty()) return path.empty() == other.path.empty();
+            return path.back() == other.path.back();
+        }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    };
+    using iterator = const_iterator;
+
+    const_iterator begin() const {
+        const_iterator it;
+        it.descend(root.get());
+        return it;
+    }
+    const_iterator end() const { return const_iterator(); }
+
+    /// The value of @p key, inserted if it has none, which can be changed.
+    VAL &operator[](const KEY &key) {
+        bool inserted = false;
+        VAL &result = lookup(root, key, inserted);
+        if (inserted) ++entries;
+        return result;
+    }
+
+    /// Sets the value of @p key to @p val.  @returns true if the key was inserted.
+    bool insert_or_assign(const KEY &key, VAL val) {
+        bool inserted = false;
+        lookup(root, key, inserted) = std::move(val);
+        if (inserted) ++entries;
+        return inserted;
+    }
+
+    void clear() {
+        root.reset();
+        entries = 0;
+    }
+};
+
+}  // namespace P4
+
+#endif /* LIB_PERSISTENT_MAP_H_ */
@@ -0,0 +1,20 @@
+#ifndef LIB_SHA256_H_
+#define LIB_SHA256_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace P4::Util {
+
+/// SHA-256 (FIPS 180-4).  Meant for content digests that must not collide in practice, such as
+/// the keys of on-disk caches; Util::hash is much faster, but only 64 bits wide.
+std::array<uint8_t, 32> sha256(std::string_view data);
+
+/// The SHA-256 digest of @p data as 64 lowercase hex digits.
+std::string sha256Hex(std::string_view data);
+
+}  // namespace P4::Util
+
+#endif /* LIB_SHA256_H_ */
@@ -17,12 +17,17 @@ limitations under the License.
 #include "source_file.h"
 
 #include <algorithm>
+#include <atomic>
 #include <sstream>
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
+#include "lib/bitops.h"
 #include "lib/exceptions.h"
 #include "lib/log.h"
 #include "lib/stringify.h"
@@ -49,20 +54,107 @@ cstring SourcePosition::toString() const {
 //////////////////////////////////////////////////////////////////////////////////////////
 
 SourceInfo::SourceInfo(const InputSources *sources, SourcePosition start, SourcePosition end)
-    : sources(sources), start(start), end(end) {
+    : sources(sources) {
     BUG_CHECK(sources != nullptr, "Invalid InputSources in SourceInfo");
     if (!start.isValid() || !end.isValid())
         BUG("Invalid source position in SourceInfo %1%-%2%", start.toString(), end.toString());
     if (start > end)
         BUG("SourceInfo position start %1% after end %2%", start.toString(), end.toString());
+    encode(start, end);
+}
+
+SourceInfo::SourceInfo(cstring filename, int line, int column, cstring srcBrief) {
+    Extended loaded;
+    loaded.filename = filename;
+    loaded.line = line;
+    loaded.column = column;
+    loaded.srcBrief = srcBrief;
+    range = extend(loaded);
+}
+
+/// Entries are kept in chunks that double in size and never move, so that reading one needs
+/// only an acquire load of its chunk.  Appending takes a lock and publishes the chunk again
+/// with a release store once the entry is written.
+struct SourceInfo::ExtendedTable {
+    static constexpr size_t firstChunkSize = 1024;
+    static constexpr unsigned maxChunks = 32;
+
+    std::atomic<Extended *> chunks[maxChunks] = {};
+    size_t size = 0;
+#ifdef MULTITHREAD
+    std::mutex lock;
+#endif  // MULTITHREAD
+
+    static ExtendedTable &get() {
+        // Never destroyed: SourceInfos may outlive static destructors.
+        static ExtendedTable *table = new ExtendedTable;
+        return *table;
+    }
+
+    /// @return the chunk holding entry @p index and set @p offset to its place in the chunk.
+    static unsigned chunkOf(size_t index, size_t *offset) {
+        unsigned chunk = floor_log2(index / firstChunkSize + 1);
+        *offset = index - firstChunkSize * ((size_t(1) << chunk) - 1);
+        return chunk;
+    }
+};
+
+const SourceInfo::Extended &SourceInfo::extended(uint64_t range) {
+    size_t offset;
+    unsigned chunk = ExtendedTable::chunkOf(range & ~extendedBit, &offset);
+    return ExtendedTable::get().chunks[chunk].load(std::memory_order_acquire)[offset];
+}
+
+uint64_t SourceInfo::extend(Extended extended) {
+    auto &table = ExtendedTable::get();
+#ifdef MULTITHREAD
+    std::lock_guard<std::mutex> guard(table.lock);
+#endif  // MULTITHREAD
+    size_t offset;
+    unsigned chunk = ExtendedTable::chunkOf(table.size, &offset);
+    BUG_CHECK(chunk < ExtendedTable::maxChunks, "Too many extended source ranges");
+    auto *entries = table.chunks[chunk].load(std::memory_order_relaxed);
+    if (!entries) entries = new Extended[ExtendedTable::firstChunkSize << chunk];
+    entries[offset] = std::move(extended);
+    table.chunks[chunk].store(entries, std::memory_order_release);
+    return extendedBit | table.size++;
+}
+
+void SourceInfo::encode(SourcePosition start, SourcePosition end) {
+    unsigned lineSpan = end.getLineNumber() - start.getLineNumber();
+    bool loaded = (range & extendedBit) && extended(range).loaded();
+    if (!loaded && start.getLineNumber() <= startLineMask &&
+        start.getColumnNumber() <= columnMask && lineSpan <= lineSpanMask &&
+        end.getColumnNumber() <= columnMask) {
+        range = uint64_t(start.getLineNumber()) << startLineShift |
+                uint64_t(start.getColumnNumber()) << startColumnShift |
+                uint64_t(lineSpan) << lineSpanShift | end.getColumnNumber();
+        return;
+    }
+    Extended entry = (range & extendedBit) ? extended(range) : Extended();
+    entry.start = start;
+    entry.end = end;
+    range = extend(std::move(entry));
+}
+
+cstring SourceInfo::filename() const {
+    return (range & extendedBit) ? extended(range).filename : ""_cs;
+}
+
+int SourceInfo::line() const { return (range & extendedBit) ? extended(range).line : -1; }
+
+int SourceInfo::column() const { return (range & extendedBit) ? extended(range).column : -1; }
+
+cstring SourceInfo::srcBrief() const {
+    return (range & extendedBit) ? extended(range).srcBrief : ""_cs;
 }
 
 cstring SourceInfo::toString() const {
-    return absl::StrFormat("(%v)-(%v)", start.toString(), end.toString());
+    return absl::StrFormat("(%v)-(%v)", getStart().toString(), getEnd().toString());
 }
 
 std::ostream &operator<<(std::ostream &os, const SourceInfo &info) {
-    os << absl::StrFormat("(%v)-(%v)", info.start, info.end);
+    os << absl::StrFormat("(%v)-(%v)", info.getStart(), info.getEnd());
     return os;
 }
 
@@ -326,32 +418,32 @@ cstring SourceInfo::toBriefSourceFragment() const {
 
 cstring SourceInfo::toPositionString() const {
     if (!isValid()) return ""_cs;
-    SourceFileLine position = sources->getSourceLine(start.getLineNumber());
+    SourceFileLine position = sources->getSourceLine(getStart().getLineNumber());
     return position.toString();
 }
 
 cstring SourceInfo::toSourcePositionData(unsigned *outLineNumber, unsigned *outColumnNumber) const {
-    SourceFileLine position = sources->getSourceLine(start.getLineNumber());
+    SourceFileLine position = sources->getSourceLine(getStart().getLineNumber());
     if (outLineNumber != nullptr) {
         *outLineNumber = position.sourceLine;
     }
     if (outColumnNumber != nullptr) {
-        *outColumnNumber = start.getColumnNumber();
+        *outColumnNumber = getStart().getColumnNumber();
     }
     return position.fileName;
 }
 
 SourceFileLine SourceInfo::toPosition() const {
-    return sources->getSourceLine(start.getLineNumber());
+    return sources->getSourceLine(getStart().getLineNumber());
 }
 
 cstring SourceInfo::getSourceFile() const {
-    auto sourceLine = sources->getSourceLine(start.getLineNumber());
+    auto sourceLine = sources->getSourceLine(getStart().getLineNumber());
     return sourceLine.fileName;
 }
 
 cstring SourceInfo::getLineNum() const {
-    SourceFileLine sourceLine = sources->getSourceLine(start.getLineNumber());
+    SourceFileLine sourceLine = sources->getSourceLine(getStart().getLineNumber());
     return Util::toString(sourceLine.sourceLine);
 }
 
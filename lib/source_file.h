@@ -21,6 +21,7 @@ limitations under the License.
 #ifndef LIB_SOURCE_FILE_H_
 #define LIB_SOURCE_FILE_H_
 
+#include <cstdint>
 #include <map>
 #include <sstream>
 #include <string_view>
@@ -128,25 +129,24 @@ For a program element, the start is inclusive and the end is
 exclusive (the first position after the language element).
 
 SourceInfo can also be "invalid"
+
+Every IR node has a SourceInfo, which is copied along with it, so it is
+kept small: both positions are packed in a single word, which holds
+nearly all ranges of real programs.  The rest, and the positions read
+by --fromJSON, are kept in a table shared by all the SourceInfos, and
+the word holds their index in it.
 */
 class SourceInfo final {
  public:
-    cstring filename = ""_cs;
-    int line = -1;
-    int column = -1;
-    cstring srcBrief = ""_cs;
-    SourceInfo(cstring filename, int line, int column, cstring srcBrief) {
-        this->filename = filename;
-        this->line = line;
-        this->column = column;
-        this->srcBrief = srcBrief;
-    }
+    /// Creates a SourceInfo for a position read by --fromJSON, without the program source.
+    SourceInfo(cstring filename, int line, int column, cstring srcBrief);
     /// Creates an "invalid" SourceInfo
     SourceInfo() = default;
 
     /// Creates a SourceInfo for a 'point' in the source, or invalid
-    SourceInfo(const InputSources *sources, SourcePosition point)
-        : sources(sources), start(point), end(point) {}
+    SourceInfo(const InputSources *sources, SourcePosition point) : sources(sources) {
+        if (point.isValid()) encode(point, point);
+    }
 
     SourceInfo(const InputSources *sources, SourcePosition start, SourcePosition end);
 
@@ -160,21 +160,25 @@ class SourceInfo final {
     SourceInfo operator+(const SourceInfo &rhs) const {
         if (!this->isValid()) return rhs;
         if (!rhs.isValid()) return *this;
-        SourcePosition s = start.min(rhs.start);
-        SourcePosition e = end.max(rhs.end);
+        SourcePosition s = getStart().min(rhs.getStart());
+        SourcePosition e = getEnd().max(rhs.getEnd());
         return SourceInfo(sources, s, e);
     }
     SourceInfo &operator+=(const SourceInfo &rhs) {
         if (!isValid()) {
             *this = rhs;
         } else if (rhs.isValid()) {
-            start = start.min(rhs.start);
-            end = end.max(rhs.end);
+            encode(getStart().min(rhs.getStart()), getEnd().max(rhs.getEnd()));
         }
         return *this;
     }
 
-    bool operator==(const SourceInfo &rhs) const { return start == rhs.start && end == rhs.end; }
+    bool operator==(const SourceInfo &rhs) const {
+        // Packed ranges are equal only if their words are.
+        if (range == rhs.range) return true;
+        if (!(range & extendedBit) && !(rhs.range & extendedBit)) return false;
+        return getStart() == rhs.getStart() && getEnd() == rhs.getEnd();
+    }
 
     cstring toString() const;
 
@@ -193,15 +197,38 @@ class SourceInfo final {
     cstring toSourcePositionData(unsigned *outLineNumber, unsigned *outColumnNumber) const;
     SourceFileLine toPosition() const;
 
-    bool isValid() const { return this->start.isValid(); }
+    bool isValid() const {
+        if (range & extendedBit) return extended(range).start.isValid();
+        return range != 0;
+    }
     explicit operator bool() const { return isValid(); }
 
     cstring getSourceFile() const;
     cstring getLineNum() const;
 
-    const SourcePosition &getStart() const { return this->start; }
+    SourcePosition getStart() const {
+        if (range & extendedBit) return extended(range).start;
+        if (range == 0) return SourcePosition();
+        return SourcePosition(range >> startLineShift, (range >> startColumnShift) & columnMask);
+    }
+
+    SourcePosition getEnd() const {
+        if (range & extendedBit) return extended(range).end;
+        if (range == 0) return SourcePosition();
+        return SourcePosition((range >> startLineShift) + ((range >> lineSpanShift) & lineSpanMask),
+                              range & columnMask);
+    }
+
+    const InputSources *getSources() const { return this->sources; }
 
-    const SourcePosition &getEnd() const { return this->end; }
+    /// The position read by --fromJSON: the name of the source file, "" if there is none.
+    cstring filename() const;
+    /// The line read by --fromJSON, -1 if there is none.
+    int line() const;
+    /// The column read by --fromJSON, -1 if there is none.
+    int column() const;
+    /// The source fragment read by --fromJSON.
+    cstring srcBrief() const;
 
     /**
        True if this comes 'before' this source position.
@@ -211,7 +238,7 @@ class SourceInfo final {
     bool operator<(const SourceInfo &rhs) const {
         if (!rhs.isValid()) return false;
         if (!isValid()) return true;
-        return this->start < rhs.start;
+        return this->getStart() < rhs.getStart();
     }
     inline bool operator>(const SourceInfo &rhs) const { return rhs.operator<(*this); }
     inline bool operator<=(const SourceInfo &rhs) const { return !this->operator>(rhs); }
@@ -220,9 +247,50 @@ class SourceInfo final {
     friend std::ostream &operator<<(std::ostream &os, const SourceInfo &info);
 
  private:
+    /// Layout of a packed range, from the most significant bit: the flag of extended ranges,
+    /// the start line, the start column, the number of lines to the end and the end column.
+    static constexpr unsigned columnBits = 12;
+    static constexpr unsigned lineSpanBits = 17;
+    static constexpr unsigned startColumnShift = columnBits + lineSpanBits;
+    static constexpr unsigned lineSpanShift = columnBits;
+    static constexpr unsigned startLineShift = startColumnShift + columnBits;
+    static constexpr uint64_t columnMask = (uint64_t(1) << columnBits) - 1;
+    static constexpr uint64_t lineSpanMask = (uint64_t(1) << lineSpanBits) - 1;
+    static constexpr uint64_t extendedBit = uint64_t(1) << 63;
+    static constexpr uint64_t startLineMask = (extendedBit >> startLineShift) - 1;
+
+    /// A range that is not packed.
+    struct Extended {
+        SourcePosition start;
+        SourcePosition end;
+        cstring filename = ""_cs;
+        int line = -1;
+        int column = -1;
+        cstring srcBrief = ""_cs;
+
+        /// True if there is a position read by --fromJSON.
+        bool loaded() const {
+            return line != -1 || column != -1 || !filename.isNullOrEmpty() ||
+                   !srcBrief.isNullOrEmpty();
+        }
+    };
+
+    /// The extended ranges; entries are never removed, as SourceInfos are copied freely and IR
+    /// nodes are not freed either.
+    struct ExtendedTable;
+
+    /// The entry of the extended @p range.  Does not lock.
+    static const Extended &extended(uint64_t range);
+    /// Adds @p extended to the table of extended ranges and @return its range.
+    static uint64_t extend(Extended extended);
+
+    /// Sets the range to the valid positions @p start to @p end, keeping what was read by
+    /// --fromJSON.
+    void encode(SourcePosition start, SourcePosition end);
+
     const InputSources *sources = nullptr;
-    SourcePosition start = SourcePosition();
-    SourcePosition end = SourcePosition();
+    /// The packed positions, an extended range, or 0 if invalid.
+    uint64_t range = 0;
 };
 
 class IHasSourceInfo {
@@ -4,6 +4,9 @@
 #include <chrono>  // NOLINT linter forbids using chrono, but we don't have alternatives
 #include <cstdint>
 #include <memory>
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 #include <unordered_map>
 #include <utility>
 
@@ -41,33 +44,44 @@ struct CounterEntry {
     explicit CounterEntry(const char *n) : name(n) {}
 };
 
+#ifdef MULTITHREAD
+/// The most inner currently active counter of this thread, or null for the topmost counter.
+/// It points into the tree of counters, which is reachable from a static, so it does not
+/// matter that libgc does not scan thread local data.
+thread_local CounterEntry *currentCounter = nullptr;
+#else
+CounterEntry *currentCounter = nullptr;
+#endif  // MULTITHREAD
+
 struct RootCounter {
     /// The topmost counter.
     CounterEntry counter;
-    /// The most inner currently active counter.
-    CounterEntry *current;
     Clock::time_point start;
+#ifdef MULTITHREAD
+    /// Counters are shared by all threads; each thread nests its own timers.
+    std::mutex lock;
+#endif  // MULTITHREAD
 
     static RootCounter &get() {
-        // TODO: not threadsafe currently. Instance of RootCounter could be thread_local:
-        //
-        // thread_local RootCounter root;
-        //
-        // however libgc cannot scan thread local data, which can lead to premature object
-        // garbage collection.
         static RootCounter ROOT;
-        ROOT.counter.duration = Clock::now() - ROOT.start;
         return ROOT;
     }
 
-    CounterEntry *getCurrent() const { return current; }
+    /// The most inner currently active counter of this thread.
+    CounterEntry *getCurrent() { return currentCounter ? currentCounter : &counter; }
 
-    void setCurrent(CounterEntry *c) { current = c; }
+    void setCurrent(CounterEntry *c) { currentCounter = c; }
 
  private:
-    RootCounter() : counter(""), current(&counter) { start = Clock::now(); }
+    RootCounter() : counter("") { start = Clock::now(); }
 };
 
+#ifdef MULTITHREAD
+#define LOCK_COUNTERS(ROOT) std::lock_guard<std::mutex> counters_guard((ROOT).lock)
+#else
+#define LOCK_COUNTERS(ROOT) (void)(ROOT)
+#endif  // MULTITHREAD
+
 }  // namespace
 
 #pragma GCC diagnostic push
@@ -86,8 +100,11 @@ struct ScopedTimerCtx {
     CounterEntry *self = nullptr;
     Clock::time_point startTime;
 
-    explicit ScopedTimerCtx(const char *timerName)
-        : parent(RootCounter::get().getCurrent()), self(parent->openSubcounter(timerName)) {
+    explicit ScopedTimerCtx(const char *timerName) : parent(RootCounter::get().getCurrent()) {
+        {
+            LOCK_COUNTERS(RootCounter::get());
+            self = parent->openSubcounter(timerName);
+        }
         startTime = Clock::now();
         // Push new active counter - the current active counter becomes the parent of this
         // counter, and this counter becomes the current active counter.
@@ -96,7 +113,10 @@ struct ScopedTimerCtx {
     ~ScopedTimerCtx() {
         // Close the current timer invocation, measure time and add it to the counter.
         auto duration = Clock::now() - startTime;
-        self->add(duration);
+        {
+            LOCK_COUNTERS(RootCounter::get());
+            self->add(duration);
+        }
         // Restore previous counter as current.
         RootCounter::get().setCurrent(parent);
     }
@@ -142,7 +162,10 @@ static void formatCounters(std::vector<TimerEntry> &out, CounterEntry &current,
 std::vector<TimerEntry> getTimers() {
     std::vector<TimerEntry> ret;
     std::string namePrefix;
-    formatCounters(ret, RootCounter::get().counter, namePrefix, 0);
+    auto &root = RootCounter::get();
+    LOCK_COUNTERS(root);
+    root.counter.duration = Clock::now() - root.start;
+    formatCounters(ret, root.counter, namePrefix, 0);
     return ret;
 }
 
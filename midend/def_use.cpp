@@ -60,7 +60,10 @@ void ComputeDefUse::flow_merge(Visitor &a_) {
     ComputeDefUse &a = dynamic_cast<ComputeDefUse &>(a_);
     LOG8("ComputeDefUse::flow_merge(" << a.uid << ") -> " << uid);
     unreachable &= a.unreachable;
-    for (auto &di : a.def_info) def_info[di.first].flow_merge(di.second);
+    a.def_info.forEach([this, &a](const IR::IDeclaration *decl, const def_info_t &di) {
+        // Definitions neither flow changed since they split need no merging.
+        if (!def_info.same(a.def_info, decl)) def_info[decl].flow_merge(di);
+    });
 }
 void ComputeDefUse::flow_copy(ControlFlowVisitor &a_) {
     ComputeDefUse &a = dynamic_cast<ComputeDefUse &>(a_);
@@ -73,12 +76,7 @@ bool ComputeDefUse::operator==(const ControlFlowVisitor &a_) const {
     auto &a = dynamic_cast<const ComputeDefUse &>(a_);
     BUG_CHECK(state == a.state, "inconsistent state in ComputeDefUse::==");
     if (unreachable != a.unreachable) return false;
-    if (def_info.size() != a.def_info.size()) return false;
-    for (auto &[decl, di] : def_info) {
-        if (!a.def_info.count(decl)) return false;
-        if (di != a.def_info.at(decl)) return false;
-    }
-    return true;
+    return def_info == a.def_info;
 }
 
 ComputeDefUse::def_info_t::def_info_t(const def_info_t &a)
@@ -128,7 +126,7 @@ ComputeDefUse::def_info_t &ComputeDefUse::def_info_t::operator=(ComputeDefUse::d
     return *this;
 }
 
-void ComputeDefUse::def_info_t::flow_merge(def_info_t &a) {
+void ComputeDefUse::def_info_t::flow_merge(const def_info_t &a) {
     defs.insert(a.defs.begin(), a.defs.end());
     live |= a.live;
     valid_bit_defs.insert(a.valid_bit_defs.begin(), a.valid_bit_defs.end());
@@ -261,6 +259,15 @@ ComputeDefUse::def_info_t::slices_overlap_begin(le_bitrange range) {
     }
     return rv;
 }
+std::map<le_bitrange, ComputeDefUse::def_info_t>::const_iterator
+ComputeDefUse::def_info_t::slices_overlap_begin(le_bitrange range) const {
+    auto rv = slices.lower_bound(range);
+    if (rv != slices.begin()) {
+        auto p = std::prev(rv);
+        if (range.overlaps(p->first)) rv = p;
+    }
+    return rv;
+}
 
 /* erase parts of the slices that overlap the specified range.  So if we have [7:0] and [15:8],
  * erase_slice([11:4]) will leave [3:0] and [15:12]
@@ -424,7 +431,7 @@ bool ComputeDefUse::preorder(const IR::BaseAssignmentStatement *as) {
 
 // Add all definitions in the given def_info_t (whole and partial) as defs that reach
 // a use at the specified location
-void ComputeDefUse::add_uses(const loc_t *loc, def_info_t &di) {
+void ComputeDefUse::add_uses(const loc_t *loc, const def_info_t &di) {
     for (auto *l : di.defs) {
         defuse.uses[l->node].insert(loc);
         defuse.defs[loc->node].insert(l);
@@ -471,7 +478,7 @@ static const IR::Expression *isValid(const IR::Member *m, const Visitor::Context
     return nullptr;
 }
 
-const IR::Expression *ComputeDefUse::do_read(def_info_t &di, const IR::Expression *e,
+const IR::Expression *ComputeDefUse::do_read(const def_info_t &di, const IR::Expression *e,
                                              const Context *ctxt) {
     LOG7("do_read(" << *e << "<" << e->id << ">" << LogAbbrev(e->srcInfo) << ")");
     if (!ctxt) {
@@ -662,7 +669,11 @@ bool ComputeDefUse::preorder(const IR::PathExpression *pe) {
     if (state == SKIPPING) return false;
     auto *d = resolveUnique(pe->path->name, P4::ResolutionType::Any);
     BUG_CHECK(d, "failed to resolve %s", pe);
-    if (isRead() && state != WRITE_ONLY) do_read(def_info[d], pe, getContext());
+    if (isRead() && state != WRITE_ONLY) {
+        // Reads leave the definitions shared with other flows.
+        auto *di = def_info.find(d);
+        do_read(di ? *di : def_info[d], pe, getContext());
+    }
     if (isWrite() && state != READ_ONLY) do_write(def_info[d], pe, getContext());
     return false;
 }
@@ -20,6 +20,7 @@ limitations under the License.
 #include "frontends/common/resolveReferences/resolveReferences.h"
 #include "ir/ir.h"
 #include "lib/bitrange.h"
+#include "lib/cow_map.h"
 #include "lib/hvec_map.h"
 #include "lib/hvec_set.h"
 
@@ -124,9 +125,10 @@ class ComputeDefUse : public Inspector,
         // keys in slices are always non-overlapping (checked by slices_sanity)
         void slices_sanity();
         std::map<le_bitrange, def_info_t>::iterator slices_overlap_begin(le_bitrange);
+        std::map<le_bitrange, def_info_t>::const_iterator slices_overlap_begin(le_bitrange) const;
         void erase_slice(le_bitrange);
         void split_slice(le_bitrange);
-        void flow_merge(def_info_t &);
+        void flow_merge(const def_info_t &);
         bool operator==(const def_info_t &) const;
         bool operator!=(const def_info_t &a) const { return !(*this == a); }
         def_info_t() = default;
@@ -135,8 +137,10 @@ class ComputeDefUse : public Inspector,
         def_info_t &operator=(const def_info_t &);
         def_info_t &operator=(def_info_t &&);
     };
-    hvec_map<const IR::IDeclaration *, def_info_t> def_info;
-    void add_uses(const loc_t *, def_info_t &);
+    // Shared between the clones made at each branch, so that a branch copies only the
+    // definitions it changes.
+    cow_map<const IR::IDeclaration *, def_info_t> def_info;
+    void add_uses(const loc_t *, const def_info_t &);
     void set_live_from_type(def_info_t &di, const IR::Type *type);
 
     // computed defuse info for all uses and defs in the program
@@ -170,7 +174,7 @@ class ComputeDefUse : public Inspector,
     bool preorder(const IR::Vector<IR::Annotation> *) override { return false; }
     bool preorder(const IR::KeyElement *) override;
     bool preorder(const IR::BaseAssignmentStatement *) override;
-    const IR::Expression *do_read(def_info_t &, const IR::Expression *, const Context *);
+    const IR::Expression *do_read(const def_info_t &, const IR::Expression *, const Context *);
     const IR::Expression *do_write(def_info_t &, const IR::Expression *, const Context *);
     bool preorder(const IR::PathExpression *) override;
     void loop_revisit(const IR::PathExpression *) override;
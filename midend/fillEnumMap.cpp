@@ -21,7 +21,7 @@ limitations under the License.
 namespace P4 {
 
 const IR::Node *FillEnumMap::preorder(IR::Type_Enum *type) {
-    if (type->srcInfo.filename.find("v1model") == nullptr) {
+    if (type->srcInfo.filename().find("v1model") == nullptr) {
         unsigned long long count = type->members.size();
         unsigned long long width = policy->enumSize(count);
         auto r = new EnumRepresentation(type->srcInfo, width);
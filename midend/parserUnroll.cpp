@@ -1,5 +1,7 @@
 #include "parserUnroll.h"
 
+#include <algorithm>
+
 #include "interpreter.h"
 #include "ir/ir.h"
 #include "lib/hash.h"
@@ -50,45 +52,52 @@ size_t StackVariableHash::operator()(const StackVariable &var) const {
 
 /// The main class for parsers' states key for visited checking.
 struct VisitedKey {
-    cstring name;              // name of a state.
-    StackVariableMap indexes;  // indexes of header stacks.
+    cstring name;  // name of a state.
+    // indexes of header stacks, sorted by the name of the header stack.
+    std::vector<std::pair<cstring, size_t>> indexes;
 
-    VisitedKey(cstring name, StackVariableMap &indexes) : name(name), indexes(indexes) {}
+    VisitedKey(cstring name, const StackVariableMap &indexes) : name(name) { setIndexes(indexes); }
 
     explicit VisitedKey(const ParserStateInfo *stateInfo) {
         CHECK_NULL(stateInfo);
         name = stateInfo->state->name.name;
-        indexes = stateInfo->statesIndexes;
+        setIndexes(stateInfo->statesIndexes);
     }
 
     /// Checks of two states to be less. If @a name < @a e.name then it returns @a true.
     /// if @a name > @a e.name then it returns false.
-    /// If @a name is equal @a e.name then it checks the values of the headers stack indexes.
-    /// For both map of header stacks' indexes it creates map of pairs of values for each
-    /// header stack index.
-    /// If some indexes are missing then it cosiders them as -1.
-    /// Next, it continues checking each pair in a intermidiate map with the same approach
-    /// as for @a name and @a e.name.
+    /// If @a name is equal @a e.name then it compares the values of the header stack indexes
+    /// in the order of the header stacks, considering missing indexes as -1.
     bool operator<(const VisitedKey &e) const {
         if (name < e.name) return true;
         if (name > e.name) return false;
-        std::unordered_map<StackVariable, std::pair<size_t, size_t>, StackVariableHash> mp;
-        for (auto &i1 : indexes) {
-            mp.emplace(i1.first, std::make_pair(i1.second, -1));
-        }
-        for (auto &i2 : e.indexes) {
-            auto ref = mp.find(i2.first);
-            if (ref == mp.end())
-                mp.emplace(i2.first, std::make_pair(-1, i2.second));
-            else
-                ref->second.second = i2.second;
-        }
-        for (auto j : mp) {
-            if (j.second.first < j.second.second) return true;
-            if (j.second.first > j.second.second) return false;
+        auto i = indexes.begin(), j = e.indexes.begin();
+        while (i != indexes.end() || j != e.indexes.end()) {
+            if (j == e.indexes.end() || (i != indexes.end() && i->first < j->first)) {
+                // only in this key
+                if (i->second != size_t(-1)) return true;
+                ++i;
+            } else if (i == indexes.end() || j->first < i->first) {
+                // only in e
+                if (j->second != size_t(-1)) return false;
+                ++j;
+            } else {
+                if (i->second != j->second) return i->second < j->second;
+                ++i;
+                ++j;
+            }
         }
         return false;
     }
+
+ private:
+    /// Sorting once here saves building a map of both keys for each comparison
+    /// in the maps of visited states.
+    void setIndexes(const StackVariableMap &map) {
+        indexes.reserve(map.size());
+        for (const auto &[variable, index] : map) indexes.emplace_back(variable.name(), index);
+        std::sort(indexes.begin(), indexes.end());
+    }
 };
 
 /**
@@ -363,6 +372,7 @@ class ParserSymbolicInterpreter {
     bool unroll;
     StatesVisitedMap visitedStates;
     bool &wasError;
+    size_t budget;  // states evaluated before giving up, or 0 for no limit
 
     ValueMap *initializeVariables() {
         wasError = false;
@@ -766,13 +776,14 @@ class ParserSymbolicInterpreter {
     bool hasOutOfboundState;
     /// constructor
     ParserSymbolicInterpreter(ParserStructure *structure, ReferenceMap *refMap, TypeMap *typeMap,
-                              bool unroll, bool &wasError)
+                              bool unroll, bool &wasError, size_t budget)
         : structure(structure),
           refMap(refMap),
           typeMap(typeMap),
           synthesizedParser(nullptr),
           unroll(unroll),
-          wasError(wasError) {
+          wasError(wasError),
+          budget(budget) {
         CHECK_NULL(structure);
         CHECK_NULL(refMap);
         CHECK_NULL(typeMap);
@@ -811,20 +822,28 @@ class ParserSymbolicInterpreter {
         toRun.push_back(startInfo);
         std::set<VisitedKey> visited;
         std::unordered_set<cstring> newStates;
+        size_t evaluated = 0;
         while (!toRun.empty()) {
             auto stateInfo = toRun.back();
             toRun.pop_back();
             LOG1("Symbolic evaluation of " << stateChain(stateInfo));
             // checking visited state, loop state, and the reachable states with needed header stack
             // operators.
-            if (visited.count(VisitedKey(stateInfo)) &&
-                !stateInfo->scenarioStates.count(stateInfo->name) &&
+            VisitedKey key(stateInfo);
+            if (visited.count(key) && !stateInfo->scenarioStates.count(stateInfo->name) &&
                 !structure->reachableHSUsage(stateInfo->state->name, stateInfo))
                 continue;
+            if (budget != 0 && ++evaluated > budget) {
+                ::P4::warning(ErrorType::WARN_INVALID,
+                              "%1%: parser can't be unrolled within %2% states, leaving it as is",
+                              parser, budget);
+                wasError = true;
+                return synthesizedParser;
+            }
             auto iHSNames = structure->statesWithHeaderStacks.find(stateInfo->name);
             if (iHSNames != structure->statesWithHeaderStacks.end())
                 stateInfo->scenarioHS.insert(iHSNames->second.begin(), iHSNames->second.end());
-            visited.insert(VisitedKey(stateInfo));              // add to visited map
+            visited.insert(key);                                // add to visited map
             stateInfo->scenarioStates.insert(stateInfo->name);  // add to loops detection
             bool infLoop = checkLoops(stateInfo);
             if (infLoop) {
@@ -868,8 +887,10 @@ class ParserSymbolicInterpreter {
 
 }  // namespace ParserStructureImpl
 
-bool ParserStructure::analyze(ReferenceMap *refMap, TypeMap *typeMap, bool unroll, bool &wasError) {
-    ParserStructureImpl::ParserSymbolicInterpreter psi(this, refMap, typeMap, unroll, wasError);
+bool ParserStructure::analyze(ReferenceMap *refMap, TypeMap *typeMap, bool unroll, bool &wasError,
+                              size_t budget) {
+    ParserStructureImpl::ParserSymbolicInterpreter psi(this, refMap, typeMap, unroll, wasError,
+                                                       budget);
     result = psi.run();
     return psi.hasOutOfboundState;
 }
@@ -877,22 +898,25 @@ bool ParserStructure::analyze(ReferenceMap *refMap, TypeMap *typeMap, bool unrol
 /// check reachability for usage of header stack
 bool ParserStructure::reachableHSUsage(IR::ID id, const ParserStateInfo *state) const {
     if (!state->scenarioHS.size()) return false;
-    CHECK_NULL(callGraph);
-    const IR::IDeclaration *declaration = parser->states.getDeclaration(id.name);
-    BUG_CHECK(declaration && declaration->is<IR::ParserState>(), "Invalid declaration %1%", id);
-    std::set<const IR::ParserState *> reachableStates;
-    callGraph->reachable(declaration->to<IR::ParserState>(), reachableStates);
-    std::set<cstring> reachebleHSoperators;
-    for (auto i : reachableStates) {
-        auto iHSNames = statesWithHeaderStacks.find(i->name);
-        if (iHSNames != statesWithHeaderStacks.end())
-            reachebleHSoperators.insert(iHSNames->second.begin(), iHSNames->second.end());
-    }
-    std::set<cstring> intersectionHSOperators;
-    std::set_intersection(state->scenarioHS.begin(), state->scenarioHS.end(),
-                          reachebleHSoperators.begin(), reachebleHSoperators.end(),
-                          std::inserter(intersectionHSOperators, intersectionHSOperators.begin()));
-    return intersectionHSOperators.size() > 0;
+    auto [it, inserted] = reachableHS.try_emplace(id.name);
+    auto &reachebleHSoperators = it->second;
+    if (inserted) {
+        CHECK_NULL(callGraph);
+        const IR::IDeclaration *declaration = parser->states.getDeclaration(id.name);
+        BUG_CHECK(declaration && declaration->is<IR::ParserState>(), "Invalid declaration %1%",
+                  id);
+        std::set<const IR::ParserState *> reachableStates;
+        callGraph->reachable(declaration->to<IR::ParserState>(), reachableStates);
+        for (auto i : reachableStates) {
+            auto iHSNames = statesWithHeaderStacks.find(i->name);
+            if (iHSNames != statesWithHeaderStacks.end())
+                reachebleHSoperators.insert(iHSNames->second.begin(), iHSNames->second.end());
+        }
+    }
+    // scenarioHS is not sorted, so it can't be intersected with std::set_intersection.
+    for (auto hs : state->scenarioHS)
+        if (reachebleHSoperators.count(hs)) return true;
+    return false;
 }
 
 void ParserStructure::addStateHSUsage(const IR::ParserState *state,
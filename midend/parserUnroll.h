@@ -32,6 +32,11 @@ namespace P4 {
 /// Name of out of bound state
 const char outOfBoundsStateName[] = "stateOutOfBound";
 
+/// Default number of states ParsersUnroll evaluates symbolically for one parser before
+/// giving up and leaving the parser as is.  0 means no limit; compilers take the limit
+/// from --parser-unroll-budget.
+const size_t defaultParserUnrollBudget = 0;
+
 //////////////////////////////////////////////
 // The following are for a single parser
 
@@ -52,6 +57,9 @@ class StackVariable {
     // Implements comparisons so that StateVariables can be used as map keys.
     bool operator==(const StackVariable &other) const;
 
+    /// The variable as written, the same for equal variables.
+    cstring name() const { return variable->toString(); }
+
  private:
     const IR::Expression *variable;
 
@@ -154,6 +162,7 @@ class ParserStructure {
         callGraph = new StateCallGraph(parser->name.name);
         this->parser = parser;
         start = nullptr;
+        reachableHS.clear();
     }
     void addState(const IR::ParserState *state) { stateMap.emplace(state->name, state); }
     const IR::ParserState *get(cstring state) const { return ::P4::get(stateMap, state); }
@@ -161,11 +170,18 @@ class ParserStructure {
         callGraph->calls(caller, callee);
     }
 
-    bool analyze(ReferenceMap *refMap, TypeMap *typeMap, bool unroll, bool &wasError);
+    /// Evaluates at most @p budget states, unless it is 0, and sets @p wasError if that
+    /// is not enough to unroll the parser.
+    bool analyze(ReferenceMap *refMap, TypeMap *typeMap, bool unroll, bool &wasError,
+                 size_t budget = defaultParserUnrollBudget);
     /// check reachability for usage of header stack
     bool reachableHSUsage(IR::ID id, const ParserStateInfo *state) const;
 
  protected:
+    /// Header stacks used in the states reachable from each state, computed on demand.
+    /// The worklist asks again for every path that reaches a state.
+    mutable std::map<cstring, std::set<cstring>> reachableHS;
+
     /// evaluates rechable states with HS operations for each path.
     void evaluateReachability();
     /// add HS name which is used in a current state.
@@ -206,15 +222,16 @@ class ParserRewriter : public PassManager {
  public:
     bool hasOutOfboundState;
     bool wasError;
-    ParserRewriter(ReferenceMap *refMap, TypeMap *typeMap, bool unroll) {
+    ParserRewriter(ReferenceMap *refMap, TypeMap *typeMap, bool unroll,
+                   size_t budget = defaultParserUnrollBudget) {
         CHECK_NULL(refMap);
         CHECK_NULL(typeMap);
         wasError = false;
         setName("ParserRewriter");
         addPasses({
             new AnalyzeParser(refMap, &current),
-            [this, refMap, typeMap, unroll](void) {
-                hasOutOfboundState = current.analyze(refMap, typeMap, unroll, wasError);
+            [this, refMap, typeMap, unroll, budget](void) {
+                hasOutOfboundState = current.analyze(refMap, typeMap, unroll, wasError, budget);
             },
         });
     }
@@ -227,10 +244,12 @@ class RewriteAllParsers : public Transform {
     ReferenceMap *refMap;
     TypeMap *typeMap;
     bool unroll;
+    size_t budget;
 
  public:
-    RewriteAllParsers(ReferenceMap *refMap, TypeMap *typeMap, bool unroll)
-        : refMap(refMap), typeMap(typeMap), unroll(unroll) {
+    RewriteAllParsers(ReferenceMap *refMap, TypeMap *typeMap, bool unroll,
+                      size_t budget = defaultParserUnrollBudget)
+        : refMap(refMap), typeMap(typeMap), unroll(unroll), budget(budget) {
         CHECK_NULL(refMap);
         CHECK_NULL(typeMap);
         setName("RewriteAllParsers");
@@ -239,7 +258,7 @@ class RewriteAllParsers : public Transform {
     // start generation of a code
     const IR::Node *postorder(IR::P4Parser *parser) override {
         // making rewriting
-        auto rewriter = new ParserRewriter(refMap, typeMap, unroll);
+        auto rewriter = new ParserRewriter(refMap, typeMap, unroll, budget);
         rewriter->setCalledBy(this);
         parser->apply(*rewriter);
         if (rewriter->wasError) {
@@ -294,13 +313,16 @@ class RewriteAllParsers : public Transform {
     }
 };
 
+/// Unrolls the loops of parsers.  A parser that needs more than @p budget states to be
+/// evaluated symbolically is left unchanged, with a warning.
 class ParsersUnroll : public PassManager {
  public:
-    ParsersUnroll(bool unroll, ReferenceMap *refMap, TypeMap *typeMap) {
+    ParsersUnroll(bool unroll, ReferenceMap *refMap, TypeMap *typeMap,
+                  size_t budget = defaultParserUnrollBudget) {
         // remove block statements
         passes.push_back(new SimplifyControlFlow(typeMap, false));
         passes.push_back(new TypeChecking(refMap, typeMap));
-        passes.push_back(new RewriteAllParsers(refMap, typeMap, unroll));
+        passes.push_back(new RewriteAllParsers(refMap, typeMap, unroll, budget));
         setName("ParsersUnroll");
     }
 };
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#include "ir/binary_reader.h"
+#include "ir/binary_writer.h"
+#include "ir/ir.h"
+#include "ir/json_generator.h"
+#include "ir/json_loader.h"
+
+namespace P4::Test {
+
+using namespace P4::literals;
+
+namespace {
+
+/// A program with @p size constants and @p size actions of @p size statements each, in the
+/// shape the frontend produces: many small nodes that share their types.
+const IR::P4Program *makeProgram(int size) {
+    IR::Vector<IR::Node> objects;
+    const auto *type = IR::Type_Bits::get(32);
+    for (int i = 0; i < size; ++i) {
+        auto name = IR::ID("c" + std::to_string(i));
+        const IR::Expression *value = new IR::Constant(type, i);
+        if (i > 0) {
+            auto *previous = new IR::Path(IR::ID("c" + std::to_string(i - 1)));
+            value = new IR::Add(type, value, new IR::PathExpression(type, previous));
+        }
+        objects.push_back(new IR::Declaration_Constant(name, type, value));
+    }
+    for (int i = 0; i < size; ++i) {
+        IR::IndexedVector<IR::StatOrDecl> body;
+        for (int j = 0; j < size; ++j) {
+            auto *path = new IR::Path(IR::ID("c" + std::to_string(j)));
+            auto *left = new IR::PathExpression(type, path);
+            auto *right = new IR::Mul(type, left, new IR::Constant(type, i + j));
+            body.push_back(new IR::AssignmentStatement(left, right));
+        }
+        objects.push_back(new IR::P4Action(IR::ID("a" + std::to_string(i)),
+                                           new IR::ParameterList(),
+                                           new IR::BlockStatement(std::move(body))));
+    }
+    return new IR::P4Program(std::move(objects));
+}
+
+std::string toJSON(const IR::Node *node) {
+    std::stringstream json;
+    JSONGenerator(json).emit(node);
+    return json.str();
+}
+
+std::string toBinary(const IR::Node *node) {
+    std::stringstream binary;
+    BinaryWriter(binary).emit(node);
+    return binary.str();
+}
+
+}  // namespace
+
+TEST(BinaryIR, RoundTrip) {
+    const auto *program = makeProgram(10);
+    std::stringstream binary(toBinary(program));
+    BinaryReader reader(binary);
+    const IR::Node *copy = nullptr;
+    reader >> copy;
+    ASSERT_TRUE(reader);
+    ASSERT_NE(copy, nullptr);
+    ASSERT_TRUE(copy->is<IR::P4Program>());
+    EXPECT_EQ(toJSON(program), toJSON(copy));
+    EXPECT_TRUE(program->equiv(*copy));
+}
+
+TEST(BinaryIR, Values) {
+    auto *constant = new IR::Constant(IR::Type_Bits::get(128, true), -(big_int(1) << 100), 16);
+    auto *str = new IR::StringLiteral("with \"quotes\""_cs);
+    auto *list = new IR::Vector<IR::Expression>();
+    list->push_back(constant);
+    list->push_back(str);
+    list->push_back(constant);
+
+    std::stringstream binary(toBinary(list));
+    BinaryReader reader(binary);
+    const IR::Node *node = nullptr;
+    reader >> node;
+    ASSERT_TRUE(reader);
+    const auto *copy = node->to<IR::Vector<IR::Expression>>();
+    ASSERT_NE(copy, nullptr);
+    ASSERT_EQ(copy->size(), 3u);
+    EXPECT_TRUE(copy->at(0)->equiv(*constant));
+    EXPECT_EQ(copy->at(0)->to<IR::Constant>()->base, 16u);
+    EXPECT_TRUE(copy->at(1)->equiv(*str));
+    // Shared nodes stay shared.
+    EXPECT_EQ(copy->at(0), copy->at(2));
+    EXPECT_EQ(copy->at(0)->id, constant->id);
+}
+
+TEST(BinaryIR, Stream) {
+    auto *a = new IR::Constant(1);
+    auto *b = new IR::Neg(a);
+    std::stringstream binary;
+    {
+        BinaryWriter writer(binary, true);
+        writer.emit(a);
+        writer.emit(b);
+        writer.emit(nullptr);
+    }
+    BinaryReader reader(binary);
+    const IR::Node *first = nullptr, *second = nullptr, *third = nullptr, *end = nullptr;
+    reader >> first >> second >> third >> end;
+    ASSERT_TRUE(reader);
+    ASSERT_NE(second, nullptr);
+    // Later roots refer back to the nodes of earlier ones.
+    EXPECT_EQ(second->to<IR::Neg>()->expr, first);
+    EXPECT_EQ(third, nullptr);
+    EXPECT_EQ(end, nullptr);
+}
+
+TEST(BinaryIR, Malformed) {
+    std::string binary = toBinary(makeProgram(3));
+
+    std::stringstream json("{}");
+    EXPECT_FALSE(BinaryReader(json));
+
+    for (size_t size : {binary.size() / 3, binary.size() - 1}) {
+        std::stringstream truncated(binary.substr(0, size));
+        BinaryReader reader(truncated);
+        const IR::Node *node = nullptr;
+        reader >> node;
+        EXPECT_FALSE(reader);
+        EXPECT_EQ(node, nullptr);
+    }
+
+    std::string corrupted = binary;
+    for (size_t i = 8; i < corrupted.size(); i += 7) corrupted[i] = '\xff';
+    std::stringstream stream(corrupted);
+    BinaryReader reader(stream);
+    const IR::Node *node = nullptr;
+    reader >> node;
+    EXPECT_FALSE(reader);
+}
+
+TEST(BinaryIR, Positions) {
+    Util::InputSources sources;
+    for (const char *line : {"// moved", "const bit<8> a = 1;", "const bit<8> b = a;"}) {
+        sources.appendText(line);
+        sources.appendText("\n");
+    }
+    auto *a = new IR::Constant(Util::SourceInfo(&sources, Util::SourcePosition(2, 17),
+                                                Util::SourcePosition(2, 18)),
+                               IR::Type_Bits::get(8), 1);
+    auto *b = new IR::Neg(Util::SourceInfo(&sources, Util::SourcePosition(3, 17),
+                                           Util::SourcePosition(3, 18)),
+                          a);
+    auto *unplaced = new IR::Neg(b);
+
+    std::stringstream binary;
+    BinaryWriter(binary, false, true).emit(unplaced);
+    BinaryReader reader(binary);
+    ASSERT_TRUE(reader.hasPositions());
+    // Everything moved down a line, except what was on line 3, which is gone.
+    reader.setSources(&sources, [](unsigned line) { return line == 3 ? 0 : line + 1; });
+    const IR::Node *node = nullptr;
+    reader >> node;
+    ASSERT_TRUE(reader);
+    ASSERT_NE(node, nullptr);
+    EXPECT_FALSE(node->srcInfo.isValid());
+    const auto *neg = node->to<IR::Neg>()->expr;
+    EXPECT_FALSE(neg->srcInfo.isValid());
+    const auto *constant = neg->to<IR::Neg>()->expr;
+    ASSERT_TRUE(constant->srcInfo.isValid());
+    EXPECT_EQ(constant->srcInfo.getSources(), &sources);
+    EXPECT_EQ(constant->srcInfo.getStart(), Util::SourcePosition(3, 17));
+    EXPECT_EQ(constant->srcInfo.getEnd(), Util::SourcePosition(3, 18));
+}
+
+/// Prints the size, write time and load time of a program of 100 constants in the JSON and the
+/// binary format.
+TEST(BinaryIR, DISABLED_Benchmark) {
+    const auto *program = makeProgram(100);
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+    };
+
+    auto start = Clock::now();
+    std::string json = toJSON(program);
+    auto jsonWrite = Clock::now() - start;
+    start = Clock::now();
+    std::string binary = toBinary(program);
+    auto binaryWrite = Clock::now() - start;
+
+    const IR::Node *fromJSON = nullptr, *fromBinary = nullptr;
+    start = Clock::now();
+    {
+        std::stringstream in(json);
+        JSONLoader(in) >> fromJSON;
+    }
+    auto jsonLoad = Clock::now() - start;
+    start = Clock::now();
+    {
+        std::stringstream in(binary);
+        BinaryReader(in) >> fromBinary;
+    }
+    auto binaryLoad = Clock::now() - start;
+
+    ASSERT_NE(fromJSON, nullptr);
+    ASSERT_NE(fromBinary, nullptr);
+    EXPECT_TRUE(fromJSON->equiv(*fromBinary));
+    EXPECT_LT(binary.size(), json.size());
+
+    std::cout << "JSON:   " << json.size() << " bytes, write " << ms(jsonWrite) << " ms, load "
+              << ms(jsonLoad) << " ms\n"
+              << "binary: " << binary.size() << " bytes, write " << ms(binaryWrite)
+              << " ms, load " << ms(binaryLoad) << " ms" << std::endl;
+}
+
+}  // namespace P4::Test
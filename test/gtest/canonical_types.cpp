@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "frontends/p4/typeChecking/typeChecker.h"
+#include "frontends/p4/typeMap.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+namespace P4::Test {
+
+namespace {
+
+const IR::Type_Tuple *makeTuple(int width, bool withBool) {
+    IR::Vector<IR::Type> components;
+    components.push_back(IR::Type_Bits::get(width));
+    if (withBool) components.push_back(IR::Type_Boolean::get());
+    return new IR::Type_Tuple(components);
+}
+
+/// Checks that the types of all boolean expressions are the same node.
+class BooleanTypes : public Inspector {
+    const TypeMap &typeMap;
+
+ public:
+    unsigned checked = 0;
+    explicit BooleanTypes(const TypeMap &typeMap) : typeMap(typeMap) {}
+    void postorder(const IR::Expression *expression) override {
+        auto *type = typeMap.getType(expression);
+        if (type == nullptr || !type->is<IR::Type_Boolean>()) return;
+        ++checked;
+        EXPECT_EQ(type, IR::Type_Boolean::get()) << dbp(expression);
+    }
+};
+
+}  // namespace
+
+class CanonicalTypes : public P4CTest {};
+
+TEST_F(CanonicalTypes, BaseTypesAreInterned) {
+    EXPECT_EQ(IR::Type_Varbits::get(16), IR::Type_Varbits::get(16));
+    EXPECT_NE(IR::Type_Varbits::get(16), IR::Type_Varbits::get(32));
+    EXPECT_EQ(IR::Type_Varbits::get(), IR::Type_Varbits::get(0));
+
+    auto test = FrontendTestCase::create(P4_SOURCE(P4Headers::NONE, R"(
+        header H { bit<8> f; bool b; }
+        control c(inout H h, in bool x);
+        package Top(c a);
+        control first(inout H h, in bool x) {
+            apply { if (h.b && x) { h.f = 1; } h.b = !h.b || x; }
+        }
+        Top(first()) main;
+    )"));
+    ASSERT_TRUE(test);
+    TypeMap typeMap;
+    test->program->apply(TypeChecking(nullptr, &typeMap));
+    BooleanTypes booleans(typeMap);
+    test->program->apply(booleans);
+    EXPECT_GT(booleans.checked, 0u);
+}
+
+TEST_F(CanonicalTypes, EquivalentTuplesAreTheSameNode) {
+    TypeMap typeMap;
+    auto *tuple = typeMap.getCanonical(makeTuple(8, true));
+    EXPECT_EQ(typeMap.getCanonical(makeTuple(8, true)), tuple);
+    EXPECT_NE(typeMap.getCanonical(makeTuple(8, false)), tuple);
+    EXPECT_NE(typeMap.getCanonical(makeTuple(16, true)), tuple);
+    auto *stack = typeMap.getCanonical(new IR::Type_Stack(makeTuple(8, true), new IR::Constant(4)));
+    EXPECT_EQ(typeMap.getCanonical(new IR::Type_Stack(tuple, new IR::Constant(4))), stack);
+    EXPECT_NE(typeMap.getCanonical(new IR::Type_Stack(tuple, new IR::Constant(2))), stack);
+}
+
+/// Times the canonicalization of 2000 distinct tuples, each of which is looked up twice.
+TEST_F(CanonicalTypes, DISABLED_ManyTuples) {
+    TypeMap typeMap;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 2; ++repeat)
+        for (int width = 1; width <= 2000; ++width) typeMap.getCanonical(makeTuple(width, true));
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "[CanonicalTypes] 4000 tuples: " << elapsed.count() << " ms" << std::endl;
+}
+
+}  // namespace P4::Test
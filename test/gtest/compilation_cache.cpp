@@ -0,0 +1,172 @@
+#include "frontends/common/compilationCache.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "helpers.h"
+#include "lib/error.h"
+
+namespace P4::Test {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readFile(const fs::path &path) {
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+void writeFile(const fs::path &path, std::string_view contents) {
+    std::ofstream out(path, std::ios::trunc);
+    out << contents;
+}
+
+class CompilationCacheTest : public P4CTest {
+ protected:
+    fs::path dir;
+    fs::path output;
+    CompilerOptions &options = GTestContext::get().options();
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("p4c-cache-test-" + std::to_string(getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        output = dir / "out.json";
+        options.file = dir / "program.p4";
+        writeFile(options.file, "control c();\n");
+        options.cacheDirectory = dir / "cache";
+        options.commandLine = {"-o", output.string(), options.file.string()};
+    }
+
+    void TearDown() override { fs::remove_all(dir); }
+
+    /// Compiles, standing in for the backend with a write of @contents on a miss.
+    bool compile(std::string_view contents) {
+        options.preprocessedSource.reset();
+        CompilationCache cache(options, {output});
+        EXPECT_TRUE(cache.isActive());
+        if (cache.restore()) return true;
+        EXPECT_TRUE(options.preprocessedSource.has_value());
+        writeFile(output, contents);
+        cache.store();
+        return false;
+    }
+};
+
+}  // namespace
+
+TEST(CompilationCacheKey, Stable) {
+    std::vector<std::string> arguments = {"--target", "bmv2", "prog.p4"};
+    auto key = CompilationCache::key("control c();", arguments, "p4c 1.0");
+    EXPECT_EQ(key.size(), 64u);
+    EXPECT_EQ(key, CompilationCache::key("control c();", arguments, "p4c 1.0"));
+}
+
+TEST(CompilationCacheKey, DependsOnInputs) {
+    std::vector<std::string> arguments = {"--target", "bmv2", "prog.p4"};
+    auto key = CompilationCache::key("control c();", arguments, "p4c 1.0");
+    EXPECT_NE(key, CompilationCache::key("control d();", arguments, "p4c 1.0"));
+    EXPECT_NE(key, CompilationCache::key("control c();", arguments, "p4c 1.1"));
+    EXPECT_NE(key, CompilationCache::key("control c();", {"--target", "bmv2"}, "p4c 1.0"));
+    // Arguments are delimited, so moving text between them changes the key.
+    EXPECT_NE(key,
+              CompilationCache::key("control c();", {"--targetbmv2", "", "prog.p4"}, "p4c 1.0"));
+}
+
+TEST_F(CompilationCacheTest, KeyArguments) {
+    auto canonicalDir = fs::canonical(dir).string();
+    auto absolute = fs::canonical(options.file).string();
+    options.commandLine = {"-o",
+                           "a.json",
+                           "--p4runtime-files=a.txt",
+                           "-I",
+                           (dir / "." / "").string(),
+                           "--Wdisable",
+                           options.file.string()};
+    std::vector<std::string> expected = {"--p4runtime-files=.txt", "-I", canonicalDir,
+                                         "--Wdisable", absolute};
+    EXPECT_EQ(CompilationCache::keyArguments(options), expected);
+
+    // The P4Runtime files are written in the format their extensions name.
+    options.commandLine = {"--p4runtime-files", "a.json,b.txt", "--p4runtime-file=p4info.bin",
+                           options.file.string()};
+    expected = {"--p4runtime-files", ".json,.txt", "--p4runtime-file=.bin", absolute};
+    EXPECT_EQ(CompilationCache::keyArguments(options), expected);
+
+    // Only the name of the program changes; it is the same file.
+    auto cwd = fs::current_path();
+    fs::current_path(dir);
+    options.file = "./program.p4";
+    options.commandLine = {"-ob.json", "-I" + dir.string(), "--Wdisable", "./program.p4"};
+    expected = {"-I" + canonicalDir, "--Wdisable", absolute};
+    EXPECT_EQ(CompilationCache::keyArguments(options), expected);
+    fs::current_path(cwd);
+}
+
+TEST_F(CompilationCacheTest, RestoresOutputs) {
+    EXPECT_FALSE(compile("compiled"));
+    fs::remove(output);
+    EXPECT_TRUE(compile("not compiled"));
+    EXPECT_EQ(readFile(output), "compiled");
+    EXPECT_EQ(::P4::errorCount(), 0u);
+
+    CompilationCache cache(options, {output});
+    EXPECT_EQ(cache.statistics().hits, 1u);
+    EXPECT_EQ(cache.statistics().misses, 1u);
+}
+
+TEST_F(CompilationCacheTest, MissesOnChanges) {
+    EXPECT_FALSE(compile("first"));
+    writeFile(options.file, "control d();\n");
+    EXPECT_FALSE(compile("second"));
+    options.commandLine.insert(options.commandLine.begin(), "--Wdisable");
+    EXPECT_FALSE(compile("third"));
+    // Options of the cache itself are not part of the key.
+    options.commandLine.insert(options.commandLine.begin(), {"--cache-stats", "--cache-dir", "x"});
+    EXPECT_TRUE(compile("fourth"));
+    EXPECT_EQ(readFile(output), "third");
+}
+
+TEST_F(CompilationCacheTest, MissesWithoutAllOutputs) {
+    {
+        options.preprocessedSource.reset();
+        CompilationCache cache(options, {output});
+        EXPECT_FALSE(cache.restore());
+        // The compilation writes no output.
+        cache.store();
+    }
+    EXPECT_FALSE(compile("compiled"));
+    EXPECT_EQ(readFile(output), "compiled");
+}
+
+TEST_F(CompilationCacheTest, ChecksStoredInputs) {
+    EXPECT_FALSE(compile("compiled"));
+    // An entry under the same key stored for other inputs, as a collision would be.
+    for (const auto &entry : fs::directory_iterator(options.cacheDirectory)) {
+        if (entry.is_directory()) writeFile(entry.path() / "inputs", "other inputs");
+    }
+    EXPECT_FALSE(compile("recompiled"));
+    EXPECT_EQ(readFile(output), "recompiled");
+}
+
+TEST_F(CompilationCacheTest, Evicts) {
+    options.cacheMaxSize = 0;
+    EXPECT_FALSE(compile("compiled"));
+    EXPECT_FALSE(compile("compiled"));
+}
+
+TEST_F(CompilationCacheTest, InactiveWithDebugOutput) {
+    options.top4 = {cstring("FrontEnd")};
+    CompilationCache cache(options, {output});
+    EXPECT_FALSE(cache.isActive());
+    EXPECT_FALSE(cache.restore());
+}
+
+}  // namespace P4::Test
@@ -0,0 +1,150 @@
+#include "lib/cow_map.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace P4::Test {
+
+namespace {
+
+/// A value that counts its copies.
+struct Counted {
+    static size_t copies;
+    std::vector<int> data;
+
+    Counted() = default;
+    Counted(const Counted &other) : data(other.data) { ++copies; }
+    Counted &operator=(const Counted &other) {
+        data = other.data;
+        ++copies;
+        return *this;
+    }
+    bool operator==(const Counted &other) const { return data == other.data; }
+};
+
+size_t Counted::copies = 0;
+
+}  // namespace
+
+TEST(cow_map, CopiesShareEntries) {
+    cow_map<int, Counted> a;
+    a[1].data = {1};
+    a[2].data = {2};
+    Counted::copies = 0;
+
+    auto b = a;
+    EXPECT_TRUE(a.same(b, 1));
+    EXPECT_TRUE(a == b);
+    EXPECT_EQ(Counted::copies, 0u);
+
+    b[2].data.push_back(3);
+    EXPECT_EQ(Counted::copies, 1u);
+    EXPECT_TRUE(a.same(b, 1));
+    EXPECT_FALSE(a.same(b, 2));
+    EXPECT_EQ(a.find(2)->data, std::vector<int>{2});
+    EXPECT_EQ(b.find(2)->data, (std::vector<int>{2, 3}));
+    EXPECT_FALSE(a == b);
+
+    // A value no longer shared is changed in place.
+    b[2].data.push_back(4);
+    b[3].data = {3};
+    EXPECT_EQ(Counted::copies, 1u);
+    EXPECT_EQ(a.size(), 2u);
+    EXPECT_EQ(b.size(), 3u);
+    EXPECT_EQ(a.count(3), 0u);
+
+    EXPECT_EQ(b.erase(1), 1u);
+    EXPECT_EQ(a.count(1), 1u);
+    EXPECT_FALSE(a.same(b, 1));
+}
+
+TEST(cow_map, CopyingGivesUpOwnership) {
+    cow_map<int, Counted> a;
+    a[1].data = {1};
+    Counted::copies = 0;
+
+    // The map copied from no longer changes in place what it shares with the copy, whether or
+    // not the copy is still alive.
+    {
+        auto b = a;
+        a[1].data.push_back(2);
+        EXPECT_EQ(Counted::copies, 1u);
+        EXPECT_EQ(b.find(1)->data, std::vector<int>{1});
+    }
+    a[1].data.push_back(3);
+    EXPECT_EQ(Counted::copies, 1u);
+
+    // A moved map keeps changing in place what it created.
+    auto c = std::move(a);
+    c[1].data.push_back(4);
+    EXPECT_EQ(Counted::copies, 1u);
+    EXPECT_EQ(c.find(1)->data, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(cow_map, Equality) {
+    cow_map<int, Counted> a, b;
+    EXPECT_TRUE(a == b);
+    b[1];
+    b.erase(1);
+    EXPECT_TRUE(a == b);
+    a[1].data = {1};
+    b[1].data = {1};
+    EXPECT_TRUE(a == b);
+    EXPECT_FALSE(a.same(b, 1));
+    b[2];
+    EXPECT_TRUE(a != b);
+}
+
+TEST(cow_map, IteratesInInsertionOrder) {
+    cow_map<int, Counted> a;
+    for (int key : {3, 1, 2}) a[key].data = {key};
+    std::vector<int> keys;
+    a.forEach([&](int key, const Counted &value) {
+        EXPECT_EQ(value.data, std::vector<int>{key});
+        keys.push_back(key);
+    });
+    EXPECT_EQ(keys, (std::vector<int>{3, 1, 2}));
+}
+
+/// A flow-sensitive state cloned for branches that change one entry each, and merged back,
+/// copies two values per branch with a cow_map, the one the branch changes and the one it is
+/// merged into, and every value with a full copy of the map.
+TEST(cow_map, BranchCopies) {
+    constexpr int entries = 100, branches = 100;
+    cow_map<int, Counted> state;
+    hvec_map<int, Counted> flat;
+    for (int i = 0; i < entries; ++i) {
+        state[i].data.assign(8, i);
+        flat[i].data.assign(8, i);
+    }
+
+    Counted::copies = 0;
+    for (int i = 0; i < branches; ++i) {
+        auto branch = state;
+        branch[i % entries].data.push_back(i);
+        branch.forEach([&](int key, const Counted &value) {
+            if (state.same(branch, key)) return;
+            auto &merged = state[key].data;
+            merged.insert(merged.end(), value.data.begin(), value.data.end());
+        });
+    }
+    size_t shared = Counted::copies;
+
+    Counted::copies = 0;
+    for (int i = 0; i < branches; ++i) {
+        auto branch = flat;
+        branch[i % entries].data.push_back(i);
+        for (auto &[key, value] : branch) {
+            auto &merged = flat[key].data;
+            if (merged != value.data)
+                merged.insert(merged.end(), value.data.begin(), value.data.end());
+        }
+    }
+    size_t copied = Counted::copies;
+    EXPECT_EQ(shared, size_t(2 * branches));
+    EXPECT_LT(shared, copied);
+}
+
+}  // namespace P4::Test
@@ -98,3 +98,75 @@ TEST(JSON, variant) {
         EXPECT_EQ(data[i], copy[i]);
     }
 }
+
+TEST(JSON, out_of_order) {
+    // Members are normally read in the order they are written; any other order also works.
+    std::stringstream ss(R"({
+        "expr" : { "base" : 16, "value" : 3, "type" : { "Node_ID" : 100 },
+                   "Node_Type" : "Constant", "Node_ID" : 101, "unknown" : [ 1, { "x" : [] } ] },
+        "Node_Type" : "Neg",
+        "type" : { "Node_ID" : 100, "Node_Type" : "Type_InfInt", "declid" : 0 },
+        "Node_ID" : 102
+    })");
+    const IR::Node *node = nullptr;
+    JSONLoader(ss) >> node;
+
+    const auto *neg = node->to<IR::Neg>();
+    ASSERT_NE(neg, nullptr);
+    const auto *constant = neg->expr->to<IR::Constant>();
+    ASSERT_NE(constant, nullptr);
+    EXPECT_EQ(constant->value, 3);
+    EXPECT_EQ(constant->base, 16u);
+    EXPECT_EQ(constant->type, neg->type);
+    EXPECT_TRUE(neg->type->is<IR::Type_InfInt>());
+}
+
+TEST(JSON, missing_member) {
+    // Looking for a member that is not there passes the others, which are still found later.
+    std::stringstream ss(R"({ "a" : [ 1, 2 ], "b" : { "c" : 3 }, "d" : 4 })");
+    JSONLoader loader(ss);
+    int missing = 0;
+    EXPECT_FALSE(loader.load("missing", missing));
+    string_map<int> b;
+    ASSERT_TRUE(loader.load("b", b));
+    EXPECT_EQ(b.at("c"_cs), 3);
+    safe_vector<int> a;
+    ASSERT_TRUE(loader.load("a", a));
+    EXPECT_EQ(a, safe_vector<int>({1, 2}));
+    int d = 0;
+    ASSERT_TRUE(loader.load("d", d));
+    EXPECT_EQ(d, 4);
+    ASSERT_TRUE(loader.load("b", b));
+    EXPECT_EQ(b.size(), 1u);
+}
+
+TEST(JSON, pull_parser) {
+    std::stringstream ss(R"({ "a" : [ 1, -2, "x\"y" ], "b" : { "c" : null }, "d" : true } 42)");
+    JsonPullParser parser(ss);
+    std::string key;
+    ASSERT_TRUE(parser.beginObject());
+    ASSERT_TRUE(parser.nextKey(key));
+    EXPECT_EQ(key, "a");
+    ASSERT_TRUE(parser.beginArray());
+    ASSERT_TRUE(parser.nextElement());
+    EXPECT_EQ(parser.readNumber(), 1);
+    ASSERT_TRUE(parser.nextElement());
+    EXPECT_EQ(parser.readNumber(), -2);
+    ASSERT_TRUE(parser.nextElement());
+    EXPECT_EQ(parser.readString(), "x\"y");
+    EXPECT_FALSE(parser.nextElement());
+    // Whatever is left of "b" is skipped.
+    ASSERT_TRUE(parser.nextKey(key));
+    EXPECT_EQ(key, "b");
+    ASSERT_TRUE(parser.beginObject());
+    parser.finishValue(1);
+    ASSERT_TRUE(parser.nextKey(key));
+    EXPECT_EQ(key, "d");
+    EXPECT_EQ(parser.peek(), JsonPullParser::Boolean);
+    EXPECT_FALSE(parser.nextKey(key));
+    EXPECT_EQ(parser.depth(), 0u);
+    // Only the first value has been read from the stream.
+    int rest = 0;
+    ss >> rest;
+    EXPECT_EQ(rest, 42);
+}
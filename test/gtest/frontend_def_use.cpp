@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "frontends/p4/def_use.h"
+#include "frontends/p4/simplifyDefUse.h"
+#include "frontends/p4/typeMap.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+namespace P4::Test {
+
+namespace {
+
+/// Collects the constants assigned by assignment statements.
+class AssignedConstants : public Inspector {
+ public:
+    std::multiset<big_int> values;
+    void postorder(const IR::AssignmentStatement *statement) override {
+        if (auto *constant = statement->right->to<IR::Constant>())
+            values.insert(constant->value);
+    }
+};
+
+/// A control that writes a local in each of @count branches and reads it after each.
+std::string makeBranches(int count) {
+    std::string body;
+    for (int i = 0; i < count; ++i) {
+        auto n = std::to_string(i);
+        body += "if (h.f == " + n + ") { x = " + n + "; } else { x = h.g; }\n";
+        body += "h.g = h.g + x;\n";
+    }
+    std::string source = R"(
+        header H { bit<32> f; bit<32> g; }
+        control c(inout H h);
+        package Top(c a);
+        control branches(inout H h) {
+            bit<32> x;
+            apply {
+    )" + body + R"(
+            }
+        }
+        Top(branches()) main;
+    )";
+    return P4_SOURCE(P4Headers::NONE, source.c_str());
+}
+
+}  // namespace
+
+class FrontendDefUse : public P4CTest {};
+
+TEST_F(FrontendDefUse, ProgramPointSets) {
+    ProgramPointIndex index;
+    auto *a = new IR::Constant(1);
+    auto *b = new IR::Constant(2);
+    EXPECT_EQ(index.intern(ProgramPoint::beforeStart)->number, 0u);
+    const auto *entryA = index.intern(ProgramPoint(a));
+    EXPECT_EQ(entryA->number, 1u);
+    EXPECT_EQ(index.intern(ProgramPoint(a)), entryA);
+
+    const auto *uninit = new ProgramPoints(index.intern(ProgramPoint::beforeStart));
+    const auto *atA = new ProgramPoints(entryA);
+    const auto *atB = new ProgramPoints(index.intern(ProgramPoint(b)));
+    EXPECT_TRUE(uninit->containsBeforeStart());
+    EXPECT_FALSE(atA->containsBeforeStart());
+
+    const auto *both = atA->merge(atB);
+    EXPECT_EQ(both->size(), 2u);
+    EXPECT_EQ(both->merge(atA), both);
+    EXPECT_EQ(atB->merge(both), both);
+    EXPECT_TRUE(*both == *atB->merge(atA));
+    EXPECT_FALSE(*both == *atA);
+
+    ProgramPoints all;
+    EXPECT_EQ(all.size(), 0u);
+    EXPECT_TRUE(all.begin() == all.end());
+    all.add(both);
+    all.add(uninit);
+    unsigned seen = 0, seenB = 0;
+    for (const auto &point : all) {
+        ++seen;
+        seenB += point == ProgramPoint(b);
+    }
+    EXPECT_EQ(seen, 3u);
+    EXPECT_EQ(seenB, 1u);
+    EXPECT_TRUE(all.containsBeforeStart());
+    EXPECT_TRUE(all.begin()->isBeforeStart());
+}
+
+TEST_F(FrontendDefUse, RemovesOnlyDeadWrites) {
+    auto test = FrontendTestCase::create(P4_SOURCE(P4Headers::NONE, R"(
+        header H { bit<8> f; bit<8> g; bool b; }
+        control c(inout H h);
+        package Top(c a);
+        control first(inout H h) {
+            apply {
+                h.f = 1;
+                h.f = 2;
+                if (h.b) { h.g = 3; } else { h.g = 4; }
+                h.f = h.f + h.g;
+            }
+        }
+        Top(first()) main;
+    )"));
+    ASSERT_TRUE(test);
+    AssignedConstants assigned;
+    test->program->apply(assigned);
+    EXPECT_EQ(assigned.values.count(1), 0u);
+    EXPECT_EQ(assigned.values.count(2), 1u);
+    EXPECT_EQ(assigned.values.count(3), 1u);
+    EXPECT_EQ(assigned.values.count(4), 1u);
+}
+
+/// Times SimplifyDefUse on a control with 500 if statements, each of which joins the
+/// definitions made in its two branches.
+TEST_F(FrontendDefUse, DISABLED_ManyJoins) {
+    auto test = FrontendTestCase::create(makeBranches(500));
+    ASSERT_TRUE(test);
+    TypeMap typeMap;
+    auto start = std::chrono::steady_clock::now();
+    auto *result = test->program->apply(SimplifyDefUse(&typeMap));
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_NE(result, nullptr);
+    std::cout << "[FrontendDefUse] 500 joins: " << elapsed.count() << " ms" << std::endl;
+}
+
+}  // namespace P4::Test
@@ -0,0 +1,120 @@
+#include "frontends/p4/frontendSnapshot.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+
+#include "frontends/common/parseInput.h"
+#include "frontends/p4/frontend.h"
+#include "helpers.h"
+#include "lib/error.h"
+
+namespace P4::Test {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char *program = R"(const bit<8> one = 1;
+const bit<8> two = 2;
+control c(inout bit<8> x) {
+    apply { x = x + one; }
+}
+control C(inout bit<8> x);
+package top(C ctrl);
+top(c()) main;
+)";
+
+class FrontEndSnapshotTest : public P4CTest {
+ protected:
+    fs::path dir;
+    CompilerOptions options;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("p4c-snapshot-test-" + std::to_string(getpid()));
+        fs::remove_all(dir);
+        options.cacheDirectory = dir;
+        options.reuseFrontEnd = true;
+        options.commandLine = {"program.p4"};
+    }
+
+    void TearDown() override { fs::remove_all(dir); }
+
+    static const IR::P4Program *parse(const std::string &source) {
+        const auto *parsed = parseP4String(source, CompilerOptions::FrontendVersion::P4_16);
+        EXPECT_NE(parsed, nullptr);
+        EXPECT_EQ(::P4::errorCount(), 0u);
+        return parsed;
+    }
+
+    static const IR::P4Control *control(const IR::P4Program *program) {
+        for (const auto *object : program->objects) {
+            if (const auto *control = object->to<IR::P4Control>()) return control;
+        }
+        return nullptr;
+    }
+};
+
+}  // namespace
+
+TEST_F(FrontEndSnapshotTest, Fingerprints) {
+    auto declarations = DeclarationFingerprint::compute(parse(program));
+    ASSERT_EQ(declarations.size(), 6u);
+    EXPECT_EQ(declarations[0].name, "one");
+    EXPECT_EQ(declarations[2].name, "c");
+    EXPECT_EQ(declarations[2].firstLine + 2, declarations[2].lastLine);
+
+    auto edited = DeclarationFingerprint::compute(parse(std::string("\n\n") + program));
+    ASSERT_EQ(edited.size(), 6u);
+    for (size_t i = 0; i < edited.size(); ++i) {
+        EXPECT_EQ(edited[i].text, declarations[i].text);
+        EXPECT_EQ(edited[i].firstLine, declarations[i].firstLine + 2);
+    }
+}
+
+TEST_F(FrontEndSnapshotTest, ReusesUnchangedProgram) {
+    const auto *first = FrontEnd().run(options, parse(program));
+    ASSERT_NE(first, nullptr);
+
+    // Comments and blank lines between declarations do not matter.
+    std::string edited = std::string("// A comment\n\n") + program;
+    edited.insert(edited.find("control"), "\n\n");
+    const auto *parsed = parse(edited);
+    FrontEndSnapshot snapshot(options, parsed);
+    ASSERT_TRUE(snapshot.isActive());
+    const auto *restored = snapshot.restore();
+    ASSERT_NE(restored, nullptr);
+    EXPECT_TRUE(restored->equiv(*first));
+
+    // Positions refer to the edited source.
+    ASSERT_NE(control(restored), nullptr);
+    EXPECT_EQ(control(restored)->srcInfo.getStart(), control(parsed)->srcInfo.getStart());
+    EXPECT_EQ(control(restored)->srcInfo.getStart().getLineNumber(),
+              control(first)->srcInfo.getStart().getLineNumber() + 4);
+}
+
+TEST_F(FrontEndSnapshotTest, RerunsChangedProgram) {
+    ASSERT_NE(FrontEnd().run(options, parse(program)), nullptr);
+
+    // A change to any declaration, even one nothing refers to, runs the whole frontend again.
+    std::string edited = program;
+    edited.replace(edited.find("= 2"), 3, "= 3");
+    EXPECT_EQ(FrontEndSnapshot(options, parse(edited)).restore(), nullptr);
+    const auto *result = FrontEnd().run(options, parse(edited));
+    ASSERT_NE(result, nullptr);
+    const auto *restored = FrontEndSnapshot(options, parse(edited)).restore();
+    ASSERT_NE(restored, nullptr);
+    EXPECT_TRUE(restored->equiv(*result));
+}
+
+TEST_F(FrontEndSnapshotTest, Inactive) {
+    options.reuseFrontEnd = false;
+    EXPECT_FALSE(FrontEndSnapshot(options, parse(program)).isActive());
+    options.reuseFrontEnd = true;
+    options.prettyPrintFile = dir / "program.pp.p4";
+    EXPECT_FALSE(FrontEndSnapshot(options, parse(program)).isActive());
+}
+
+}  // namespace P4::Test
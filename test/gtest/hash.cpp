@@ -16,10 +16,12 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "lib/cstring.h"
+#include "lib/sha256.h"
 
 namespace P4::Test {
 
@@ -290,4 +292,16 @@ TEST(Hash, SharedPtr) { pointerTestWithHash<std::shared_ptr>(); }
 
 TEST(Hash, Pointer) { pointerTestWithHash<Pointer>(); }
 
+TEST(Hash, Sha256) {
+    EXPECT_EQ(Util::sha256Hex(""),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(Util::sha256Hex("abc"),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    // Padding that needs a second block.
+    EXPECT_EQ(Util::sha256Hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    EXPECT_EQ(Util::sha256Hex(std::string(64, 'x')),
+              "7ce100971f64e7001e8fe5a51973ecdfe1ced42befe7ee8d5fd6219506b5393c");
+}
+
 }  // namespace P4::Test
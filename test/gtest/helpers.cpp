@@ -28,6 +28,7 @@ limitations under the License.
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/frontend.h"
 #include "frontends/p4/parseAnnotations.h"
+#include "ir/ir.h"
 
 namespace P4::TestDetail {
 
@@ -208,4 +209,16 @@ namespace P4::Test {
     return FrontendTestCase{program};
 }
 
+const IR::P4Program *makeConstantsProgram(int count, int terms, int first) {
+    auto *type = IR::Type_Bits::get(32);
+    IR::Vector<IR::Node> objects;
+    for (int i = 0; i < count; ++i) {
+        const IR::Expression *init = new IR::Constant(type, first + i);
+        for (int t = 1; t < terms; ++t) init = new IR::Add(type, init, new IR::Constant(type, t));
+        objects.push_back(
+            new IR::Declaration_Constant(IR::ID(cstring("c" + std::to_string(i))), type, init));
+    }
+    return new IR::P4Program(objects);
+}
+
 }  // namespace P4::Test
@@ -141,6 +141,11 @@ struct FrontendTestCase {
     const IR::P4Program *program;
 };
 
+/// A program with @p count constant declarations, each initialized with a sum of @p terms
+/// constants.  The first constant of declaration i is @p first + i, the others are 1 to
+/// @p terms - 1.  Passes can be run on it without the frontend.
+const IR::P4Program *makeConstantsProgram(int count, int terms, int first = 0);
+
 /// Redirects std::cerr temporarily
 struct RedirectStderr {
     RedirectStderr() : old(std::cerr.rdbuf(stream.rdbuf())) {}
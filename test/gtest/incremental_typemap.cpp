@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <optional>
+
+#include "frontends/p4/typeChecking/typeChecker.h"
+#include "frontends/p4/typeMap.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+namespace P4::Test {
+
+namespace {
+
+/// Replaces the constant 1 with 2.
+class BumpOne : public Transform {
+    const IR::Node *postorder(IR::Constant *c) override {
+        if (c->value == 1) return new IR::Constant(c->srcInfo, c->type, 2);
+        return c;
+    }
+};
+
+/// Checks that every node typed in @expected has the same type in @actual.
+class SameTypes : public Inspector {
+    const TypeMap &actual, &expected;
+
+ public:
+    unsigned checked = 0;
+    SameTypes(const TypeMap &actual, const TypeMap &expected)
+        : actual(actual), expected(expected) {}
+    bool preorder(const IR::Node *node) override {
+        auto *type = expected.getType(node);
+        if (type == nullptr) return true;
+        ++checked;
+        auto *found = actual.getType(node);
+        EXPECT_NE(found, nullptr) << dbp(node);
+        if (found != nullptr) EXPECT_TRUE(found->equiv(*type)) << dbp(node);
+        return true;
+    }
+};
+
+const IR::Node *findObject(const IR::P4Program *program, const char *name) {
+    for (auto *object : program->objects) {
+        auto *declaration = object->to<IR::IDeclaration>();
+        if (declaration != nullptr && declaration->getName().name == name) return object;
+    }
+    return nullptr;
+}
+
+std::optional<FrontendTestCase> createTestCase() {
+    return FrontendTestCase::create(P4_SOURCE(P4Headers::NONE, R"(
+        header H { bit<8> f; }
+        header G { bit<16> g; }
+        control c1(inout H h);
+        control c2(inout G g);
+        package Top(c1 a, c2 b);
+        control first(inout H h) { apply { h.f = h.f + 3; } }
+        control second(inout G g) { apply { g.g = g.g + 1; } }
+        Top(first(), second()) main;
+    )"));
+}
+
+}  // namespace
+
+class IncrementalTypeMap : public P4CTest {};
+
+TEST_F(IncrementalTypeMap, RetypesOnlyChangedDeclarations) {
+    auto test = createTestCase();
+    ASSERT_TRUE(test);
+    TypeMap typeMap;
+    typeMap.setIncremental(true);
+    auto *program = test->program->apply(TypeChecking(nullptr, &typeMap));
+    ASSERT_NE(program, nullptr);
+    auto typed = typeMap.nodesTyped();
+
+    auto *changed = program->apply(BumpOne())->to<IR::P4Program>();
+    ASSERT_NE(changed, program);
+    changed->apply(ClearTypeMap(&typeMap));
+    EXPECT_TRUE(typeMap.contains(findObject(changed, "first")));
+    EXPECT_TRUE(typeMap.contains(findObject(changed, "G")));
+    EXPECT_FALSE(typeMap.contains(findObject(program, "second")));
+    // Unchanged, but uses the changed control.
+    EXPECT_FALSE(typeMap.contains(findObject(changed, "main")));
+
+    changed = changed->apply(TypeChecking(nullptr, &typeMap))->to<IR::P4Program>();
+    ASSERT_NE(changed, nullptr);
+    auto retyped = typeMap.nodesTyped() - typed;
+    EXPECT_GT(retyped, 0u);
+    EXPECT_LT(retyped, typed);
+
+    TypeMap fresh;
+    changed->apply(TypeChecking(nullptr, &fresh));
+    SameTypes compare(typeMap, fresh);
+    changed->apply(compare);
+    EXPECT_GT(compare.checked, 0u);
+}
+
+TEST_F(IncrementalTypeMap, ClearedUnlessIncremental) {
+    auto test = createTestCase();
+    ASSERT_TRUE(test);
+    TypeMap typeMap;
+    auto *program = test->program->apply(TypeChecking(nullptr, &typeMap));
+    ASSERT_NE(program, nullptr);
+    EXPECT_GT(typeMap.size(), 0u);
+    program->apply(BumpOne())->apply(ClearTypeMap(&typeMap));
+    EXPECT_EQ(typeMap.size(), 0u);
+}
+
+}  // namespace P4::Test
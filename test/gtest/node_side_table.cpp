@@ -0,0 +1,102 @@
+#include "ir/node_side_table.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "helpers.h"
+#include "ir/ir.h"
+#include "lib/hash.h"
+
+namespace P4::Test {
+
+class NodeSideTableTest : public P4CTest {};
+
+TEST_F(NodeSideTableTest, InsertFindErase) {
+    NodeSideTable<int> table;
+    auto *a = new IR::Constant(1);
+    auto *b = new IR::Constant(2);
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.find(a), nullptr);
+
+    EXPECT_TRUE(table.emplace(a, 10).second);
+    EXPECT_FALSE(table.emplace(a, 11).second);
+    EXPECT_EQ(*table.find(a), 10);
+    table[b] = 20;
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_EQ(table.count(b), 1u);
+
+    EXPECT_EQ(table.erase(a), 1u);
+    EXPECT_EQ(table.erase(a), 0u);
+    EXPECT_EQ(table.find(a), nullptr);
+    EXPECT_EQ(*table.find(b), 20);
+    EXPECT_EQ(table.size(), 1u);
+    EXPECT_EQ(table.erase(b), 1u);
+    EXPECT_EQ(table.pagesAllocated(), 0u);
+}
+
+TEST_F(NodeSideTableTest, NodesWithTheSameId) {
+    NodeSideTable<int> table;
+    auto *a = new IR::Constant(1);
+    auto *b = new IR::Constant(2);
+    // As for a node read from a dump.
+    b->id = a->id;
+    table[a] = 1;
+    EXPECT_EQ(table.find(b), nullptr);
+    table[b] = 2;
+    EXPECT_EQ(*table.find(a), 1);
+    EXPECT_EQ(*table.find(b), 2);
+    EXPECT_EQ(table.size(), 2u);
+    table.erase(a);
+    EXPECT_EQ(table.find(a), nullptr);
+    EXPECT_EQ(*table.find(b), 2);
+    table.erase(b);
+    EXPECT_TRUE(table.empty());
+}
+
+TEST_F(NodeSideTableTest, IteratesInIdOrder) {
+    NodeSideTable<int> table;
+    std::vector<const IR::Node *> nodes;
+    for (int i = 0; i < 1000; ++i) nodes.push_back(new IR::Constant(i));
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) table[*it] = (*it)->id;
+    int previous = -1, visited = 0;
+    table.forEach([&](const IR::Node *node, int value) {
+        EXPECT_EQ(node->id, value);
+        EXPECT_GT(value, previous);
+        previous = value;
+        ++visited;
+    });
+    EXPECT_EQ(visited, 1000);
+}
+
+/// Compares repeated lookups of 200000 nodes in a hash table keyed by node address and in a
+/// NodeSideTable.
+TEST_F(NodeSideTableTest, DISABLED_Lookups) {
+    std::vector<const IR::Node *> nodes;
+    for (int i = 0; i < 200000; ++i) nodes.push_back(new IR::Constant(i));
+    absl::flat_hash_map<const IR::Node *, const IR::Node *, Util::Hash> hashed;
+    NodeSideTable<const IR::Node *> table;
+    for (auto *node : nodes) {
+        hashed.emplace(node, node);
+        table.emplace(node, node);
+    }
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 10; ++repeat)
+        for (auto *node : nodes) found += hashed.find(node)->second == node;
+    std::chrono::duration<double, std::milli> hashTime = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 10; ++repeat)
+        for (auto *node : nodes) found += *table.find(node) == node;
+    std::chrono::duration<double, std::milli> tableTime = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(found, 2 * 10 * nodes.size());
+    std::cout << "[NodeSideTable] 2M lookups: " << hashTime.count() << " ms hashed, "
+              << tableTime.count() << " ms in " << table.pagesAllocated() << " pages"
+              << std::endl;
+}
+
+}  // namespace P4::Test
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "frontends/common/parseInput.h"
+#include "frontends/p4/frontend.h"
+#include "frontends/p4/toP4/toP4.h"
+#include "helpers.h"
+#include "ir/ir.h"
+#include "ir/pass_manager.h"
+#include "lib/sourceCodeBuilder.h"
+
+namespace P4::Test {
+
+namespace {
+
+/// Increments every constant, a pass that only ever looks inside one declaration.
+class IncrementConstants : public Transform, public DeclarationLocal {
+    const IR::Node *postorder(IR::Constant *c) override {
+        return new IR::Constant(c->srcInfo, c->type, c->value + 1);
+    }
+
+ public:
+    IncrementConstants *clone() const override { return new IncrementConstants(*this); }
+};
+
+/// Looks at every declaration and changes nothing.
+class ReadDeclarations : public Inspector, public DeclarationLocal {
+ public:
+    ReadDeclarations *clone() const override { return new ReadDeclarations(*this); }
+};
+
+const IR::Node *runPasses(const IR::P4Program *program, unsigned jobs) {
+    PassManager passes({new IncrementConstants, new IncrementConstants});
+    passes.setParallelJobs(jobs);
+    return program->apply(passes);
+}
+
+/// Runs the frontend over @p program with @p jobs parallel jobs and prints the result.
+std::string runFrontEnd(const IR::P4Program *program, unsigned jobs) {
+    CompilerOptions options;
+    options.langVersion = CompilerOptions::FrontendVersion::P4_16;
+    options.parallelJobs = jobs;
+    const auto *result = P4::FrontEnd().run(options, program);
+    if (result == nullptr) return {};
+    Util::SourceCodeBuilder builder;
+    ToP4 top4(builder, false);
+    result->apply(top4);
+    return builder.toString();
+}
+
+}  // namespace
+
+class ParallelPass : public P4CTest {};
+
+TEST_F(ParallelPass, SameResultAsSerial) {
+    auto *program = makeConstantsProgram(100, 4);
+    auto *serial = runPasses(program, 1);
+    for (unsigned jobs : {2, 3, 8}) {
+        auto *parallel = runPasses(program, jobs);
+        ASSERT_TRUE(parallel->is<IR::P4Program>());
+        EXPECT_TRUE(parallel->equiv(*serial)) << "with " << jobs << " jobs";
+    }
+    EXPECT_TRUE(program->equiv(*makeConstantsProgram(100, 4)));
+}
+
+TEST_F(ParallelPass, UnchangedProgramIsKept) {
+    auto *program = makeConstantsProgram(10, 2);
+    PassManager passes({new ReadDeclarations});
+    passes.setParallelJobs(4);
+    EXPECT_EQ(program->apply(passes), program);
+}
+
+TEST_F(ParallelPass, FrontEndSameResultAsSerial) {
+    // Controls whose arithmetic StrengthReduction, a DeclarationLocal pass, rewrites.
+    std::string source;
+    for (int i = 0; i < 16; ++i) {
+        auto n = std::to_string(i);
+        source += "control c" + n + "(inout bit<32> x, inout bit<32> y) {\n" +
+                  "    apply {\n"
+                  "        x = x * 8 + (y & 0);\n"
+                  "        y = y / 4 - " + n + ";\n"
+                  "    }\n"
+                  "}\n";
+    }
+    auto *program = P4::parseP4String(P4_SOURCE(P4Headers::CORE, source.c_str()),
+                                      CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(program != nullptr && ::P4::errorCount() == 0);
+
+    auto serial = runFrontEnd(program, 1);
+    ASSERT_EQ(::P4::errorCount(), 0u);
+    EXPECT_NE(serial.find("x << 3"), std::string::npos) << serial;
+    EXPECT_EQ(serial.find("x * 8"), std::string::npos) << serial;
+    for (unsigned jobs : {2, 4}) {
+        EXPECT_EQ(runFrontEnd(program, jobs), serial) << "with " << jobs << " jobs";
+    }
+    EXPECT_EQ(::P4::errorCount(), 0u);
+}
+
+/// Reports the wall time of the passes for 1 to 16 jobs.  Threads are only used in builds
+/// with MULTITHREAD enabled.
+TEST_F(ParallelPass, DISABLED_Scaling) {
+    auto *program = makeConstantsProgram(256, 200);
+    for (unsigned jobs : {1, 2, 4, 8, 16}) {
+        auto start = std::chrono::steady_clock::now();
+        runPasses(program, jobs);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cout << "[ParallelPass] " << jobs << " jobs: " << elapsed.count() << " ms"
+                  << std::endl;
+    }
+}
+
+}  // namespace P4::Test
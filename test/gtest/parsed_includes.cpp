@@ -0,0 +1,193 @@
+#include "frontends/parsers/parsedIncludes.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+#include "frontends/common/parser_options.h"
+#include "frontends/p4/typeMap.h"
+#include "frontends/p4/toP4/toP4.h"
+#include "frontends/parsers/parserDriver.h"
+#include "helpers.h"
+#include "lib/error.h"
+#include "lib/sourceCodeBuilder.h"
+
+namespace P4::Test {
+
+namespace fs = std::filesystem;
+
+using namespace P4::literals;
+
+namespace {
+
+/// A preprocessed program including a standard file with @p declarations.
+std::string preprocessed(const std::string &declarations, const std::string &program) {
+    std::string include = std::string(p4includePath) + "/test.p4";
+    return "# 1 \"main.p4\"\n/* A comment. */\n# 1 \"" + include + "\" 1\n" + declarations +
+           "\n# 2 \"main.p4\" 2\n\n" + program;
+}
+
+constexpr const char *declarations = R"(extern E<T> {
+    E();
+    T get();
+}
+typedef bit<8> Byte;
+error { A }
+/* A comment
+# 5 "not a marker"
+*/
+enum Color { Red, Green }
+)";
+
+constexpr const char *program = R"(error { B }
+control c(out Byte b) {
+    E<Byte>() e;
+    apply { b = e.get(); }
+}
+)";
+
+class ParsedIncludesTest : public P4CTest {
+ protected:
+    fs::path dir;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("p4c-includes-test-" + std::to_string(getpid()));
+        fs::remove_all(dir);
+    }
+
+    void TearDown() override { fs::remove_all(dir); }
+
+    const IR::P4Program *parse(const std::string &source) {
+        auto *result = P4ParserDriver::parseWithCachedIncludes(source, "main.p4", dir, "test");
+        EXPECT_NE(result, nullptr);
+        EXPECT_EQ(::P4::errorCount(), 0u);
+        return result;
+    }
+
+    size_t entries() const {
+        size_t count = 0;
+        std::error_code ec;
+        for (const auto &file : fs::directory_iterator(dir, ec))
+            count += file.path().filename().string().rfind("includes-", 0) == 0;
+        return count;
+    }
+
+    static std::string print(const IR::P4Program *program) {
+        Util::SourceCodeBuilder builder;
+        ToP4 toP4(builder, false);
+        program->apply(toP4);
+        return builder.toString();
+    }
+};
+
+}  // namespace
+
+TEST_F(ParsedIncludesTest, PrefixLength) {
+    auto source = preprocessed(declarations, program);
+    auto length = ParsedIncludes::prefixLength(source);
+    EXPECT_EQ(source.substr(length), std::string("\n") + program);
+    // Declarations of the program before the include.
+    EXPECT_EQ(ParsedIncludes::prefixLength("const bit<8> x = 1;\n" + source), 0u);
+    EXPECT_EQ(ParsedIncludes::prefixLength(program), 0u);
+}
+
+TEST_F(ParsedIncludesTest, ReusesDeclarations) {
+    auto source = preprocessed(declarations, program);
+    const auto *parsed = parse(source);
+    ASSERT_NE(parsed, nullptr);
+    EXPECT_EQ(entries(), 1u);
+    const auto *reused = parse(source);
+    ASSERT_NE(reused, nullptr);
+    EXPECT_EQ(entries(), 1u);
+
+    ASSERT_EQ(parsed->objects.size(), reused->objects.size());
+    for (size_t i = 0; i < parsed->objects.size(); ++i) {
+        EXPECT_EQ(parsed->objects[i]->node_type_name(), reused->objects[i]->node_type_name());
+        EXPECT_EQ(parsed->objects[i]->srcInfo.toPositionString(),
+                  reused->objects[i]->srcInfo.toPositionString());
+    }
+    EXPECT_EQ(print(parsed), print(reused));
+    // The error declaration of the program is merged into the cached one.
+    auto errors = reused->getDeclsByName("error"_cs)->toVector();
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_EQ(errors.front()->to<IR::Type_Error>()->members.size(), 2u);
+    // The cached entry is not changed by that.
+    const auto *again = parse(source);
+    ASSERT_NE(again, nullptr);
+    const auto *error = again->getDeclsByName("error"_cs)->toVector().front();
+    EXPECT_EQ(error->to<IR::Type_Error>()->members.size(), 2u);
+}
+
+TEST_F(ParsedIncludesTest, DifferentIncludes) {
+    ASSERT_NE(parse(preprocessed(declarations, program)), nullptr);
+    ASSERT_NE(parse(preprocessed(std::string(declarations) + "typedef bit<4> Nibble;\n",
+                                 program)),
+              nullptr);
+    EXPECT_EQ(entries(), 2u);
+}
+
+TEST_F(ParsedIncludesTest, ChecksIncludeText) {
+    auto source = preprocessed(declarations, program);
+    auto other = preprocessed(std::string(declarations) + "typedef bit<4> Nibble;\n", program);
+    ASSERT_NE(parse(source), nullptr);
+    auto first = fs::directory_iterator(dir)->path();
+    ASSERT_NE(parse(other), nullptr);
+    ASSERT_EQ(entries(), 2u);
+    fs::path second;
+    for (const auto &file : fs::directory_iterator(dir))
+        if (file.path() != first) second = file.path();
+    // The entry of the other program holds the parsed include files of the first, as a
+    // collision of their keys would.
+    fs::remove_all(second);
+    fs::copy(first, second);
+    const auto *parsed = parse(other);
+    ASSERT_NE(parsed, nullptr);
+    EXPECT_EQ(parsed->getDeclsByName("Nibble"_cs)->toVector().size(), 1u);
+}
+
+TEST_F(ParsedIncludesTest, LoadedDeclIdsAreNotReused) {
+    // An entry stored by a compilation that had numbered more declarations than this one.
+    auto *stored = new IR::Type_Var(IR::ID("T"));
+    stored->declid += 100000;
+    ParsedIncludes includes(dir, "prefix", "test");
+    Util::ProgramStructure structure;
+    includes.store(structure, IR::Vector<IR::Node>({stored}));
+    IR::Vector<IR::Node> nodes;
+    ASSERT_TRUE(includes.load(nullptr, structure, nodes));
+    ASSERT_EQ(nodes.size(), 1u);
+    const auto *loaded = nodes.at(0)->to<IR::Type_Var>();
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->declid, stored->declid);
+
+    auto *created = new IR::Type_Var(IR::ID("T"));
+    EXPECT_GT(created->declid, loaded->declid);
+    EXPECT_FALSE(TypeMap().equivalent(created, loaded));
+}
+
+/// Compares the time to parse a small program that includes a standard file of 4000
+/// declarations with and without the parsed include files.
+TEST_F(ParsedIncludesTest, DISABLED_SmallProgram) {
+    std::string header;
+    for (int i = 0; i < 2000; ++i) {
+        auto n = std::to_string(i);
+        header += "header h" + n + "_t { bit<8> f; bit<16> g; }\n";
+        header += "extern void f" + n + "<T>(in T value, out bit<8> result);\n";
+    }
+    auto source = preprocessed(header, program);
+    auto start = std::chrono::steady_clock::now();
+    std::istringstream in(source);
+    ASSERT_NE(P4ParserDriver::parse(in, "main.p4"), nullptr);
+    std::chrono::duration<double, std::milli> parseTime = std::chrono::steady_clock::now() - start;
+    ASSERT_NE(parse(source), nullptr);
+    start = std::chrono::steady_clock::now();
+    ASSERT_NE(parse(source), nullptr);
+    std::chrono::duration<double, std::milli> cachedTime = std::chrono::steady_clock::now() - start;
+    std::cout << "[ParsedIncludes] 4000 included declarations: " << parseTime.count()
+              << " ms parsed, " << cachedTime.count() << " ms cached" << std::endl;
+}
+
+}  // namespace P4::Test
@@ -4,12 +4,15 @@
 
 #ifdef PARSER_UNROLL_TIME_CHECKING
 #include <chrono>
+#include <iostream>
 #endif
 #include <cstdlib>
+#include <string>
 
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/frontend.h"
 #include "ir/ir.h"
+#include "midend/parserUnroll.h"
 #include "test/gtest/env.h"
 #include "test/gtest/helpers.h"
 #include "test/gtest/midend_pass.h"
@@ -88,6 +91,60 @@ std::pair<const IR::P4Parser *, const IR::P4Parser *> loadExample(
     return rewriteParser(program, options);
 }
 
+/// A parser that extracts up to @depth MPLS labels and then up to @depth inner labels, so that
+/// unrolling it needs a number of states quadratic in @depth.
+std::string nestedStacks(int depth) {
+    auto stack = "mpls_t[" + std::to_string(depth) + "]";
+    std::string source = R"(
+        header eth_t { bit<16> type; }
+        header mpls_t { bit<20> label; bit<3> tc; bit<1> bos; bit<8> ttl; }
+        struct headers { eth_t eth; )" + stack + " mpls; " + stack + R"( inner; }
+        parser p(packet_in pkt, out headers hdr) {
+            state start {
+                pkt.extract(hdr.eth);
+                transition select(hdr.eth.type) { 0x8847: parse_mpls; default: accept; }
+            }
+            state parse_mpls {
+                pkt.extract(hdr.mpls.next);
+                transition select(hdr.mpls.last.bos) { 0: parse_mpls; default: parse_inner; }
+            }
+            state parse_inner {
+                pkt.extract(hdr.inner.next);
+                transition select(hdr.inner.last.bos) { 0: parse_inner; default: accept; }
+            }
+        }
+        parser P(packet_in pkt, out headers hdr);
+        package Top(P p);
+        Top(p()) main;
+    )";
+    return P4_SOURCE(P4Headers::CORE, source.c_str());
+}
+
+/// Runs the frontend and ParsersUnroll with @budget on @source.
+std::pair<const IR::P4Parser *, const IR::P4Parser *> unrollSource(const std::string &source,
+                                                                   size_t budget) {
+    AutoCompileContext autoP4TestContext(new P4TestContext);
+    auto &options = P4TestContext::get().options();
+    const char *argv = "./gtestp4c";
+    options.process(1, (char *const *)&argv);
+    const auto *program = P4::parseP4String(source, CompilerOptions::FrontendVersion::P4_16);
+    if (!program) return std::make_pair(nullptr, nullptr);
+    program = P4::FrontEnd().run(options, program);
+    if (!program) return std::make_pair(nullptr, nullptr);
+    P4::ReferenceMap refMap;
+    P4::TypeMap typeMap;
+#ifdef PARSER_UNROLL_TIME_CHECKING
+    auto t1 = std::chrono::high_resolution_clock::now();
+#endif
+    const auto *unrolled = program->apply(P4::ParsersUnroll(true, &refMap, &typeMap, budget));
+#ifdef PARSER_UNROLL_TIME_CHECKING
+    auto t2 = std::chrono::high_resolution_clock::now();
+    auto msInt = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+    std::cout << msInt.count() << std::endl;
+#endif
+    return std::make_pair(getParser(program), getParser(unrolled));
+}
+
 TEST_F(P4CParserUnroll, test1) {
     auto parsers = loadExample("parser-unroll-test1.p4");
     ASSERT_TRUE(parsers.first);
@@ -154,4 +211,35 @@ TEST_F(P4CParserUnroll, stringTypes) {
     ASSERT_EQ(parsers.first->states.size(), parsers.second->states.size());
 }
 
+TEST_F(P4CParserUnroll, budgetExceeded) {
+    auto source = nestedStacks(4);
+    auto parsers = unrollSource(source, P4::defaultParserUnrollBudget);
+    ASSERT_TRUE(parsers.first);
+    ASSERT_TRUE(parsers.second);
+    ASSERT_GT(parsers.second->states.size(), parsers.first->states.size());
+
+    // Too few states to unroll: the parser is left as is.
+    parsers = unrollSource(source, 2);
+    ASSERT_TRUE(parsers.first);
+    ASSERT_TRUE(parsers.second);
+    ASSERT_EQ(parsers.first->states.size(), parsers.second->states.size());
+}
+
+TEST_F(P4CParserUnroll, noBudgetByDefault) {
+    EXPECT_EQ(P4::defaultParserUnrollBudget, 0u);
+    EXPECT_EQ(CompilerOptions().parserUnrollBudget, 0u);
+}
+
+#ifdef PARSER_UNROLL_TIME_CHECKING
+/// Reports the time taken to unroll parsers of nested header stacks of increasing depth.
+TEST_F(P4CParserUnroll, nestedStacksScaling) {
+    for (int depth : {2, 4, 8, 16}) {
+        auto parsers = unrollSource(nestedStacks(depth), 0);
+        ASSERT_TRUE(parsers.second);
+        std::cout << "depth " << depth << ": " << parsers.second->states.size() << " states"
+                  << std::endl;
+    }
+}
+#endif
+
 }  // namespace P4::Test
@@ -0,0 +1,82 @@
+#include "ir/pass_profile.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "helpers.h"
+#include "ir/ir.h"
+#include "ir/pass_manager.h"
+
+namespace P4::Test {
+
+namespace {
+
+/// Replaces the constant 1 with 2.
+class BumpOne : public Transform {
+    const IR::Node *postorder(IR::Constant *c) override {
+        if (c->value == 1) return new IR::Constant(c->srcInfo, c->type, 2);
+        return c;
+    }
+
+ public:
+    BumpOne() { setName("BumpOne"); }
+};
+
+class LookAround : public Inspector {
+ public:
+    LookAround() { setName("LookAround"); }
+};
+
+class PassProfileTest : public P4CTest {
+ protected:
+    void SetUp() override { PassProfile::enable({}); }
+    void TearDown() override { PassProfile::disable(); }
+};
+
+}  // namespace
+
+TEST_F(PassProfileTest, RecordsNestedPasses) {
+    auto *type = IR::Type_Bits::get(8);
+    const IR::Node *program =
+        new IR::Add(type, new IR::Constant(type, 1), new IR::Constant(type, 3));
+
+    PassManager passes({new BumpOne, new PassRepeated({new LookAround})});
+    passes.setName("Outer");
+    program = program->apply(passes);
+    ASSERT_NE(program, nullptr);
+
+    const auto &records = PassProfile::records();
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].path, "Outer");
+    EXPECT_EQ(records[0].depth, 0u);
+    EXPECT_EQ(records[1].path, "Outer.BumpOne");
+    EXPECT_EQ(records[1].depth, 1u);
+    EXPECT_EQ(records[1].nodesBefore, records[1].nodesAfter);
+    EXPECT_GT(records[1].nodesBefore, 0u);
+    // The constant and the sum above it.
+    EXPECT_GE(records[1].nodesCloned, 2u);
+    EXPECT_EQ(records[2].path, "Outer.P4::PassRepeated");
+    EXPECT_EQ(records[3].path, "Outer.P4::PassRepeated.LookAround");
+    EXPECT_EQ(records[3].depth, 2u);
+    EXPECT_EQ(records[3].nodesCloned, 0u);
+    // The outer manager includes its passes.
+    EXPECT_GE(records[0].nodesCloned, records[1].nodesCloned);
+    EXPECT_LE(records[0].start, records[1].start);
+
+    std::stringstream out;
+    PassProfile::write(out);
+    EXPECT_NE(out.str().find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(out.str().find("\"passSummary\""), std::string::npos);
+    EXPECT_NE(out.str().find("Outer.P4::PassRepeated.LookAround"), std::string::npos);
+}
+
+TEST_F(PassProfileTest, Disabled) {
+    PassProfile::disable();
+    const IR::Node *program = new IR::Constant(1);
+    PassManager passes({new BumpOne});
+    program->apply(passes);
+    EXPECT_TRUE(PassProfile::records().empty());
+}
+
+}  // namespace P4::Test
@@ -0,0 +1,130 @@
+#include "lib/persistent_map.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "lib/flat_map.h"
+
+namespace P4::Test {
+
+TEST(persistent_map, InsertFindIterate) {
+    persistent_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.find(1), nullptr);
+    for (int key : {5, 3, 8, 1, 4, 7, 9, 2, 6}) m[key] = key * 10;
+    EXPECT_EQ(m.size(), 9u);
+    EXPECT_EQ(*m.find(4), 40);
+    EXPECT_EQ(m.count(10), 0u);
+    EXPECT_FALSE(m.insert_or_assign(4, 41));
+    EXPECT_TRUE(m.insert_or_assign(10, 100));
+    EXPECT_EQ(*m.find(4), 41);
+    std::vector<int> keys;
+    for (auto &[key, value] : m) keys.push_back(key);
+    EXPECT_EQ(keys, (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+}
+
+TEST(persistent_map, CopiesAreIndependent) {
+    std::mt19937 rng(1);
+    persistent_map<int, int> m;
+    std::map<int, int> expected;
+    std::vector<std::pair<persistent_map<int, int>, std::map<int, int>>> copies;
+    for (int i = 0; i < 5000; ++i) {
+        int key = static_cast<int>(rng() % 1000);
+        m[key] = i;
+        expected[key] = i;
+        if (i % 500 == 0) copies.emplace_back(m, expected);
+    }
+    ASSERT_EQ(m.size(), expected.size());
+    EXPECT_TRUE(std::equal(m.begin(), m.end(), expected.begin(), expected.end()));
+    // Changes after a copy do not show in the copy.
+    for (auto &[copy, copyExpected] : copies) {
+        ASSERT_EQ(copy.size(), copyExpected.size());
+        EXPECT_TRUE(std::equal(copy.begin(), copy.end(), copyExpected.begin(), copyExpected.end()));
+        copy[-1] = 0;
+        EXPECT_EQ(m.count(-1), 0u);
+    }
+}
+
+TEST(persistent_map, ChangesAfterCopyInPlace) {
+    persistent_map<int, int> m;
+    for (int i = 0; i < 100; ++i) m[i] = i;
+    auto copy = m;
+    // Both maps copy the shared path once, and then change their own nodes in place.
+    m[50] = -1;
+    const int *changed = m.find(50);
+    m[50] = -2;
+    EXPECT_EQ(m.find(50), changed);
+    EXPECT_EQ(*copy.find(50), 50);
+    copy[50] = -3;
+    EXPECT_EQ(*m.find(50), -2);
+    EXPECT_EQ(*copy.find(50), -3);
+}
+
+TEST(persistent_map, CopiesInThreads) {
+    persistent_map<int, int> shared;
+    for (int i = 0; i < 1000; ++i) shared[i] = i;
+    std::vector<std::thread> threads;
+    bool ok[4] = {};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < 100; ++round) {
+                auto copy = shared;
+                for (int i = 0; i < 1000; i += 7) copy[i] = -t;
+                {
+                    // Copies of the copy released while other threads change theirs.
+                    auto temporary = copy;
+                    temporary[round] = round;
+                }
+            }
+            auto copy = shared;
+            copy[t] = -1;
+            ok[t] = *copy.find(t) == -1 && *shared.find(t) == t;
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    for (int t = 0; t < 4; ++t) EXPECT_TRUE(ok[t]);
+    for (int i = 0; i < 1000; ++i) EXPECT_EQ(*shared.find(i), i);
+}
+
+/// Reports the time to explore the branches of a chain of table applications on a state of
+/// 5000 variables, where each branch is a copy of the state that sets the variables of one
+/// action, with a persistent_map and with a flat_map, the map of the symbolic environment of
+/// P4Testgen before it was persistent.
+TEST(persistent_map, DISABLED_TableApplyBranches) {
+    constexpr int variables = 5000, tables = 200, actions = 8, writes = 4;
+    auto explore = [&](auto state) {
+        for (int i = 0; i < variables; ++i) state[i] = i;
+        auto start = std::chrono::steady_clock::now();
+        // The branches that are not explored are kept, as the symbolic executor does.
+        std::vector<decltype(state)> pending;
+        for (int table = 0; table < tables; ++table) {
+            for (int action = 0; action < actions; ++action) {
+                auto branch = state;
+                for (int write = 0; write < writes; ++write)
+                    branch[(table * 37 + action * 11 + write) % variables] = table + action;
+                pending.push_back(std::move(branch));
+            }
+            state = pending.back();
+            pending.pop_back();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        return std::make_pair(elapsed.count(),
+                              std::vector<std::pair<int, int>>(state.begin(), state.end()));
+    };
+    auto [persistent, persistentResult] = explore(persistent_map<int, int>());
+    auto [flat, flatResult] = explore(flat_map<int, int>());
+    std::cout << "[persistent_map] " << tables << " tables of " << actions << " actions on "
+              << variables << " variables: " << persistent << " us, " << flat
+              << " us with flat_map copies" << std::endl;
+    EXPECT_EQ(persistentResult, flatResult);
+}
+
+}  // namespace P4::Test
@@ -0,0 +1,175 @@
+#include "frontends/common/preprocessor.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "helpers.h"
+
+namespace P4::Test {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void writeFile(const fs::path &path, std::string_view contents) {
+    std::ofstream out(path, std::ios::trunc);
+    out << contents;
+}
+
+class PreprocessorTest : public P4CTest {
+ protected:
+    fs::path dir;
+    fs::path system;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("p4c-preprocessor-test-" + std::to_string(getpid()));
+        fs::remove_all(dir);
+        system = dir / "include";
+        fs::create_directories(system);
+        writeFile(system / "arch.p4",
+                  "#ifndef _ARCH_P4_\n#define _ARCH_P4_\n/* the\n#define NOT_A_MACRO\n*/\n"
+                  "extern void arch();\n#endif\n");
+    }
+
+    void TearDown() override { fs::remove_all(dir); }
+
+    std::optional<std::string> run(std::string_view program) {
+        writeFile(dir / "program.p4", program);
+        Preprocessor preprocessor({}, {system});
+        return preprocessor.run(dir / "program.p4");
+    }
+};
+
+}  // namespace
+
+TEST_F(PreprocessorTest, Scan) {
+    auto lines = Preprocessor::scan("a /* b\n#c */ d\r\n  # define E \\\n  1\nf");
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_FALSE(lines[0].directive);
+    EXPECT_TRUE(lines[1].inComment);
+    EXPECT_FALSE(lines[1].directive);
+    EXPECT_EQ(lines[1].text, "#c */ d");
+    EXPECT_TRUE(lines[2].directive);
+    EXPECT_EQ(lines[2].text, "  # define E   1");
+    EXPECT_EQ(lines[2].physical, 2u);
+    EXPECT_EQ(lines[3].text, "f");
+}
+
+TEST_F(PreprocessorTest, Conditionals) {
+    auto output = run(R"(#define WIDTH 8
+#define BIG (WIDTH * 4)
+#if BIG > 16 && defined(WIDTH)
+bit<WIDTH> x; // WIDTH
+#elif 1
+bit<1> x;
+#else
+bit<2> x;
+#endif
+#undef WIDTH
+#ifndef WIDTH
+const bit<32> c = BIG;
+#endif
+#pragma message "ignored"
+)");
+    ASSERT_TRUE(output.has_value());
+    EXPECT_NE(output->find("bit<8> x; // WIDTH\n"), std::string::npos);
+    EXPECT_EQ(output->find("bit<1> x"), std::string::npos);
+    EXPECT_EQ(output->find("bit<2> x"), std::string::npos);
+    EXPECT_NE(output->find("const bit<32> c = (WIDTH * 4);\n"), std::string::npos);
+    EXPECT_EQ(output->find("#pragma"), std::string::npos);
+}
+
+TEST_F(PreprocessorTest, Arithmetic) {
+    auto taken = [this](std::string_view condition) {
+        auto output = run("#if " + std::string(condition) + "\ntaken\n#endif\n");
+        EXPECT_TRUE(output.has_value()) << condition;
+        return output && output->find("taken") != std::string::npos;
+    };
+    EXPECT_TRUE(taken("-1 < 0"));
+    EXPECT_FALSE(taken("-1 < 0u"));
+    EXPECT_TRUE(taken("-1 > 0U"));
+    EXPECT_TRUE(taken("0xffffffffffffffff > 0"));
+    EXPECT_TRUE(taken("18446744073709551615 == -1"));
+    EXPECT_TRUE(taken("-1 / 2 == 0"));
+    EXPECT_TRUE(taken("-1u / 2 == 0x7fffffffffffffff"));
+    EXPECT_TRUE(taken("-8 >> 1 == -4"));
+    EXPECT_TRUE(taken("-8u >> 1 > 0"));
+    EXPECT_TRUE(taken("1 << 64 == 0"));
+    EXPECT_TRUE(taken("(1 ? -1 : 0u) > 0"));
+    EXPECT_TRUE(taken("(-9223372036854775807 - 1) / -1 < 0"));
+    EXPECT_FALSE(run("#if 1 / 0\n#endif\n").has_value());
+    EXPECT_FALSE(run("#if 99999999999999999999\n#endif\n").has_value());
+}
+
+TEST_F(PreprocessorTest, Includes) {
+    writeFile(dir / "local.p4", "const bit<8> local = 1;\n");
+    auto output = run("#include <arch.p4>\n#include \"local.p4\"\n#include <arch.p4>\nx\n");
+    ASSERT_TRUE(output.has_value());
+    auto program = (dir / "program.p4").string();
+    EXPECT_EQ(output->rfind("# 1 \"" + program + "\"\n", 0), 0u);
+    EXPECT_NE(output->find("# 1 \"" + (system / "arch.p4").string() + "\" 1\n"),
+              std::string::npos);
+    EXPECT_NE(output->find("# 2 \"" + program + "\" 2\n"), std::string::npos);
+    EXPECT_NE(output->find("const bit<8> local = 1;\n"), std::string::npos);
+    EXPECT_NE(output->find("# 4 \"" + program + "\" 2\nx\n"), std::string::npos);
+    // Directives in comments are not run, and the include guard holds.
+    EXPECT_NE(output->find("#define NOT_A_MACRO\n"), std::string::npos);
+    EXPECT_EQ(output->find("extern void arch();"), output->rfind("extern void arch();"));
+}
+
+TEST_F(PreprocessorTest, LineDirective) {
+    auto output = run("a\n#line 100 \"other.p4\"\nb\n");
+    ASSERT_TRUE(output.has_value());
+    EXPECT_NE(output->find("a\n# 100 \"other.p4\"\nb\n"), std::string::npos);
+}
+
+TEST_F(PreprocessorTest, FallsBack) {
+    EXPECT_FALSE(run("#define F(x) x\n").has_value());
+    EXPECT_FALSE(run("#include \"missing.p4\"\n").has_value());
+    EXPECT_FALSE(run("#ifdef X\n").has_value());
+    EXPECT_FALSE(run("#error stop\n").has_value());
+    EXPECT_FALSE(run("#pragma once\n").has_value());
+    EXPECT_FALSE(run("#if __COUNTER__\n#endif\n").has_value());
+
+    Preprocessor preprocessor({}, {});
+    EXPECT_TRUE(preprocessor.addOptions("-I/usr/include -DA=1 -UB"));
+    EXPECT_FALSE(preprocessor.addOptions("-include x.h"));
+    EXPECT_FALSE(preprocessor.define("F(x)=x"));
+}
+
+TEST_F(PreprocessorTest, SystemFilesAreScannedOnce) {
+    auto before = Preprocessor::systemFilesScanned();
+    ASSERT_TRUE(run("#include <arch.p4>\n").has_value());
+    EXPECT_EQ(Preprocessor::systemFilesScanned(), before + 1);
+    ASSERT_TRUE(run("#include <arch.p4>\n#include <arch.p4>\n").has_value());
+    EXPECT_EQ(Preprocessor::systemFilesScanned(), before + 1);
+
+    // A changed file is scanned again.
+    writeFile(system / "arch.p4", "extern void arch(); extern void other();\n");
+    auto output = run("#include <arch.p4>\n");
+    ASSERT_TRUE(output.has_value());
+    EXPECT_NE(output->find("extern void other();"), std::string::npos);
+    EXPECT_EQ(Preprocessor::systemFilesScanned(), before + 2);
+}
+
+/// Times 100 runs over a program that includes a system header of 2000 declarations, which
+/// only the first run scans.
+TEST_F(PreprocessorTest, DISABLED_RepeatedRuns) {
+    std::string header;
+    for (int i = 0; i < 2000; ++i)
+        header += "/** Declaration " + std::to_string(i) + " */\nextern void f" +
+                  std::to_string(i) + "();\n";
+    writeFile(system / "large.p4", header);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) ASSERT_TRUE(run("#include <large.p4>\n").has_value());
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "[Preprocessor] 100 runs: " << elapsed.count() << " ms" << std::endl;
+}
+
+}  // namespace P4::Test
@@ -18,6 +18,9 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 
+#include <iostream>
+#include <vector>
+
 #include "lib/compile_context.h"
 #include "lib/cstring.h"
 #include "lib/exceptions.h"
@@ -99,4 +102,51 @@ TEST(UtilSourceFile, SourceInfo) {
     EXPECT_FALSE(invalid.isValid());
 }
 
+TEST(UtilSourceFile, SourceInfoRanges) {
+    Util::InputSources sources;
+
+    SourceInfo packed(&sources, SourcePosition(3, 5), SourcePosition(7, 9));
+    EXPECT_EQ(SourcePosition(3, 5), packed.getStart());
+    EXPECT_EQ(SourcePosition(7, 9), packed.getEnd());
+
+    // Too long to be packed.
+    SourceInfo wide(&sources, SourcePosition(2, 5000), SourcePosition(200000, 1));
+    EXPECT_TRUE(wide.isValid());
+    EXPECT_EQ(SourcePosition(2, 5000), wide.getStart());
+    EXPECT_EQ(SourcePosition(200000, 1), wide.getEnd());
+    EXPECT_EQ(&sources, wide.getSources());
+
+    SourceInfo span = packed + wide;
+    EXPECT_EQ("(2:5000)-(200000:1)", span.toString());
+    EXPECT_EQ(span, SourceInfo(&sources, SourcePosition(2, 5000), SourcePosition(200000, 1)));
+    EXPECT_LT(wide, packed);
+    EXPECT_EQ(packed, SourceInfo(&sources, SourcePosition(3, 5), SourcePosition(7, 9)));
+
+    SourceInfo loaded("x.p4"_cs, 4, 2, "a = b;"_cs);
+    EXPECT_FALSE(loaded.isValid());
+    EXPECT_EQ("x.p4", loaded.filename());
+    EXPECT_EQ(4, loaded.line());
+    EXPECT_EQ(2, loaded.column());
+    EXPECT_EQ("a = b;", loaded.srcBrief());
+    EXPECT_EQ(-1, packed.line());
+    EXPECT_EQ(SourceInfo(), loaded);
+}
+
+TEST(UtilSourceFile, ManyExtendedRanges) {
+    Util::InputSources sources;
+    // Enough to fill several chunks of the table of extended ranges.
+    std::vector<SourceInfo> wide;
+    for (unsigned i = 1; i <= 10000; ++i)
+        wide.emplace_back(&sources, SourcePosition(i, 5000), SourcePosition(i + 200000, 1));
+    for (unsigned i = 1; i <= 10000; ++i) {
+        EXPECT_EQ(SourcePosition(i, 5000), wide[i - 1].getStart());
+        EXPECT_EQ(SourcePosition(i + 200000, 1), wide[i - 1].getEnd());
+    }
+}
+
+/// Prints sizeof(SourceInfo), which every IR node holds.
+TEST(UtilSourceFile, DISABLED_SourceInfoSize) {
+    std::cout << "[SourceInfo] " << sizeof(SourceInfo) << " bytes" << std::endl;
+}
+
 }  // namespace P4::Util
@@ -142,6 +142,8 @@ void IrDefinitions::generate(std::ostream &t, std::ostream &out, std::ostream &i
         << std::endl;
 
     impl << "#include \"ir/ir-generated.h\"    // IWYU pragma: keep\n\n"
+         << "#include \"ir/binary_reader.h\"   // IWYU pragma: keep\n"
+         << "#include \"ir/binary_writer.h\"   // IWYU pragma: keep\n"
          << "#include \"ir/ir-inline.h\"       // IWYU pragma: keep\n"
          << "#include \"ir/json_generator.h\"  // IWYU pragma: keep\n"
          << "#include \"ir/json_loader.h\"     // IWYU pragma: keep\n"
@@ -169,9 +171,12 @@ void IrDefinitions::generate(std::ostream &t, std::ostream &out, std::ostream &i
         << std::endl
         << "class JSONLoader;\n"
         << "using NodeFactoryFn = IR::Node*(*)(JSONLoader&);\n"
+        << "class BinaryReader;\n"
+        << "using BinaryNodeFactoryFn = IR::Node*(*)(BinaryReader&);\n"
         << std::endl
         << "namespace IR {\n"
         << "extern std::map<cstring, NodeFactoryFn> unpacker_table;\n"
+        << "extern std::map<cstring, BinaryNodeFactoryFn> binary_unpacker_table;\n"
         << "using namespace P4::literals;\n"
         << "}\n";
 
@@ -209,6 +214,28 @@ void IrDefinitions::generate(std::ostream &t, std::ostream &out, std::ostream &i
                 << ">;" << std::endl;
         }
     }
+
+    // Unlike the JSON one, this table also holds the container instances, as a node's static
+    // type in the reader often is a base class of the container.
+    impl << "\nstd::map<cstring, BinaryNodeFactoryFn> IR::binary_unpacker_table = {\n";
+    auto binaryFactory = [&impl](cstring type) {
+        impl << "{" << type << "::static_type_name(), [](BinaryReader &in) -> IR::Node * { return "
+             << type << "::fromBinary(in); }},\n";
+    };
+    binaryFactory("IR::Vector<IR::Node>"_cs);
+    binaryFactory("IR::IndexedVector<IR::Node>"_cs);
+    for (auto cls : *getClasses()) {
+        std::stringstream name;
+        name << "IR::" << cls->containedIn << cls->name;
+        if (cls->kind == NodeKind::Concrete)
+            impl << "{" << name.str() << "::static_type_name(), BinaryNodeFactoryFn(&"
+                 << name.str() << "::fromBinary)},\n";
+        if (cls->needVector || cls->needIndexedVector)
+            binaryFactory(cstring("IR::Vector<" + name.str() + ">"));
+        if (cls->needIndexedVector) binaryFactory(cstring("IR::IndexedVector<" + name.str() + ">"));
+    }
+    impl << "};\n" << std::endl;
+
     out << "}  // namespace P4" << std::endl;
 
     for (auto e : elements) {
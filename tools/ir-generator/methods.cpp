@@ -372,6 +372,9 @@ const ordered_map<cstring, IrMethod::info_t> IrMethod::Generate = {
                   continue;  // FIXME -- deal with SourcInfo
               buf << cl->indent << "json.load(\"" << f->name << "\", " << f->name << ");"
                   << std::endl;
+              // Ids handed out later must not repeat the ones read.
+              if (f->initializer == "nextId++")
+                  buf << cl->indent << "raiseNextId(nextId, " << f->name << ");" << std::endl;
           }
           buf << "}";
           return {buf};
@@ -387,6 +390,53 @@ const ordered_map<cstring, IrMethod::info_t> IrMethod::Generate = {
           buf << "{ return new " << cl->name << "(json); }";
           return {buf};
       }}},
+    {"toBinary"_cs,
+     {&NamedType::Void(),
+      {new IrField(new ReferenceType(&NamedType::BinaryWriter()), "out"_cs)},
+      CONST + IN_IMPL + OVERRIDE + INCL_NESTED,
+      [](IrClass *cl, Util::SourceInfo, cstring) -> cstring {
+          std::stringstream buf;
+          buf << "{" << std::endl;
+          if (auto parent = cl->getParent())
+              buf << cl->indent << parent->qualified_name(cl->containedIn) << "::toBinary(out);"
+                  << std::endl;
+          for (auto f : *cl->getFields()) {
+              // Source positions are written for all nodes by the BinaryWriter, if at all.
+              if (f->type && *f->type == NamedType::SourceInfo()) continue;
+              buf << cl->indent << "out.write(" << f->name << ");" << std::endl;
+          }
+          buf << "}";
+          return {buf};
+      }}},
+    {"binary_constructor"_cs,
+     {nullptr,
+      {new IrField(new ReferenceType(&NamedType::BinaryReader()), "in"_cs)},
+      IN_IMPL + CONSTRUCTOR + INCL_NESTED,
+      [](IrClass *cl, Util::SourceInfo, cstring) -> cstring {
+          std::stringstream buf;
+          if (auto parent = cl->getParent())
+              buf << ": " << parent->qualified_name(cl->containedIn) << "(in)";
+          buf << " {" << std::endl;
+          for (auto f : *cl->getFields()) {
+              if (f->type && *f->type == NamedType::SourceInfo()) continue;
+              buf << cl->indent << "in.read(" << f->name << ");" << std::endl;
+              if (f->initializer == "nextId++")
+                  buf << cl->indent << "raiseNextId(nextId, " << f->name << ");" << std::endl;
+          }
+          buf << "}";
+          return {buf};
+      }}},
+    {"fromBinary"_cs,
+     {nullptr,
+      {
+          new IrField(new ReferenceType(&NamedType::BinaryReader()), "in"_cs),
+      },
+      FACTORY + IN_IMPL + CONCRETE_ONLY + INCL_NESTED,
+      [](IrClass *cl, Util::SourceInfo, cstring) -> cstring {
+          std::stringstream buf;
+          buf << "{ return new " << cl->name << "(in); }";
+          return {buf};
+      }}},
     {"toString"_cs,
      {&NamedType::Cstring(),
       {},
@@ -465,7 +515,7 @@ void IrClass::generateMethods() {
         if (!IrMethod::Generate.count(m->name))
             throw Util::CompilationError("Unrecognized predefined method %1%", m->name);
         auto &info = IrMethod::Generate.at(m->name);
-        if (m->name) {
+        if (!(info.flags & CONSTRUCTOR)) {
             if (info.rtype) {
                 // This predefined method has an explicit return type.
                 m->rtype = info.rtype;
@@ -126,6 +126,16 @@ NamedType &NamedType::JSONObject() {
     return nt;
 }
 
+NamedType &NamedType::BinaryWriter() {
+    static NamedType nt("BinaryWriter"_cs);
+    return nt;
+}
+
+NamedType &NamedType::BinaryReader() {
+    static NamedType nt("BinaryReader"_cs);
+    return nt;
+}
+
 NamedType &NamedType::SourceInfo() {
     static NamedType nt(new LookupScope("Util"_cs), "SourceInfo"_cs);
     return nt;
@@ -111,6 +111,8 @@ class NamedType : public Type {
     static NamedType &JSONGenerator();
     static NamedType &JSONLoader();
     static NamedType &JSONObject();
+    static NamedType &BinaryWriter();
+    static NamedType &BinaryReader();
     static NamedType &SourceInfo();
 };
 